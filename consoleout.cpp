@@ -40,7 +40,8 @@ ConsoleOut::ConsoleOut(const Profile &profile, QObject *parent) :
  ************************************************/
 void ConsoleOut::converterStarted()
 {
-    mStartTime = QDateTime::currentDateTime();
+    mStartTime    = QDateTime::currentDateTime();
+    mTotalPercent = -1;
 }
 
 /************************************************
@@ -79,6 +80,41 @@ void ConsoleOut::trackProgress(const Track &track, TrackState state, Percent)
             << mProfile.resultFilePath(&track) << "\n";
 }
 
+/************************************************
+ * Printed once per percent, not on every change
+ ************************************************/
+void ConsoleOut::totalProgress(double percent, double throughput, int eta)
+{
+    if (int(percent) == mTotalPercent) {
+        return;
+    }
+    mTotalPercent = int(percent);
+
+    QTextStream out(stdout);
+    out << "Progress " << mTotalPercent << "%";
+    if (eta >= 0) {
+        out << ", " << durationToString(eta) << " left, speed " << QString::number(throughput, 'f', 1) << "x";
+    }
+    out << "\n";
+}
+
+/************************************************
+ *
+ ************************************************/
+QString ConsoleOut::durationToString(int duration)
+{
+    int h = duration / 3600;
+    int m = (duration - (h * 3600)) / 60;
+    int s = duration - (h * 3600) - (m * 60);
+
+    if (h)
+        return QString("%3h %2m %1s").arg(s).arg(m).arg(h);
+    else if (m)
+        return QString("%2m %1s").arg(s).arg(m);
+    else
+        return QString("%1 sec").arg(s);
+}
+
 /************************************************
  *
  ************************************************/
@@ -88,16 +124,10 @@ void ConsoleOut::printStatistic()
     if (!duration)
         duration = 1;
 
-    int h = duration / 3600;
-    int m = (duration - (h * 3600)) / 60;
-    int s = duration - (h * 3600) - (m * 60);
-
     QString str;
 
-    if (h)
-        str = QString("Encoding time %4h %3m %2s [%1 sec]").arg(duration).arg(s).arg(m).arg(h);
-    else if (m)
-        str = QString("Encoding time %3m %2s [%1 sec]").arg(duration).arg(s).arg(m);
+    if (duration >= 60)
+        str = QString("Encoding time %2 [%1 sec]").arg(duration).arg(durationToString(duration));
     else
         str = QString("Encoding time %1 sec").arg(duration);
 
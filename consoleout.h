@@ -41,6 +41,7 @@ public slots:
     void converterStarted();
     void converterFinished();
     void trackProgress(const Track &track, TrackState state, Percent percent);
+    void totalProgress(double percent, double throughput, int eta);
 
     void printStatistic();
 
@@ -48,6 +49,9 @@ private:
     QDateTime mStartTime;
     QDateTime mFinishTime;
     Profile   mProfile;
+    int       mTotalPercent = -1;
+
+    static QString durationToString(int duration);
 };
 
 #endif // CONSOLEOUT_H
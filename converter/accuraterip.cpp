@@ -0,0 +1,152 @@
+/* BEGIN_COMMON_COPYRIGHT_HEADER
+ * (c)LGPL2+
+ *
+ * Flacon - audio File Encoder
+ * https://github.com/flacon/flacon
+ *
+ * Copyright: 2024
+ *   Alexander Sokoloff <sokoloff.a@gmail.com>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * END_COMMON_COPYRIGHT_HEADER */
+
+#include "accuraterip.h"
+#include <QtEndian>
+#include <zlib.h>
+
+using namespace AccurateRip;
+
+static constexpr quint64 BYTES_PER_SAMPLE   = 4; // 16 bit, stereo
+static constexpr quint64 SAMPLES_PER_SECTOR = 588;
+static constexpr quint64 AR_SKIP_SAMPLES    = 5 * SAMPLES_PER_SECTOR;
+static constexpr quint64 CTDB_SKIP_BYTES    = 10 * SAMPLES_PER_SECTOR * BYTES_PER_SAMPLE;
+static constexpr size_t  BLOCK_SIZE         = 4096;
+
+/************************************************
+ *
+ ************************************************/
+TrackCrc::TrackCrc(quint64 skipBytes, quint64 trackBytes, bool firstTrack, bool lastTrack) :
+    mSkip(skipBytes)
+{
+    const quint64 samples = trackBytes / BYTES_PER_SAMPLE;
+
+    // The positions are 1-based
+    mCheckStart = firstTrack ? AR_SKIP_SAMPLES - 1 : 1;
+    mCheckEnd   = lastTrack ? samples - qMin(samples, AR_SKIP_SAMPLES) : samples;
+}
+
+/************************************************
+ *
+ ************************************************/
+void TrackCrc::add(const char *data, size_t size)
+{
+    if (mSkip) {
+        size_t n = qMin<quint64>(mSkip, size);
+        mSkip -= n;
+        data += n;
+        size -= n;
+    }
+
+    if (size == 0) {
+        return;
+    }
+
+    mCrc32 = ::crc32(mCrc32, reinterpret_cast<const Bytef *>(data), uInt(size));
+    if (mDiscCrc) {
+        mDiscCrc->add(data, size);
+    }
+
+    // The data is not always split on the sample boundary
+    if (mPartialSize) {
+        while (mPartialSize < int(BYTES_PER_SAMPLE) && size) {
+            mPartial[mPartialSize++] = *data++;
+            --size;
+        }
+
+        if (mPartialSize < int(BYTES_PER_SAMPLE)) {
+            return;
+        }
+
+        addSamples(mPartial, 1);
+        mPartialSize = 0;
+    }
+
+    size_t count = size / BYTES_PER_SAMPLE;
+    addSamples(data, count);
+
+    data += count * BYTES_PER_SAMPLE;
+    size -= count * BYTES_PER_SAMPLE;
+    for (size_t i = 0; i < size; ++i) {
+        mPartial[mPartialSize++] = data[i];
+    }
+}
+
+/************************************************
+ * The range check is done once per block, the
+ * loop body is a plain scalar multiply and add.
+ ************************************************/
+void TrackCrc::addSamples(const char *data, size_t count)
+{
+    quint32 samples[BLOCK_SIZE];
+
+    while (count > 0) {
+        const size_t n = qMin(count, BLOCK_SIZE);
+        qFromLittleEndian<quint32>(data, n, samples);
+
+        const quint64 first = mPos + 1;
+        const quint64 last  = mPos + n;
+        const quint64 begin = qMax(first, mCheckStart);
+        const quint64 end   = qMin(last, mCheckEnd);
+
+        quint32 lo = 0;
+        quint32 hi = 0;
+        for (quint64 pos = begin; pos <= end; ++pos) {
+            const quint64 v = quint64(samples[pos - first]) * quint32(pos);
+            lo += quint32(v);
+            hi += quint32(v >> 32);
+        }
+        mLo += lo;
+        mHi += hi;
+
+        mPos += n;
+        data += n * BYTES_PER_SAMPLE;
+        count -= n;
+    }
+}
+
+/************************************************
+ *
+ ************************************************/
+DiscCrc::DiscCrc(quint64 discBytes) :
+    mStart(CTDB_SKIP_BYTES),
+    mEnd(discBytes - qMin(discBytes, CTDB_SKIP_BYTES))
+{
+}
+
+/************************************************
+ *
+ ************************************************/
+void DiscCrc::add(const char *data, size_t size)
+{
+    const quint64 begin = qMax(mPos, mStart);
+    const quint64 end   = qMin(mPos + size, mEnd);
+
+    if (begin < end) {
+        mCrc32 = ::crc32(mCrc32, reinterpret_cast<const Bytef *>(data + (begin - mPos)), uInt(end - begin));
+    }
+
+    mPos += size;
+}
@@ -0,0 +1,94 @@
+/* BEGIN_COMMON_COPYRIGHT_HEADER
+ * (c)LGPL2+
+ *
+ * Flacon - audio File Encoder
+ * https://github.com/flacon/flacon
+ *
+ * Copyright: 2024
+ *   Alexander Sokoloff <sokoloff.a@gmail.com>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * END_COMMON_COPYRIGHT_HEADER */
+
+#ifndef ACCURATERIP_H
+#define ACCURATERIP_H
+
+#include <QtGlobal>
+
+namespace AccurateRip {
+
+class DiscCrc;
+
+/************************************************
+ * AccurateRip v1/v2 checksums and the plain CRC32
+ * of one CD track. The data is the 16-bit stereo
+ * PCM from the track INDEX 01 to the next track
+ * INDEX 01, nothing is looked up in the database.
+ ************************************************/
+class TrackCrc
+{
+public:
+    /// The first skipBytes of the data (the HTOA added to the first track) are not counted.
+    TrackCrc(quint64 skipBytes, quint64 trackBytes, bool firstTrack, bool lastTrack);
+
+    /// The counted data is passed to the disc CRC as well.
+    void setDiscCrc(DiscCrc *discCrc) { mDiscCrc = discCrc; }
+
+    void add(const char *data, size_t size);
+
+    quint32 v1() const { return mLo; }
+    quint32 v2() const { return mLo + mHi; }
+    quint32 crc32() const { return mCrc32; }
+
+private:
+    quint64  mSkip;
+    quint64  mPos = 0;
+    quint64  mCheckStart;
+    quint64  mCheckEnd;
+    quint32  mLo      = 0;
+    quint32  mHi      = 0;
+    quint32  mCrc32   = 0;
+    DiscCrc *mDiscCrc = nullptr;
+
+    char mPartial[4];
+    int  mPartialSize = 0;
+
+    void addSamples(const char *data, size_t count);
+};
+
+/************************************************
+ * The CUETools database CRC32 of the whole disc,
+ * the first and the last 10 sectors are skipped.
+ ************************************************/
+class DiscCrc
+{
+public:
+    explicit DiscCrc(quint64 discBytes);
+
+    void add(const char *data, size_t size);
+
+    quint32 result() const { return mCrc32; }
+
+private:
+    quint64 mPos = 0;
+    quint64 mStart;
+    quint64 mEnd;
+    quint32 mCrc32 = 0;
+};
+
+} // namespace
+
+#endif // ACCURATERIP_H
@@ -0,0 +1,212 @@
+/* BEGIN_COMMON_COPYRIGHT_HEADER
+ * (c)LGPL2+
+ *
+ * Flacon - audio File Encoder
+ * https://github.com/flacon/flacon
+ *
+ * Copyright: 2024
+ *   Alexander Sokoloff <sokoloff.a@gmail.com>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * END_COMMON_COPYRIGHT_HEADER */
+
+#include "concurrencycontroller.h"
+#include "track.h"
+
+#include <QFile>
+#include <QThread>
+#include <QLoggingCategory>
+#include <math.h>
+
+namespace {
+Q_LOGGING_CATEGORY(LOG, "ConcurrencyController")
+}
+
+using namespace Conv;
+
+static constexpr int SAMPLE_INTERVAL_MS = 2000;
+
+/************************************************
+ *
+ ************************************************/
+ConcurrencyController::ConcurrencyController(QObject *parent) :
+    QObject(parent)
+{
+    mTimer.setInterval(SAMPLE_INTERVAL_MS);
+    connect(&mTimer, &QTimer::timeout, this, &ConcurrencyController::sample);
+}
+
+/************************************************
+ *
+ ************************************************/
+void ConcurrencyController::start(int minThreads, int maxThreads)
+{
+    mMaxThreads = qMax(1, maxThreads);
+    mMinThreads = qBound(1, minThreads, mMaxThreads);
+    mThreads    = qBound(mMinThreads, QThread::idealThreadCount(), mMaxThreads);
+    mSplitters  = qMax(1, int(ceil(mThreads / 2.0)));
+
+    mTracks.clear();
+    mWork     = 0;
+    mLastWork = 0;
+    mPrevRate = 0;
+    mLastStep = 0;
+
+    // Without CPU statistics we keep the static limit set by the user.
+    mHasCpuTimes = readCpuTimes(&mCpuTimes);
+    if (!mHasCpuTimes) {
+        mThreads   = mMaxThreads;
+        mSplitters = qMax(1, int(ceil(mThreads / 2.0)));
+        qCDebug(LOG) << "CPU statistics are not available, use" << mThreads << "threads";
+        return;
+    }
+
+    qCDebug(LOG) << "Start with" << mThreads << "threads," << mSplitters << "splitters, bounds" << mMinThreads << mMaxThreads;
+    mElapsed.start();
+    mTimer.start();
+}
+
+/************************************************
+ *
+ ************************************************/
+void ConcurrencyController::stop()
+{
+    mTimer.stop();
+}
+
+/************************************************
+ * The work is measured in milliseconds of audio
+ * passed through a stage, both the splitter and
+ * the encoder stages count.
+ ************************************************/
+void ConcurrencyController::setTrackProgress(const Track &track, TrackState state, int percent)
+{
+    if (state != TrackState::Splitting && state != TrackState::Encoding) {
+        return;
+    }
+
+    TrackWork &work = mTracks[Key(track.disc(), track.index())];
+    work.duration   = track.duration();
+
+    int &stage = (state == TrackState::Splitting) ? work.split : work.encode;
+    if (percent <= stage) {
+        return;
+    }
+
+    mWork += double(work.duration) * (percent - stage) / 100.0;
+    stage = percent;
+}
+
+/************************************************
+ *
+ ************************************************/
+void ConcurrencyController::sample()
+{
+    CpuTimes times;
+    if (!readCpuTimes(&times)) {
+        return;
+    }
+
+    qint64 elapsed = mElapsed.restart();
+    quint64 total  = times.total - mCpuTimes.total;
+    if (elapsed <= 0 || total == 0) {
+        return;
+    }
+
+    double cpuLoad = double(times.busy - mCpuTimes.busy) / total;
+    double ioWait  = double(times.ioWait - mCpuTimes.ioWait) / total;
+    double rate    = (mWork - mLastWork) * 1000.0 / elapsed;
+
+    mCpuTimes = times;
+    mLastWork = mWork;
+
+    adjust(cpuLoad, ioWait, rate);
+}
+
+/************************************************
+ * Hill climbing: grow while the CPU has spare
+ * cores and the disk keeps up, step back when
+ * the last step made the throughput worse.
+ ************************************************/
+void ConcurrencyController::adjust(double cpuLoad, double ioWait, double rate)
+{
+    const int prevThreads   = mThreads;
+    const int prevSplitters = mSplitters;
+
+    const bool slowedDown = mLastStep > 0 && rate < mPrevRate * 0.95;
+
+    if (ioWait > IO_SATURATED) {
+        // The disk is thrashing, splitters read and write the most.
+        if (mSplitters > 1) {
+            --mSplitters;
+        }
+        else {
+            mThreads = qMax(mMinThreads, mThreads - 1);
+        }
+        mLastStep = -1;
+    }
+    else if (slowedDown) {
+        // We are past the knee, go back and stay there.
+        mThreads  = qMax(mMinThreads, mThreads - 1);
+        mLastStep = 0;
+    }
+    else if (cpuLoad < CPU_SATURATED) {
+        mThreads = qMin(mMaxThreads, mThreads + 1);
+        if (ioWait < IO_IDLE) {
+            ++mSplitters;
+        }
+        mLastStep = mThreads > prevThreads ? 1 : 0;
+    }
+    else {
+        mLastStep = 0;
+    }
+
+    mSplitters = qBound(1, mSplitters, qMax(1, int(ceil(mThreads / 2.0))));
+    mPrevRate  = rate;
+
+    if (mThreads != prevThreads || mSplitters != prevSplitters) {
+        qCDebug(LOG) << "cpu" << cpuLoad << "iowait" << ioWait << "rate" << rate
+                     << "=> threads" << mThreads << "splitters" << mSplitters;
+        emit limitsChanged();
+    }
+}
+
+/************************************************
+ * Reads the aggregate line of /proc/stat:
+ * cpu user nice system idle iowait irq softirq steal
+ ************************************************/
+bool ConcurrencyController::readCpuTimes(CpuTimes *times)
+{
+    QFile file("/proc/stat");
+    if (!file.open(QFile::ReadOnly)) {
+        return false;
+    }
+
+    const QList<QByteArray> fields = file.readLine().simplified().split(' ');
+    if (fields.count() < 8 || fields.first() != "cpu") {
+        return false;
+    }
+
+    quint64 values[8] = {};
+    for (int i = 0; i < 8; ++i) {
+        values[i] = fields.value(i + 1).toULongLong();
+    }
+
+    times->ioWait = values[4];
+    times->busy   = values[0] + values[1] + values[2] + values[5] + values[6] + values[7];
+    times->total  = times->busy + values[3] + values[4];
+    return true;
+}
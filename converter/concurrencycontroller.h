@@ -0,0 +1,114 @@
+/* BEGIN_COMMON_COPYRIGHT_HEADER
+ * (c)LGPL2+
+ *
+ * Flacon - audio File Encoder
+ * https://github.com/flacon/flacon
+ *
+ * Copyright: 2024
+ *   Alexander Sokoloff <sokoloff.a@gmail.com>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * END_COMMON_COPYRIGHT_HEADER */
+
+#ifndef CONCURRENCYCONTROLLER_H
+#define CONCURRENCYCONTROLLER_H
+
+#include <QObject>
+#include <QTimer>
+#include <QElapsedTimer>
+#include <QMap>
+#include "types.h"
+
+class Track;
+class Disc;
+
+namespace Conv {
+
+/************************************************
+ * Limits how many splitters and encoders the
+ * converter runs at once.
+ *
+ * The controller periodically samples the CPU
+ * load, iowait and the amount of audio processed
+ * by the splitters and encoders. It adds threads
+ * while the cores are idle and removes them when
+ * the disk is saturated or throughput drops.
+ * The limit never leaves [minThreads, maxThreads].
+ ************************************************/
+class ConcurrencyController : public QObject
+{
+    Q_OBJECT
+public:
+    explicit ConcurrencyController(QObject *parent = nullptr);
+
+    void start(int minThreads, int maxThreads);
+    void stop();
+
+    int threadsLimit() const { return mThreads; }
+    int splittersLimit() const { return mSplitters; }
+
+    void setTrackProgress(const Track &track, TrackState state, int percent);
+
+    // Makes one control step, rate is the processed audio in ms per second.
+    void adjust(double cpuLoad, double ioWait, double rate);
+
+    static constexpr double IO_SATURATED  = 0.25;
+    static constexpr double IO_IDLE       = 0.10;
+    static constexpr double CPU_SATURATED = 0.90;
+
+signals:
+    void limitsChanged();
+
+private:
+    struct CpuTimes
+    {
+        quint64 busy   = 0;
+        quint64 ioWait = 0;
+        quint64 total  = 0;
+    };
+
+    struct TrackWork
+    {
+        Duration duration = 0;
+        int      split    = 0;
+        int      encode   = 0;
+    };
+
+    QTimer        mTimer;
+    QElapsedTimer mElapsed;
+    bool          mHasCpuTimes = false;
+    CpuTimes      mCpuTimes;
+
+    int mMinThreads = 1;
+    int mMaxThreads = 1;
+    int mThreads    = 1;
+    int mSplitters  = 1;
+
+    using Key = std::pair<const Disc *, TrackNum>;
+    QMap<Key, TrackWork>  mTracks;
+    double                mWork     = 0;
+    double                mLastWork = 0;
+    double                mPrevRate = 0;
+    int                   mLastStep = 0;
+
+    void sample();
+
+    static bool readCpuTimes(CpuTimes *times);
+};
+
+} // namespace Conv
+
+#endif // CONCURRENCYCONTROLLER_H
@@ -30,12 +30,16 @@
 #include "converter.h"
 #include "project.h"
 #include "discpipline.h"
+#include "fingerprints.h"
+#include "retagger.h"
 
 #include <iostream>
 #include <math.h>
 #include <QFileInfo>
 #include <QDir>
+#include <QHash>
 #include <QLoggingCategory>
+#include <QtConcurrent/QtConcurrent>
 
 namespace {
 Q_LOGGING_CATEGORY(LOG, "Converter")
@@ -43,6 +47,8 @@ Q_LOGGING_CATEGORY(LOG, "Converter")
 
 using namespace Conv;
 
+static constexpr int PROGRESS_INTERVAL_MS = 100;
+
 /************************************************
 
  ************************************************/
@@ -50,6 +56,10 @@ Converter::Converter(QObject *parent) :
     QObject(parent)
 {
     qRegisterMetaType<Conv::ConvTrack>();
+    connect(&mRetagWatcher, &QFutureWatcher<void>::finished, this, &Converter::retagFinished);
+
+    mProgressTimer.setInterval(PROGRESS_INTERVAL_MS);
+    connect(&mProgressTimer, &QTimer::timeout, this, &Converter::collectProgress);
 }
 
 /************************************************
@@ -57,12 +67,14 @@ Converter::Converter(QObject *parent) :
  ************************************************/
 Converter::~Converter()
 {
+    mRetagWatcher.cancel();
+    mRetagWatcher.waitForFinished();
 }
 
 /************************************************
-
+ * All the tracks of all the discs in the project
  ************************************************/
-void Converter::start(const Profile &profile)
+Converter::Jobs Converter::projectJobs()
 {
     Jobs jobs;
     for (int d = 0; d < Project::instance()->count(); ++d) {
@@ -75,34 +87,96 @@ void Converter::start(const Profile &profile)
         jobs << job;
     }
 
-    start(jobs, profile);
+    return jobs;
+}
+
+/************************************************
+
+ ************************************************/
+void Converter::start(const Profile &profile)
+{
+    start(projectJobs(), profile);
+}
+
+/************************************************
+ *
+ ************************************************/
+void Converter::start(const Profiles &profiles)
+{
+    start(projectJobs(), profiles);
 }
 
 /************************************************
  *
  ************************************************/
 void Converter::start(const Converter::Jobs &jobs, const Profile &profile)
+{
+    Profiles profiles;
+    profiles << profile;
+    start(jobs, profiles);
+}
+
+/************************************************
+ *
+ ************************************************/
+void Converter::start(const Converter::Jobs &jobs, const Profiles &profiles)
 {
     qCDebug(LOG) << "Start converter:" << jobs.length() << "\n"
-                 << profile;
-    qCDebug(LOG) << "Temp dir =" << profile.tmpDir();
+                 << profiles;
 
-    if (jobs.isEmpty()) {
+    if (jobs.isEmpty() || profiles.isEmpty()) {
         emit finished();
         return;
     }
 
-    if (!validate(jobs, profile)) {
-        emit finished();
-        return;
+    qCDebug(LOG) << "Temp dir =" << profiles.first().tmpDir();
+
+    for (const Profile &profile : profiles) {
+        if (!validate(jobs, profile)) {
+            emit finished();
+            return;
+        }
+    }
+
+    // The user defined threads count is the upper bound for the adaptive limit.
+    qCDebug(LOG) << "Threads count" << profiles.first().encoderMinThreadsCount() << "-" << profiles.first().encoderThreadsCount();
+
+    QVector<const Track *> allTracks;
+    for (const Job &job : jobs) {
+        allTracks << job.tracks;
     }
+    mJournal.open(allTracks, profiles);
+
+    mProfiles = profiles;
+    mDeviceIo.clear();
+    mSkipped.clear();
+    mRetaggers.clear();
+    mRetagRequests.clear();
 
-    mThreadCount = profile.encoderThreadsCount();
+    mTodo = skipDoneTracks(jobs, profiles, &mSkipped);
+    if (mIncremental) {
+        mTodo = skipUnchangedTracks(mTodo, profiles, &mSkipped);
+    }
 
-    qCDebug(LOG) << "Threads count" << mThreadCount;
+    emit started();
 
+    // The tracks with changed tags are retagged first, the failed ones are converted
+    if (!mRetagRequests.isEmpty()) {
+        mConvertAfterRetag = true;
+        startRetag();
+        return;
+    }
+
+    startPipelines();
+}
+
+/************************************************
+ *
+ ************************************************/
+void Converter::startPipelines()
+{
     try {
-        for (const Job &converterJob : jobs) {
+        for (const Job &converterJob : std::as_const(mTodo)) {
 
             if (converterJob.tracks.isEmpty() || converterJob.disc->isEmpty()) {
                 continue;
@@ -112,7 +186,7 @@ void Converter::start(const Converter::Jobs &jobs, const Profile &profile)
                 continue;
             }
 
-            mDiskPiplines << createDiscPipeline(profile, converterJob);
+            mDiskPiplines << createDiscPipeline(mProfiles, converterJob);
         }
     }
     catch (const FlaconError &err) {
@@ -120,36 +194,352 @@ void Converter::start(const Converter::Jobs &jobs, const Profile &profile)
         emit error(err.what());
         qDeleteAll(mDiskPiplines);
         mDiskPiplines.clear();
+        mJournal.close();
         emit finished();
+        return;
     }
 
     mTotalProgressCounter.init(*this);
     connect(this, &Converter::trackProgress, &mTotalProgressCounter, &TotalProgressCounter::setTrackProgress, Qt::UniqueConnection);
     connect(&mTotalProgressCounter, &TotalProgressCounter::changed, this, &Converter::totalProgress, Qt::UniqueConnection);
 
+    connect(this, &Converter::trackProgress, &mConcurrency, &ConcurrencyController::setTrackProgress, Qt::UniqueConnection);
+    connect(&mConcurrency, &ConcurrencyController::limitsChanged, this, &Converter::startThread, Qt::UniqueConnection);
+    mConcurrency.start(mProfiles.first().encoderMinThreadsCount(), mProfiles.first().encoderThreadsCount());
+    mProgressTimer.start();
+
+    for (const Track *track : std::as_const(mSkipped)) {
+        emit trackProgress(*track, TrackState::OK, 0);
+    }
+    mSkipped.clear();
+
     startThread();
+}
+
+/************************************************
+ * Tags, embedded CUE and cover are rewritten in
+ * place. The ReplayGain tags stay as they are,
+ * their values can't be calculated without the
+ * audio.
+ ************************************************/
+void Converter::retag(const Jobs &jobs, const Profiles &profiles)
+{
+    qCDebug(LOG) << "Start retag:" << jobs.length() << "\n"
+                 << profiles;
+
+    mRetaggers.clear();
+    mRetagRequests.clear();
+    mConvertAfterRetag = false;
+
+    for (const Profile &profile : profiles) {
+        mRetaggers << Retagger(profile);
+    }
+
+    for (const Job &job : jobs) {
+        if (job.tracks.isEmpty() || job.disc->isEmpty()) {
+            continue;
+        }
+
+        for (int i = 0; i < mRetaggers.count(); ++i) {
+            mRetaggers[i].prepare(job.disc);
+
+            for (const Track *track : job.tracks) {
+                mRetagRequests << RetagRequest { *track, track, i, false, QString() };
+            }
+        }
+    }
+
+    // Nothing to do is not an error
     emit started();
+
+    if (mRetagRequests.isEmpty()) {
+        emit finished();
+        return;
+    }
+
+    startRetag();
 }
 
 /************************************************
  *
  ************************************************/
-DiscPipeline *Converter::createDiscPipeline(const Profile &profile, const Converter::Job &converterJob)
+void Converter::retag(const Profiles &profiles)
 {
-    DiscPipeline *pipeline = new DiscPipeline(profile, converterJob.disc, converterJob.tracks, this);
+    retag(projectJobs(), profiles);
+}
+
+/************************************************
+ *
+ ************************************************/
+void Converter::startRetag()
+{
+    mRetagWatcher.setFuture(QtConcurrent::map(mRetagRequests, [this](RetagRequest &request) {
+        try {
+            mRetaggers.at(request.retagger).retag(request.track);
+        }
+        catch (const FlaconError &err) {
+            request.error = err.what();
+        }
+        request.done = true;
+    }));
+}
+
+/************************************************
+ *
+ ************************************************/
+void Converter::retagFinished()
+{
+    struct Result
+    {
+        const Track *track  = nullptr;
+        const Track *source = nullptr;
+        TrackState   state  = TrackState::OK;
+        QString      error;
+    };
+
+    // Every track is reported once for all the profiles
+    QMap<std::pair<Disc *, int>, Result> results;
+
+    for (const RetagRequest &request : std::as_const(mRetagRequests)) {
+        const Profile &profile = mRetaggers.at(request.retagger).profile();
+
+        Result &res = results[std::make_pair(request.track.disc(), request.track.index())];
+        res.track   = &request.track;
+        res.source  = request.source;
+
+        if (!request.done) {
+            res.state = res.state == TrackState::Error ? res.state : TrackState::Aborted;
+            continue;
+        }
+
+        if (!request.error.isEmpty()) {
+            qCWarning(LOG) << "Can't retag" << profile.resultFilePath(&request.track) << request.error;
+            res.state = TrackState::Error;
+            res.error = request.error;
+            continue;
+        }
+
+        Fingerprints::instance()->store(profile, request.track);
+    }
+
+    // The incremental run converts the tracks that can't be retagged
+    if (mConvertAfterRetag && !mRetagWatcher.isCanceled()) {
+        for (const Result &res : std::as_const(results)) {
+            if (res.state == TrackState::OK) {
+                mSkipped << res.source;
+            }
+            else {
+                qCWarning(LOG) << "Can't update tags, convert the track again:" << res.error;
+                addTodoTrack(res.source);
+            }
+        }
+
+        mRetagRequests.clear();
+        mRetaggers.clear();
+        startPipelines();
+        return;
+    }
+
+    for (const Result &res : std::as_const(results)) {
+        if (!res.error.isEmpty()) {
+            emit error(res.error);
+        }
+        emit trackProgress(*res.track, res.state, 0);
+    }
+
+    mRetagRequests.clear();
+    mRetaggers.clear();
+    if (mConvertAfterRetag) {
+        mJournal.close();
+    }
+    emit finished();
+}
+
+/************************************************
+ * The album gain needs all the disc tracks, so
+ * the whole disc is converted again.
+ ************************************************/
+void Converter::addTodoTrack(const Track *track)
+{
+    Disc *disc = track->disc();
+
+    auto job = std::find_if(mTodo.begin(), mTodo.end(), [disc](const Job &j) { return j.disc == disc; });
+    if (job == mTodo.end()) {
+        mTodo << Job { disc, {} };
+        job = mTodo.end() - 1;
+    }
+
+    bool albumGain = false;
+    for (const Profile &profile : std::as_const(mProfiles)) {
+        albumGain = albumGain || profile.gainType() == GainType::Album;
+    }
+
+    if (albumGain) {
+        job->tracks.clear();
+        for (int t = 0; t < disc->count(); ++t) {
+            job->tracks << disc->track(t);
+        }
+
+        mSkipped.erase(std::remove_if(mSkipped.begin(), mSkipped.end(), [disc](const Track *t) { return t->disc() == disc; }), mSkipped.end());
+        return;
+    }
+
+    if (!job->tracks.contains(track)) {
+        job->tracks << track;
+        std::sort(job->tracks.begin(), job->tracks.end(), [](const Track *a, const Track *b) { return a->index() < b->index(); });
+    }
+}
+
+/************************************************
+ *
+ ************************************************/
+DiscPipeline *Converter::createDiscPipeline(const Profiles &profiles, const Converter::Job &converterJob)
+{
+    DiscPipeline *pipeline = new DiscPipeline(profiles, converterJob.disc, converterJob.tracks, this);
+
+    pipeline->setJournal(&mJournal);
+    pipeline->setVerifyEnabled(mVerify);
+    pipeline->setAccurateRipEnabled(mAccurateRip);
 
     connect(pipeline, &DiscPipeline::readyStart, this, &Converter::startThread);
     connect(pipeline, &DiscPipeline::threadFinished, this, &Converter::startThread);
     connect(pipeline, &DiscPipeline::trackProgressChanged, this, &Converter::trackProgress);
+    connect(pipeline, &DiscPipeline::sourceRead, this, [this](DeviceId device, qint64 bytes, qint64 elapsedMs) {
+        DeviceIo &io = mDeviceIo[device];
+        io.bytes += bytes;
+        io.elapsedMs += elapsedMs;
+    });
 
     return pipeline;
 }
 
+/************************************************
+ * Tracks converted by an interrupted run of the
+ * same batch are not converted again. The album
+ * gain needs all tracks of the disc, so such discs
+ * are skipped only as a whole.
+ ************************************************/
+Converter::Jobs Converter::skipDoneTracks(const Jobs &jobs, const Profiles &profiles, QVector<const Track *> *skipped) const
+{
+    if (!mJournal.isOpen()) {
+        return jobs;
+    }
+
+    bool albumGain = false;
+    for (const Profile &profile : profiles) {
+        albumGain = albumGain || profile.gainType() == GainType::Album;
+    }
+
+    Jobs res;
+    for (const Job &job : jobs) {
+        Job                    todo;
+        QVector<const Track *> done;
+        todo.disc = job.disc;
+
+        for (const Track *track : job.tracks) {
+            bool isDone = true;
+            for (const Profile &profile : profiles) {
+                isDone = isDone && mJournal.isDone(profile, *track);
+            }
+
+            if (isDone) {
+                done << track;
+            }
+            else {
+                todo.tracks << track;
+            }
+        }
+
+        if (albumGain && !todo.tracks.isEmpty()) {
+            todo.tracks = job.tracks;
+            done.clear();
+        }
+
+        qCDebug(LOG) << "Skip" << done.count() << "already converted tracks of" << job.disc->cueFilePath();
+        *skipped << done;
+        res << todo;
+    }
+
+    return res;
+}
+
+/************************************************
+ * The album gain depends on the audio of all the
+ * disc tracks. If one of them is converted, the
+ * whole disc is converted.
+ ************************************************/
+Converter::Jobs Converter::skipUnchangedTracks(const Jobs &jobs, const Profiles &profiles, QVector<const Track *> *skipped)
+{
+    bool albumGain = false;
+    for (const Profile &profile : profiles) {
+        albumGain = albumGain || profile.gainType() == GainType::Album;
+    }
+
+    for (const Profile &profile : profiles) {
+        mRetaggers << Retagger(profile);
+    }
+
+    Jobs res;
+    for (const Job &job : jobs) {
+        Job                    todo;
+        QVector<const Track *> same;
+        QVector<const Track *> retag;
+        todo.disc = job.disc;
+
+        for (const Track *track : job.tracks) {
+            Fingerprints::Match match = Fingerprints::Match::Same;
+            for (const Profile &profile : profiles) {
+                match = qMin(match, Fingerprints::instance()->match(profile, *track));
+            }
+
+            switch (match) {
+                case Fingerprints::Match::Changed:
+                    todo.tracks << track;
+                    break;
+
+                case Fingerprints::Match::TagsChanged:
+                    retag << track;
+                    break;
+
+                case Fingerprints::Match::Same:
+                    same << track;
+                    break;
+            }
+        }
+
+        if (albumGain && !todo.tracks.isEmpty()) {
+            res << job;
+            continue;
+        }
+
+        // The retag runs on the thread pool, see retagFinished()
+        for (const Track *track : std::as_const(retag)) {
+            for (int i = 0; i < profiles.count(); ++i) {
+                if (Fingerprints::instance()->match(profiles.at(i), *track) == Fingerprints::Match::TagsChanged) {
+                    mRetaggers[i].prepare(job.disc);
+                    mRetagRequests << RetagRequest { *track, track, i, false, QString() };
+                }
+            }
+        }
+
+        qCDebug(LOG) << "Skip" << same.count() << "unchanged tracks of" << job.disc->cueFilePath() << "retagged" << retag.count();
+        *skipped << same;
+        res << todo;
+    }
+
+    return res;
+}
+
 /************************************************
 
  ************************************************/
 bool Converter::isRunning()
 {
+    // The requests are cleared when the retag is finished
+    if (!mRetagRequests.isEmpty()) {
+        return true;
+    }
+
     foreach (DiscPipeline *pipe, mDiskPiplines) {
         if (pipe->isRunning())
             return true;
@@ -166,6 +556,8 @@ void Converter::stop()
     if (!isRunning())
         return;
 
+    mRetagWatcher.cancel();
+
     foreach (DiscPipeline *pipe, mDiskPiplines) {
         pipe->stop();
     }
@@ -176,15 +568,43 @@ void Converter::stop()
  ************************************************/
 void Converter::startThread()
 {
-    int count         = mThreadCount;
-    int splitterCount = qMax(1.0, ceil(count / 2.0));
+    int count         = mConcurrency.threadsLimit();
+    int splitterCount = mConcurrency.splittersLimit();
+
+    // A hard disk or a network share serves one disc at a time: the splitter
+    // reads the source and writes the temporary directory, the encoders write
+    // the results. The discs on different or solid-state devices run in parallel.
+    QHash<DeviceId, const DiscPipeline *> deviceOwners;
 
     foreach (DiscPipeline *pipe, mDiskPiplines) {
         count -= pipe->runningThreadCount();
+        splitterCount -= pipe->runningSplitterCount();
+        for (DeviceId dev : pipe->busyDevices()) {
+            deviceOwners.insert(dev, pipe);
+        }
     }
 
+    auto isFree = [&deviceOwners](const DiscPipeline *pipe, const QVector<DeviceId> &devices) {
+        for (DeviceId dev : devices) {
+            if (deviceOwners.value(dev, pipe) != pipe) {
+                return false;
+            }
+        }
+        return true;
+    };
+
     foreach (DiscPipeline *pipe, mDiskPiplines) {
-        pipe->startWorker(&splitterCount, &count);
+        int allowed = isFree(pipe, pipe->splitterDevices()) ? splitterCount : 0;
+        int left    = allowed;
+        pipe->startWorker(&left, &count, isFree(pipe, pipe->encoderDevices()));
+        splitterCount -= allowed - left;
+
+        for (DeviceId dev : pipe->busyDevices()) {
+            if (!deviceOwners.contains(dev)) {
+                deviceOwners.insert(dev, pipe);
+            }
+        }
+
         if (count <= 0) {
             break;
         }
@@ -196,9 +616,28 @@ void Converter::startThread()
         }
     }
 
+    for (auto it = mDeviceIo.constBegin(); it != mDeviceIo.constEnd(); ++it) {
+        qCDebug(LOG) << "Device" << it.key() << "read" << it->bytes << "bytes in" << it->elapsedMs << "ms," << it->throughput() << "MB/s";
+    }
+
+    mConcurrency.stop();
+    mProgressTimer.stop();
+    mJournal.close();
     emit finished();
 }
 
+/************************************************
+ * The workers don't send the percents, we sample
+ * them with a fixed rate. So the number of events
+ * doesn't depend on the number of running tracks.
+ ************************************************/
+void Converter::collectProgress()
+{
+    for (DiscPipeline *pipe : std::as_const(mDiskPiplines)) {
+        pipe->collectProgress();
+    }
+}
+
 /************************************************
 
  ************************************************/
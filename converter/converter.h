@@ -30,12 +30,20 @@
 #include <QObject>
 #include <QDateTime>
 #include <QVector>
+#include <QHash>
+#include "convertertypes.h"
 #include "totalprogresscounter.h"
+#include "concurrencycontroller.h"
+#include "journal.h"
+#include "retagger.h"
+#include "../track.h"
+#include <QFutureWatcher>
+#include <QTimer>
 #include "../validator/validator.h"
+#include "../profiles.h"
 
 class Disc;
 class Track;
-class Profile;
 
 namespace Conv {
 
@@ -59,29 +67,98 @@ public:
 
     QVector<DiscPipeline *> diskPiplines() const { return mDiskPiplines; }
 
+    /// In the incremental mode the tracks whose result file is up to date are skipped,
+    /// and the tracks with changed tags only get a metadata rewrite.
+    bool isIncremental() const { return mIncremental; }
+    void setIncremental(bool value) { mIncremental = value; }
+
+    /// The lossless result files are decoded back and compared with the source audio.
+    bool isVerify() const { return mVerify; }
+    void setVerify(bool value) { mVerify = value; }
+
+    /// The AccurateRip and CTDB CRCs are calculated while splitting, no database is queried.
+    bool isAccurateRip() const { return mAccurateRip; }
+    void setAccurateRip(bool value) { mAccurateRip = value; }
+
+    struct DeviceIo
+    {
+        qint64 bytes     = 0;
+        qint64 elapsedMs = 0;
+
+        /// MB per second
+        double throughput() const { return (bytes / 1048576.0) / qMax<qint64>(1, elapsedMs) * 1000; }
+    };
+
+    /// The source audio read by the splitters of the last run, per device.
+    QHash<DeviceId, DeviceIo> deviceIo() const { return mDeviceIo; }
+
 signals:
     void started();
     void finished();
     void trackProgress(const Track &track, TrackState state, Percent percent);
     void error(const QString err);
-    void totalProgress(double percent);
+    void totalProgress(double percent, double throughput, int eta);
 
 public slots:
+    /// Converts all the tracks of the project.
     void start(const Profile &profile);
+    void start(const Profiles &profiles);
     void start(const Jobs &jobs, const Profile &profile);
+
+    /// Every track is decoded and split once, and encoded with each of the profiles.
+    void start(const Jobs &jobs, const Profiles &profiles);
+
+    /// Rewrites the tags and the cover of the existing result files without encoding.
+    /// The files are processed in parallel on the global thread pool.
+    void retag(const Jobs &jobs, const Profiles &profiles);
+    void retag(const Profiles &profiles);
     void stop();
 
 private slots:
     void startThread();
+    void retagFinished();
+    void collectProgress();
 
 private:
-    int                     mThreadCount = 0;
     Validator               mValidator;
     QVector<DiscPipeline *> mDiskPiplines;
     TotalProgressCounter    mTotalProgressCounter;
+    ConcurrencyController   mConcurrency;
+    QTimer                  mProgressTimer;
+    Journal                 mJournal;
+    bool                    mIncremental = false;
+    bool                    mVerify      = false;
+    bool                    mAccurateRip = false;
+
+    struct RetagRequest
+    {
+        Track        track;
+        const Track *source   = nullptr;
+        int          retagger = 0;
+        bool         done     = false;
+        QString      error;
+    };
+
+    QVector<Retagger>     mRetaggers;
+    QVector<RetagRequest> mRetagRequests;
+    QFutureWatcher<void>  mRetagWatcher;
+
+    Profiles               mProfiles;
+    Jobs                   mTodo;
+    QVector<const Track *> mSkipped;
+    bool                   mConvertAfterRetag = false;
+
+    QHash<DeviceId, DeviceIo> mDeviceIo;
+
+    void startPipelines();
+    void startRetag();
+    void addTodoTrack(const Track *track);
 
+    static Jobs   projectJobs();
     bool          validate(const Jobs &jobs, const Profile &profile);
-    DiscPipeline *createDiscPipeline(const Profile &profile, const Job &converterJob);
+    Jobs          skipDoneTracks(const Jobs &jobs, const Profiles &profiles, QVector<const Track *> *skipped) const;
+    Jobs          skipUnchangedTracks(const Jobs &jobs, const Profiles &profiles, QVector<const Track *> *skipped);
+    DiscPipeline *createDiscPipeline(const Profiles &profiles, const Job &converterJob);
 };
 
 }
@@ -27,6 +27,14 @@
 #include "../formats_out/outformat.h"
 #include "../profiles.h"
 
+#include <QFile>
+#include <QFileInfo>
+#include <QStorageInfo>
+#include <sys/stat.h>
+#ifdef Q_OS_LINUX
+#include <sys/sysmacros.h>
+#endif
+
 using namespace Conv;
 
 /************************************************
@@ -36,3 +44,74 @@ ConvTrack::ConvTrack(const Track &other) :
     Track(other)
 {
 }
+
+/************************************************
+ *
+ ************************************************/
+static QString existingPath(const QString &path)
+{
+    QFileInfo fi(path);
+    while (!fi.exists()) {
+        const QString parent = fi.absolutePath();
+        if (parent == fi.absoluteFilePath()) {
+            return QString();
+        }
+        fi.setFile(parent);
+    }
+
+    return fi.absoluteFilePath();
+}
+
+/************************************************
+ *
+ ************************************************/
+DeviceId Conv::deviceId(const QString &path)
+{
+    const QString file = existingPath(path);
+    if (file.isEmpty()) {
+        return 0;
+    }
+
+    struct stat st;
+    if (stat(QFile::encodeName(file).constData(), &st) != 0) {
+        return 0;
+    }
+
+    return DeviceId(st.st_dev);
+}
+
+/************************************************
+ * Parallel reads make a hard disk seek, a network
+ * filesystem splits its bandwidth between them.
+ * SSDs and unknown devices aren't limited.
+ ************************************************/
+bool Conv::isSeekBoundDevice(const QString &path)
+{
+    const QString file = existingPath(path);
+    if (file.isEmpty()) {
+        return false;
+    }
+
+    const QByteArray fsType = QStorageInfo(file).fileSystemType().toLower();
+    if (fsType.startsWith("nfs") || fsType.startsWith("smb") || fsType == "cifs" || fsType == "9p" || fsType == "fuse.sshfs") {
+        return true;
+    }
+
+#ifdef Q_OS_LINUX
+    const DeviceId dev = deviceId(file);
+    if (dev == 0) {
+        return false;
+    }
+
+    // The partitions don't have a queue, it belongs to the parent disk
+    const QString sysDir = QString("/sys/dev/block/%1:%2").arg(major(dev)).arg(minor(dev));
+    for (const QString &name : { sysDir + "/queue/rotational", sysDir + "/../queue/rotational" }) {
+        QFile rotational(name);
+        if (rotational.open(QFile::ReadOnly)) {
+            return rotational.readAll().trimmed() == "1";
+        }
+    }
+#endif
+
+    return false;
+}
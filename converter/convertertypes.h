@@ -49,12 +49,29 @@ public:
     bool isPregap() const { return mPregap; }
     void setPregap(bool value) { mPregap = value; }
 
+    /// Position of the track in the DiscPipeline track list.
+    /// Progress notifications refer to the track by this number.
+    int  id() const { return mId; }
+    void setId(int value) { mId = value; }
+
 private:
     bool mPregap = false;
+    int  mId     = -1;
 };
 
 using ConvTracks = QList<ConvTrack>;
 
+/// Identifies the device (st_dev) that holds a file or directory.
+using DeviceId = quint64;
+
+/// Returns the device of the path, or of its closest existing parent directory.
+/// Returns 0 if the device can't be determined.
+DeviceId deviceId(const QString &path);
+
+/// Returns true if the path is on a rotational disk or a network filesystem,
+/// where several readers at once are slower than one.
+bool isSeekBoundDevice(const QString &path);
+
 } // namespace
 
 Q_DECLARE_METATYPE(Conv::ConvTrack)
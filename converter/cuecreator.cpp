@@ -218,6 +218,23 @@ void CueCreator::write(QIODevice *out)
 }
 
 QString CueCreator::writeToFile(const QString &fileTemplate)
+{
+    QFile file(filePath(fileTemplate));
+
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Text)) {
+        throw FlaconError(QObject::tr("I can't write CUE file <b>%1</b>:<br>%2").arg(file.fileName(), file.errorString()));
+    }
+
+    write(&file);
+    file.close();
+
+    return file.fileName();
+}
+
+/************************************************
+ *
+ ************************************************/
+QString CueCreator::filePath(const QString &fileTemplate) const
 {
     Track          *track = mDisc->track(0);
     QString         dir   = QFileInfo(mProfile.resultFilePath(track)).dir().absolutePath();
@@ -239,15 +256,5 @@ QString CueCreator::writeToFile(const QString &fileTemplate)
 
     fileName += ".cue";
 
-    QFile file;
-    file.setFileName(dir + QDir::separator() + fileName);
-
-    if (!file.open(QIODevice::WriteOnly | QIODevice::Text)) {
-        throw FlaconError(QObject::tr("I can't write CUE file <b>%1</b>:<br>%2").arg(file.fileName(), file.errorString()));
-    }
-
-    write(&file);
-    file.close();
-
-    return fileName;
+    return dir + QDir::separator() + fileName;
 }
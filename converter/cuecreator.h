@@ -44,6 +44,7 @@ public:
 
     void    write(QIODevice *out);
     QString writeToFile(const QString &fileTemplate);
+    QString filePath(const QString &fileTemplate) const;
 
 private:
     const Disc      *mDisc;
@@ -63,6 +63,7 @@ Decoder::Decoder(QObject *parent) :
     mFormat(nullptr),
     mProcess(nullptr),
     mFile(nullptr),
+    mNative(nullptr),
     mPos(0)
 {
 }
@@ -74,6 +75,7 @@ Decoder::~Decoder()
 {
     close();
     delete mFile;
+    delete mNative;
     delete mProcess;
 }
 
@@ -92,6 +94,11 @@ void Decoder::open(const QString &fileName)
         throw FlaconError(tr("The audio file may be corrupted or an unsupported audio format.", "Error message."));
     }
 
+    QIODevice *native = mFormat->createNativeDecoder(fileName);
+    if (native) {
+        return openNative(native);
+    }
+
     if (mFormat->decoderProgram()) {
         return openProcess();
     }
@@ -159,6 +166,29 @@ void Decoder::openProcess()
     mPos = mWavHeader.dataStartPos();
 }
 
+/************************************************
+ *
+ ************************************************/
+void Decoder::openNative(QIODevice *device)
+{
+    mNative = device;
+    mNative->setParent(this);
+
+    if (!mNative->open(QIODevice::ReadOnly)) {
+        qCWarning(LOG) << "The audio file may be corrupted:" << mNative->errorString();
+        throw FlaconError(tr("The audio file may be corrupted or an unsupported audio format.", "Error message."));
+    }
+
+    try {
+        mWavHeader = WavHeader(mNative);
+        mPos       = mWavHeader.dataStartPos();
+    }
+    catch (const FlaconError &err) {
+        qCWarning(LOG) << "The audio file may be corrupted:" << err.what();
+        throw FlaconError(tr("The audio file may be corrupted or an unsupported audio format.", "Error message."));
+    }
+}
+
 /************************************************
  *
  ************************************************/
@@ -167,6 +197,9 @@ void Decoder::close()
     if (mFile)
         mFile->close();
 
+    if (mNative)
+        mNative->close();
+
     if (mProcess) {
         mProcess->terminate();
         mProcess->waitForFinished();
@@ -193,7 +226,8 @@ void mustWrite(const char *buf, qint64 maxSize, QIODevice *outDevice)
 }
 
 /************************************************
- *
+ * The random access devices seek, the pipes are
+ * read to the position.
  ************************************************/
 bool mustSkip(QIODevice *device, qint64 size, int msecs = READ_DELAY)
 {
@@ -202,6 +236,9 @@ bool mustSkip(QIODevice *device, qint64 size, int msecs = READ_DELAY)
     if (size == 0)
         return true;
 
+    if (!device->isSequential())
+        return device->seek(device->pos() + size);
+
     char   buf[BUF_SIZE];
     qint64 left = size;
     while (left > 0) {
@@ -227,6 +264,8 @@ void Decoder::extract(const CueTime &start, const CueTime &end, QIODevice *outDe
         QIODevice *input;
         if (mProcess)
             input = mProcess;
+        else if (mNative)
+            input = mNative;
         else
             input = mFile;
 
@@ -241,7 +280,7 @@ void Decoder::extract(const CueTime &start, const CueTime &end, QIODevice *outDe
         if (writeHeader) {
             WavHeader hdr = mWavHeader;
             hdr.resizeData(be - bs);
-            outDevice->write(hdr.toLegacyWav());
+            outDevice->write(hdr.toWav());
         }
 
         qint64 pos = mPos;
@@ -71,11 +71,13 @@ private:
     QProcess          *mProcess;
     QString            mInputFile;
     QFile             *mFile;
+    QIODevice         *mNative;
     WavHeader          mWavHeader;
     quint64            mPos;
 
     void openFile();
     void openProcess();
+    void openNative(QIODevice *device);
 };
 
 } // namespace
@@ -29,10 +29,12 @@
 
 #include "splitter.h"
 #include "encoder.h"
+#include "verifier.h"
 #include "cuecreator.h"
 #include "inputaudiofile.h"
 #include "profiles.h"
 #include "formats_out/metadatawriter.h"
+#include "fingerprints.h"
 
 #include <QThread>
 #include <QDebug>
@@ -43,6 +45,10 @@
 #include <QLoggingCategory>
 #include <QBuffer>
 #include <QPointer>
+#include <QElapsedTimer>
+#include <QSet>
+#include <QTextStream>
+#include <QRegularExpression>
 
 namespace {
 Q_LOGGING_CATEGORY(LOG, "DiscPipeline")
@@ -95,14 +101,25 @@ void WorkerThread::run()
     mWorker->run();
 }
 
+/************************************************
+ *
+ ************************************************/
+static void addSeekBoundDevice(QVector<DeviceId> *devices, const QString &path)
+{
+    const DeviceId dev = deviceId(path);
+    if (dev != 0 && !devices->contains(dev) && isSeekBoundDevice(path)) {
+        *devices << dev;
+    }
+}
+
 /************************************************
 
  ************************************************/
 QString DiscPipeline::getWorkDir(const Track &track) const
 {
-    QString dir = mProfile.tmpDir();
+    QString dir = mainProfile().tmpDir();
     if (dir.isEmpty()) {
-        dir = QFileInfo(mProfile.resultFilePath(&track)).dir().absolutePath();
+        dir = QFileInfo(mainProfile().resultFilePath(&track)).dir().absolutePath();
     }
     return dir + "/tmp";
 }
@@ -110,12 +127,22 @@ QString DiscPipeline::getWorkDir(const Track &track) const
 /************************************************
  *
  ************************************************/
-DiscPipeline::DiscPipeline(const Profile &profile, Disc *disc, const QVector<const Track *> &reqTracks, QObject *parent) noexcept(false) :
+DiscPipeline::DiscPipeline(const Profiles &profiles, Disc *disc, const QVector<const Track *> &reqTracks, QObject *parent) noexcept(false) :
     QObject(parent),
-    mProfile(profile),
     mDisc(disc)
 {
-    mPregapType = profile.isCreateCue() ? profile.pregapType() : PreGapType::Skip;
+    if (profiles.isEmpty()) {
+        throw FlaconError("Profiles list is empty");
+    }
+
+    for (const Profile &profile : profiles) {
+        Output output;
+        output.profile = profile;
+        mOutputs << output;
+    }
+
+    // All profiles share the same split files, the first profile defines how we split.
+    mPregapType = mainProfile().isCreateCue() ? mainProfile().pregapType() : PreGapType::Skip;
 
     for (const TrackPtrList &tracks : disc->tracksByFileTag()) {
 
@@ -133,6 +160,7 @@ DiscPipeline::DiscPipeline(const Profile &profile, Disc *disc, const QVector<con
 
             ConvTrack track(pregapTrack);
             track.setPregap(true);
+            track.setId(mTracks.count());
 
             mTracks << track;
         }
@@ -147,6 +175,7 @@ DiscPipeline::DiscPipeline(const Profile &profile, Disc *disc, const QVector<con
 
             ConvTrack track(*t);
             track.setPregap(false);
+            track.setId(mTracks.count());
 
             mTracks << track;
         }
@@ -163,16 +192,27 @@ DiscPipeline::DiscPipeline(const Profile &profile, Disc *disc, const QVector<con
     mTmpDir = new QTemporaryDir(QString("%1/tmp").arg(dir));
     mTmpDir->setAutoRemove(true);
 
-    for (const ConvTrack &track : std::as_const(mTracks)) {
-        if (track.audioFile().channelsCount() > 2) {
-            mProfile.setGainType(GainType::Disable);
-        }
+    mSourceDevice  = deviceId(mTracks.first().audioFile().filePath());
+    mProgressBoard = QSharedPointer<ProgressBoard>::create(mTracks.count(), mOutputs.count());
 
+    for (const ConvTrack &track : std::as_const(mTracks)) {
         mTrackStates[track.index()] = TrackState::NotRunning;
         updateDiskState();
 
-        qCDebug(LOG) << "Create directory for output files" << dir;
-        createDir(QFileInfo(mProfile.resultFilePath(&track)).absoluteDir().path());
+        for (Output &output : mOutputs) {
+            if (track.audioFile().channelsCount() > uint(ReplayGain::MAX_CHANNELS)) {
+                output.profile.setGainType(GainType::Disable);
+            }
+
+            qCDebug(LOG) << "Create directory for output files" << dir;
+            createDir(QFileInfo(output.profile.resultFilePath(&track)).absoluteDir().path());
+        }
+    }
+
+    addSeekBoundDevice(&mSplitterDevices, mTracks.first().audioFile().filePath());
+    addSeekBoundDevice(&mSplitterDevices, mTmpDir->path());
+    for (const Output &output : std::as_const(mOutputs)) {
+        addSeekBoundDevice(&mEncoderDevices, output.profile.resultFilePath(&mTracks.first()));
     }
 
     addSpliterRequest();
@@ -192,17 +232,38 @@ DiscPipeline::~DiscPipeline()
         t->deleteLater();
     }
 
+    releaseScratch();
+    delete mMemoryTmpDir;
     delete mTmpDir;
 }
 
+/************************************************
+ *
+ ************************************************/
+bool DiscPipeline::isGainEnabled() const
+{
+    for (const Output &output : mOutputs) {
+        if (output.profile.gainType() != GainType::Disable) {
+            return true;
+        }
+    }
+    return false;
+}
+
 /************************************************
  CREATE WORKER CHAINS
  ************************************************
               +--> Encoder ---> +
-   Splitter ->+            ...  +-> writeGain --> trackDone
+   Splitter ->+            ...  +-> writeGain --> [Verifier] --> trackDone
               +--> Encoder ---> +
+
+ Every split track is passed to one encoder
+ per profile, the ReplayGain is calculated
+ by the splitter only once.
+ The verifiers get the threads the encoders
+ left unused, so they run at a lower priority.
  ************************************************/
-void DiscPipeline::startWorker(int *splitterCount, int *count)
+void DiscPipeline::startWorker(int *splitterCount, int *count, bool encoderDevicesFree)
 {
     if (mInterrupted) {
         return;
@@ -212,7 +273,7 @@ void DiscPipeline::startWorker(int *splitterCount, int *count)
         return;
     }
 
-    if (*splitterCount > 0 && !mSplitterRequests.isEmpty()) {
+    if (*splitterCount > 0 && !mSplitterRequests.isEmpty() && reserveScratch(&mSplitterRequests.first())) {
         SplitterRequest req = mSplitterRequests.takeFirst();
         startSplitter(req);
         --(*splitterCount);
@@ -220,9 +281,19 @@ void DiscPipeline::startWorker(int *splitterCount, int *count)
         return;
     }
 
+    if (!encoderDevicesFree) {
+        return;
+    }
+
     while (*count > 0 && !mEncoderRequests.isEmpty()) {
         const Request req = mEncoderRequests.takeFirst();
-        startEncoder(req.track, req.inputFile);
+        startEncoder(req);
+        --(*count);
+    }
+
+    while (*count > 0 && !mVerifyRequests.isEmpty()) {
+        const VerifyRequest req = mVerifyRequests.takeFirst();
+        startVerifier(req);
         --(*count);
     }
 }
@@ -237,6 +308,54 @@ void DiscPipeline::addSpliterRequest()
     mSplitterRequests << SplitterRequest { mTracks, outDir, mPregapType };
 }
 
+/************************************************
+ * The split tracks go to RAM when they fit into
+ * the memory budget. Returns false if there is
+ * no room for them yet.
+ ************************************************/
+bool DiscPipeline::reserveScratch(SplitterRequest *request)
+{
+    if (mScratch.location != ScratchSpace::Location::None) {
+        return true;
+    }
+
+    qint64 bytes = 0;
+    for (const ConvTrack &track : std::as_const(request->tracks)) {
+        const InputAudioFile &audio = track.audioFile();
+        bytes += qint64(track.duration()) * audio.sampleRate() * audio.channelsCount() * (audio.bitsPerSample() / 8) / 1000;
+        bytes += 1024; // WAV header
+    }
+
+    mScratch = ScratchSpace::instance()->reserve(bytes, mTmpDir->path());
+
+    if (mScratch.location == ScratchSpace::Location::Memory) {
+        mMemoryTmpDir = new QTemporaryDir(mScratch.dir + "/flacon-XXXXXX");
+        mMemoryTmpDir->setAutoRemove(true);
+
+        if (mMemoryTmpDir->isValid()) {
+            request->outDir = mMemoryTmpDir->path();
+            return true;
+        }
+
+        qCWarning(LOG) << "Can't create temporary directory in" << mScratch.dir << mMemoryTmpDir->errorString();
+        delete mMemoryTmpDir;
+        mMemoryTmpDir = nullptr;
+        ScratchSpace::instance()->releaseAll(&mScratch);
+        mScratch = ScratchSpace::instance()->reserve(bytes, mTmpDir->path(), false);
+    }
+
+    return mScratch.location != ScratchSpace::Location::None;
+}
+
+/************************************************
+ *
+ ************************************************/
+void DiscPipeline::releaseScratch()
+{
+    ScratchSpace::instance()->releaseAll(&mScratch);
+    mScratchFiles.clear();
+}
+
 /************************************************
  *
  ************************************************/
@@ -244,16 +363,32 @@ void DiscPipeline::startSplitter(const SplitterRequest &request)
 {
     Splitter *splitter = new Splitter(mDisc, request.tracks, request.outDir);
     splitter->setPregapType(request.pregapType);
+    splitter->setGainEnabled(isGainEnabled());
+    splitter->setVerifyEnabled(mVerifyEnabled);
+    splitter->setAccurateRipEnabled(mAccurateRipEnabled);
+    splitter->setProgressBoard(mProgressBoard);
     QPointer<WorkerThread> thread = new WorkerThread(splitter, this);
     thread->setObjectName(QString("%1 splitter").arg(mDisc->cueFilePath()));
 
     connect(this, &DiscPipeline::stopAllThreads, thread, &Conv::WorkerThread::deleteLater);
     connect(splitter, &Splitter::trackProgress, this, &DiscPipeline::trackProgress);
     connect(splitter, &Worker::error, this, &DiscPipeline::trackError);
-    connect(splitter, &Splitter::trackReady, this, &DiscPipeline::addEncoderRequest);
+    connect(splitter, &Splitter::trackReady, this, &DiscPipeline::addEncoderRequests);
+    connect(splitter, &Splitter::trackCrcReady, this, &DiscPipeline::addTrackCrc);
+    connect(splitter, &Splitter::discCrcReady, this, [this](quint32 ctdbCrc) {
+        mDiscCrc    = ctdbCrc;
+        mHasDiscCrc = true;
+    });
     connect(thread, &Conv::WorkerThread::finished, this, &DiscPipeline::threadFinished);
 
+    QElapsedTimer timer;
+    timer.start();
+    connect(thread, &Conv::WorkerThread::finished, this, [this, request, timer]() {
+        splitterFinished(request, timer.elapsed());
+    });
+
     mThreads << thread;
+    mSplitterThread = thread;
     thread->start();
 
     for (const ConvTrack &t : request.tracks) {
@@ -264,123 +399,303 @@ void DiscPipeline::startSplitter(const SplitterRequest &request)
     // *********************************************************
     // Short tasks, we do not allocate separate threads for them.
     try {
-        copyCoverImage();
-        createEmbedImage();
-        writeOutCueFile();
-        loadEmbeddedCue();
+        for (Output &output : mOutputs) {
+            copyCoverImage(output.profile);
+            createEmbedImage(&output);
+            writeOutCueFile(output.profile);
+            loadEmbeddedCue(&output);
+        }
     }
     catch (const FlaconError &err) {
         trackError(request.tracks.first(), err.what());
     }
 }
 
+/************************************************
+ * Reports the read throughput of the source device
+ * to the Converter::deviceIo() counters.
+ ************************************************/
+void DiscPipeline::splitterFinished(const SplitterRequest &request, qint64 elapsedMs)
+{
+    QSet<QString> files;
+    for (const ConvTrack &track : request.tracks) {
+        files << track.audioFile().filePath();
+    }
+
+    qint64 bytes = 0;
+    for (const QString &file : std::as_const(files)) {
+        bytes += QFileInfo(file).size();
+    }
+
+    emit sourceRead(mSourceDevice, bytes, elapsedMs);
+
+    // Now we know the real size of the split files, give the rest of the estimate back.
+    qint64 written = 0;
+    for (qint64 size : mScratchFiles) {
+        written += size;
+    }
+    ScratchSpace::instance()->release(&mScratch, mScratch.bytes - written);
+
+    if (!mTrackCrcs.isEmpty() && !mInterrupted) {
+        for (const Output &output : std::as_const(mOutputs)) {
+            writeCrcReport(output.profile);
+        }
+    }
+}
+
 /************************************************
  *
  ************************************************/
-void DiscPipeline::addEncoderRequest(const ConvTrack &track, const QString &inputFile)
+void DiscPipeline::addEncoderRequests(const ConvTrack &track, const QString &inputFile, const ReplayGain::Result &trackGain, const QByteArray &pcmChecksum)
 {
-    mEncoderRequests << Request { track, inputFile };
-    trackProgress(track, TrackState::Queued, 0);
+    for (int i = 0; i < mOutputs.count(); ++i) {
+        mEncoderRequests << Request { track, inputFile, i, trackGain };
+        writeJournal(i, track, Journal::State::Split);
+    }
+
+    mPendingOutputs[track.id()] = mOutputs.count();
+    mOutputStates[track.id()]   = QVector<TrackState>(mOutputs.count(), TrackState::Queued);
+    mInputFileRefs[inputFile]   = mOutputs.count();
+    mScratchFiles[inputFile]    = QFileInfo(inputFile).size();
+
+    if (!pcmChecksum.isEmpty()) {
+        mPcmChecksums[track.id()] = pcmChecksum;
+    }
+
+    trackProgress(track.id(), TrackState::Queued, 0);
     emit readyStart();
 }
 
 /************************************************
  *
  ************************************************/
-void DiscPipeline::startEncoder(const ConvTrack &track, const QString &inputFile)
+void DiscPipeline::addTrackCrc(const ConvTrack &track, quint32 accurateRipV1, quint32 accurateRipV2, quint32 crc32)
+{
+    mTrackCrcs[track.index()] = TrackCrc { track.trackNum(), accurateRipV1, accurateRipV2, crc32 };
+}
+
+/************************************************
+ *
+ ************************************************/
+void DiscPipeline::startEncoder(const Request &request)
 {
-    QFileInfo trackFile(mProfile.resultFilePath(&track));
-    QString   outFile = QDir(mTmpDir->path()).filePath(QFileInfo(inputFile).baseName() + ".encoded." + trackFile.suffix());
+    const Output &output = mOutputs.at(request.output);
+
+    QFileInfo trackFile(output.profile.resultFilePath(&request.track));
+    QString   outFile = QDir(mTmpDir->path()).filePath(QString("%1.%2.encoded.%3").arg(QFileInfo(request.inputFile).baseName()).arg(request.output).arg(trackFile.suffix()));
 
     Encoder *encoder = new Encoder();
-    encoder->setInputFile(inputFile);
+    encoder->setInputFile(request.inputFile);
+    encoder->setKeepInputFile(mOutputs.count() > 1);
     encoder->setOutFile(outFile);
-    encoder->setTrack(track);
-    encoder->setProfile(mProfile);
-    encoder->setEmbeddedCue(mEmbeddedCue);
-    encoder->setCoverImage(mCoverImage);
+    encoder->setTrack(request.track);
+    encoder->setTrackGain(request.trackGain);
+    encoder->setProfile(output.profile);
+    encoder->setEmbeddedCue(output.embeddedCue);
+    encoder->setCoverImage(output.coverImage);
+    encoder->setProgressBoard(mProgressBoard, request.output);
 
     QPointer<WorkerThread> thread = new WorkerThread(encoder, this);
-    thread->setObjectName(QString("%1 encoder track %2").arg(track.disc()->cueFilePath()).arg(track.index()));
+    thread->setObjectName(QString("%1 encoder track %2").arg(request.track.disc()->cueFilePath()).arg(request.track.index()));
 
     connect(this, &DiscPipeline::stopAllThreads, thread, &Conv::WorkerThread::deleteLater);
-    connect(encoder, &Encoder::trackProgress, this, &DiscPipeline::trackProgress);
+    connect(encoder, &Encoder::trackProgress, this, [this, request](int trackId, TrackState state, int) {
+        encoderProgress(request.output, trackId, state);
+    });
     connect(encoder, &Encoder::error, this, &DiscPipeline::trackError);
+    connect(encoder, &Encoder::trackReady, this, [this, request](const Conv::ConvTrack &, const QString &outFileName, const ReplayGain::Result &, bool trackGainWritten) {
+        encoderFinished(request, outFileName, trackGainWritten);
+    });
+
+    connect(thread, &Conv::WorkerThread::finished, this, &DiscPipeline::threadFinished);
+
+    mThreads << thread;
+    thread->start();
+}
+
+/************************************************
+ *
+ ************************************************/
+void DiscPipeline::encoderFinished(const Request &request, const QString &outFileName, bool trackGainWritten)
+{
+    releaseInputFile(request.inputFile);
+    writeJournal(request.output, request.track, Journal::State::Encoded);
+    encoderProgress(request.output, request.track.id(), TrackState::OK);
 
-    // Replaygain ...............................
-    if (mProfile.gainType() != GainType::Disable) {
-        connect(encoder, &Encoder::trackReady, this, &DiscPipeline::writeGain);
+    if (mOutputs.at(request.output).profile.gainType() != GainType::Disable) {
+        writeGain(request.output, request.track, outFileName, request.trackGain, trackGainWritten);
     }
     else {
-        connect(encoder, &Encoder::trackReady, this, &DiscPipeline::trackDone);
+        outputReady(request.output, request.track, outFileName);
     }
-    // ..........................................
+}
 
-    connect(thread, &Conv::WorkerThread::finished, this, &DiscPipeline::threadFinished);
+/************************************************
+ * The split file is shared by several encoders,
+ * the last one removes it.
+ ************************************************/
+void DiscPipeline::releaseInputFile(const QString &inputFile)
+{
+    int &refs = mInputFileRefs[inputFile];
+    if (--refs > 0) {
+        return;
+    }
 
-    mThreads << thread;
-    thread->start();
+    mInputFileRefs.remove(inputFile);
+    QFile::remove(inputFile);
+    ScratchSpace::instance()->release(&mScratch, mScratchFiles.take(inputFile));
 }
 
 /************************************************
  *
  ************************************************/
-void DiscPipeline::writeGain(const ConvTrack &track, const QString &fileName, const ReplayGain::Result &trackGain)
+void DiscPipeline::writeGain(int outputNum, const ConvTrack &track, const QString &fileName, const ReplayGain::Result &trackGain, bool trackGainWritten)
 {
-    qCDebug(LOG) << "Write track gain: " << fileName << "gain:" << trackGain.gain() << "peak:" << track;
+    Output &output = mOutputs[outputNum];
 
-    MetadataWriter *writer = mProfile.outFormat()->createMetadataWriter(fileName);
-    writer->setTrackReplayGain(trackGain.gain(), trackGain.peak());
-    writer->save();
-    delete writer;
+    // The native encoders write the track gain at stream creation
+    if (!trackGainWritten) {
+        qCDebug(LOG) << "Write track gain: " << fileName << "gain:" << trackGain.gain() << "peak:" << track;
 
-    if (mProfile.gainType() != GainType::Album) {
-        trackDone(track, fileName);
+        MetadataWriter *writer = output.profile.outFormat()->createMetadataWriter(fileName);
+        writer->setTrackReplayGain(trackGain.gain(), trackGain.peak());
+        writer->save();
+        delete writer;
+    }
+
+    if (output.profile.gainType() != GainType::Album) {
+        writeJournal(outputNum, track, Journal::State::GainWritten);
+        outputReady(outputNum, track, fileName);
         return;
     }
 
-    mAlbumGain.add(trackGain);
-    trackProgress(track, TrackState::WaitGain, 0);
-    mAlbumGainRequests << Request { track, fileName };
+    output.albumGain.add(trackGain);
+    if (!isEncoding(track.id())) {
+        trackProgress(track.id(), TrackState::WaitGain, 0);
+    }
+    output.albumGainRequests << Request { track, fileName, outputNum, trackGain };
 
-    if (mAlbumGainRequests.count() < mTracks.count()) {
+    if (output.albumGainRequests.count() < mTracks.count()) {
         return;
     }
 
-    for (const Request &r : std::as_const(mAlbumGainRequests)) {
-        qCDebug(LOG) << "Write album gain: " << r.inputFile << "gain:" << mAlbumGain.result().gain() << "peak:" << mAlbumGain.result().peak();
+    const ReplayGain::Result albumGain = output.albumGain.result();
+    const QList<Request>     requests  = output.albumGainRequests;
+
+    for (const Request &r : requests) {
+        qCDebug(LOG) << "Write album gain: " << r.inputFile << "gain:" << albumGain.gain() << "peak:" << albumGain.peak();
 
-        MetadataWriter *writer = mProfile.outFormat()->createMetadataWriter(r.inputFile);
-        writer->setAlbumReplayGain(mAlbumGain.result().gain(), mAlbumGain.result().peak());
+        MetadataWriter *writer = output.profile.outFormat()->createMetadataWriter(r.inputFile);
+        writer->setAlbumReplayGain(albumGain.gain(), albumGain.peak());
         writer->save();
         delete writer;
 
-        trackDone(r.track, r.inputFile);
+        writeJournal(outputNum, r.track, Journal::State::GainWritten);
+        outputReady(outputNum, r.track, r.inputFile);
     }
 }
 
+/************************************************
+ * The encoded file is complete, it's verified
+ * if possible, or goes straight to trackDone.
+ ************************************************/
+void DiscPipeline::outputReady(int output, const ConvTrack &track, const QString &outFileName)
+{
+    if (!mVerifyEnabled || !mPcmChecksums.contains(track.id()) || !Verifier::isVerifiable(mOutputs.at(output).profile, track)) {
+        trackDone(output, track, outFileName);
+        return;
+    }
+
+    mVerifyRequests << VerifyRequest { track, outFileName, output };
+    emit readyStart();
+}
+
 /************************************************
  *
  ************************************************/
-void DiscPipeline::trackDone(const ConvTrack &track, const QString &outFileName)
+void DiscPipeline::startVerifier(const VerifyRequest &request)
 {
+    Verifier *verifier = new Verifier(request.track, request.fileName, mPcmChecksums.value(request.track.id()));
+
+    QPointer<WorkerThread> thread = new WorkerThread(verifier, this);
+    thread->setObjectName(QString("%1 verifier track %2").arg(request.track.disc()->cueFilePath()).arg(request.track.index()));
+
+    connect(this, &DiscPipeline::stopAllThreads, thread, &Conv::WorkerThread::deleteLater);
+    connect(verifier, &Verifier::error, this, &DiscPipeline::trackError);
+    connect(verifier, &Verifier::verifyFailed, this, [this, request](const Conv::ConvTrack &, const QString &, const QString &message) {
+        verifyFailed(request.output, request.track, request.fileName, message);
+    });
+    connect(verifier, &Verifier::trackVerified, this, [this, request]() {
+        trackDone(request.output, request.track, request.fileName);
+    });
+
+    connect(thread, &Conv::WorkerThread::finished, this, &DiscPipeline::threadFinished);
+
+    mThreads << thread;
+    thread->start(QThread::LowestPriority);
+}
+
+/************************************************
+ *
+ ************************************************/
+void DiscPipeline::trackDone(int output, const ConvTrack &track, const QString &outFileName)
+{
+    const Profile &profile = mOutputs.at(output).profile;
+
     qCDebug(LOG) << "Track done: "
                  << "index=" << track.index()
                  << track
+                 << "profile:" << profile.id()
                  << "outFileName:" << outFileName;
 
     // Track is ready, rename the file to the final name.
     // Remove old already existing file.
-    QFile::remove(mProfile.resultFilePath(&track));
+    QFile::remove(profile.resultFilePath(&track));
 
     QFile file(outFileName);
-    if (!file.rename(mProfile.resultFilePath(&track))) {
-        trackError(track, tr("I can't rename file:\n%1 to %2\n%3").arg(outFileName, mProfile.resultFilePath(&track), file.errorString()));
+    if (!file.rename(profile.resultFilePath(&track))) {
+        trackError(track, tr("I can't rename file:\n%1 to %2\n%3").arg(outFileName, profile.resultFilePath(&track), file.errorString()));
+    }
+    else {
+        writeJournal(output, track, Journal::State::Done);
+        Fingerprints::instance()->store(profile, track);
+    }
+
+    outputDone(track);
+}
+
+/************************************************
+ * The result doesn't match the split audio. The
+ * file is removed and the track is failed, the
+ * other tracks go on.
+ ************************************************/
+void DiscPipeline::verifyFailed(int output, const ConvTrack &track, const QString &outFileName, const QString &message)
+{
+    qCWarning(LOG) << "Verification failed: track" << track.index() << "profile:" << mOutputs.at(output).profile.id();
+
+    QFile::remove(outFileName);
+    mFailedTracks << track.id();
+    Messages::error(message);
+
+    outputDone(track);
+}
+
+/************************************************
+ * The track is done when all profiles are done
+ ************************************************/
+void DiscPipeline::outputDone(const ConvTrack &track)
+{
+    if (--mPendingOutputs[track.id()] > 0) {
+        emit threadFinished();
+        return;
     }
 
-    mTrackStates[track.index()] = TrackState::OK;
+    const TrackState state = mFailedTracks.contains(track.id()) ? TrackState::Error : TrackState::OK;
+
+    mPcmChecksums.remove(track.id());
+    mTrackStates[track.index()] = state;
     updateDiskState();
-    emit trackProgressChanged(track, TrackState::OK, 0);
+    emit trackProgressChanged(track, state, 0);
     emit threadFinished();
 
     if (!isRunning()) {
@@ -389,6 +704,16 @@ void DiscPipeline::trackDone(const ConvTrack &track, const QString &outFileName)
     }
 }
 
+/************************************************
+ *
+ ************************************************/
+void DiscPipeline::writeJournal(int output, const ConvTrack &track, Journal::State state)
+{
+    if (mJournal) {
+        mJournal->write(mOutputs.at(output).profile, track, state);
+    }
+}
+
 /************************************************
  *
  ************************************************/
@@ -416,6 +741,8 @@ void DiscPipeline::interrupt(TrackState state)
 {
     mInterrupted = true;
     mEncoderRequests.clear();
+    mVerifyRequests.clear();
+    releaseScratch();
 
     for (ConvTrack &track : mTracks) {
         switch (mTrackStates[track.index()]) {
@@ -511,31 +838,149 @@ int DiscPipeline::runningThreadCount() const
 }
 
 /************************************************
+ *
+ ************************************************/
+int DiscPipeline::runningSplitterCount() const
+{
+    return (mSplitterThread && mSplitterThread->isRunning()) ? 1 : 0;
+}
 
+/************************************************
+ *
  ************************************************/
-void DiscPipeline::trackProgress(const ConvTrack &track, TrackState state, int percent)
+QVector<DeviceId> DiscPipeline::busyDevices() const
+{
+    QVector<DeviceId> res;
+    const int         splitters = runningSplitterCount();
+
+    if (splitters > 0) {
+        res << mSplitterDevices;
+    }
+
+    if (runningThreadCount() > splitters) {
+        for (DeviceId dev : mEncoderDevices) {
+            if (!res.contains(dev)) {
+                res << dev;
+            }
+        }
+    }
+
+    return res;
+}
+
+/************************************************
+
+ ************************************************/
+void DiscPipeline::trackProgress(int trackId, TrackState state, int percent)
 {
     if (mInterrupted)
         return;
 
+    const ConvTrack &track = mTracks.at(trackId);
+
     mTrackStates[track.index()] = state;
+    mTrackPercents[trackId]     = percent;
     updateDiskState();
     emit trackProgressChanged(track, state, percent);
 }
 
+/************************************************
+ * Every output of the track has its own encoder,
+ * the track is shown as encoding until the last
+ * of them is finished.
+ ************************************************/
+void DiscPipeline::encoderProgress(int output, int trackId, TrackState state)
+{
+    auto it = mOutputStates.find(trackId);
+    if (it == mOutputStates.end()) {
+        return;
+    }
+
+    (*it)[output] = state;
+
+    if (isEncoding(trackId)) {
+        trackProgress(trackId, TrackState::Encoding, encodingPercent(trackId));
+    }
+}
+
+/************************************************
+ *
+ ************************************************/
+bool DiscPipeline::isEncoding(int trackId) const
+{
+    for (TrackState state : mOutputStates.value(trackId)) {
+        if (state != TrackState::OK) {
+            return true;
+        }
+    }
+    return false;
+}
+
+/************************************************
+ * The mean of the outputs, the queued ones are 0%
+ * and the encoded ones are 100%.
+ ************************************************/
+int DiscPipeline::encodingPercent(int trackId) const
+{
+    const QVector<TrackState> states = mOutputStates.value(trackId);
+    if (states.isEmpty()) {
+        return 0;
+    }
+
+    int sum = 0;
+    for (int i = 0; i < states.count(); ++i) {
+        switch (states.at(i)) {
+            case TrackState::Encoding:
+                sum += mProgressBoard->percent(trackId, i);
+                break;
+            case TrackState::OK:
+                sum += 100;
+                break;
+            default:
+                break;
+        }
+    }
+
+    return sum / states.count();
+}
+
 /************************************************
  *
  ************************************************/
-void DiscPipeline::copyCoverImage() const
+void DiscPipeline::collectProgress()
 {
-    QString file = mProfile.copyCoverOptions().mode != CoverMode::Disable ? mDisc->coverImageFile() : "";
-    int     size = mProfile.copyCoverOptions().mode == CoverMode::Scale ? mProfile.copyCoverOptions().size : 0;
+    if (mInterrupted) {
+        return;
+    }
+
+    for (const ConvTrack &track : std::as_const(mTracks)) {
+        const TrackState state = mTrackStates.value(track.index());
+        if (state != TrackState::Splitting && state != TrackState::Encoding) {
+            continue;
+        }
+
+        const int percent = state == TrackState::Splitting ? mProgressBoard->percent(track.id(), 0) : encodingPercent(track.id());
+        int      &prev    = mTrackPercents[track.id()];
+        if (percent != prev) {
+            prev = percent;
+            emit trackProgressChanged(track, state, percent);
+        }
+    }
+}
+
+/************************************************
+ *
+ ************************************************/
+void DiscPipeline::copyCoverImage(const Profile &profile) const
+{
+    QString file = profile.copyCoverOptions().mode != CoverMode::Disable ? mDisc->coverImageFile() : "";
+    int     size = profile.copyCoverOptions().mode == CoverMode::Scale ? profile.copyCoverOptions().size : 0;
 
     if (file.isEmpty()) {
         return;
     }
 
-    QString dir  = QFileInfo(mProfile.resultFilePath(&mTracks.first())).dir().absolutePath();
+    QString dir  = QFileInfo(profile.resultFilePath(&mTracks.first())).dir().absolutePath();
     QString dest = QDir(dir).absoluteFilePath(QString("cover.%1").arg(QFileInfo(file).suffix()));
 
     CoverImage image = CoverImage(file, size);
@@ -545,47 +990,122 @@ void DiscPipeline::copyCoverImage() const
 /************************************************
  *
  ************************************************/
-void DiscPipeline::createEmbedImage()
+void DiscPipeline::createEmbedImage(Output *output)
 {
-    QString file = mProfile.embedCoverOptions().mode != CoverMode::Disable ? mDisc->coverImageFile() : "";
-    int     size = mProfile.embedCoverOptions().mode == CoverMode::Scale ? mProfile.embedCoverOptions().size : 0;
+    const Profile &profile = output->profile;
+
+    QString file = profile.embedCoverOptions().mode != CoverMode::Disable ? mDisc->coverImageFile() : "";
+    int     size = profile.embedCoverOptions().mode == CoverMode::Scale ? profile.embedCoverOptions().size : 0;
 
     if (file.isEmpty()) {
         return;
     }
 
-    mCoverImage = CoverImage(file, size);
+    output->coverImage = CoverImage(file, size);
 
-    QString tmpCoverFile = QDir(mTmpDir->path()).absoluteFilePath(QString("cover.%1").arg(QFileInfo(file).suffix()));
-    mCoverImage.saveTmpFile(tmpCoverFile);
+    int     num          = int(output - mOutputs.data());
+    QString tmpCoverFile = QDir(mTmpDir->path()).absoluteFilePath(QString("cover-%1.%2").arg(num).arg(QFileInfo(file).suffix()));
+    output->coverImage.saveTmpFile(tmpCoverFile);
 }
 
 /************************************************
  *
  ************************************************/
-void DiscPipeline::writeOutCueFile()
+void DiscPipeline::writeOutCueFile(const Profile &profile)
 {
-    if (!mProfile.isCreateCue()) {
+    if (!profile.isCreateCue()) {
         return;
     }
 
-    CueCreator cue(mProfile, mDisc, mPregapType);
-    cue.writeToFile(mProfile.cueFileName());
+    CueCreator cue(profile, mDisc, mPregapType);
+    cue.writeToFile(profile.cueFileName());
+}
+
+/************************************************
+ * The report is placed next to the CUE file
+ * the profile creates, with the .crc suffix.
+ ************************************************/
+void DiscPipeline::writeCrcReport(const Profile &profile) const
+{
+    QString fileName = CueCreator(profile, mDisc, mPregapType).filePath(profile.cueFileName());
+    fileName         = fileName.left(fileName.length() - 4) + ".crc";
+
+    // A resumed or incremental run splits only a part of the disc,
+    // the CRCs of the other tracks are kept from the previous report.
+    QMap<int, TrackCrc> crcs;
+    bool                hasDiscCrc = false;
+    quint32             discCrc    = 0;
+
+    QFile file(fileName);
+    if (file.open(QFile::ReadOnly | QFile::Text)) {
+        const QRegularExpression trackRe("^\\s*(\\d+)\\s+([0-9A-F]{8})\\s+([0-9A-F]{8})\\s+([0-9A-F]{8})\\s*$");
+        const QRegularExpression discRe("^CTDB CRC:\\s*([0-9A-F]{8})\\s*$");
+
+        QTextStream in(&file);
+        while (!in.atEnd()) {
+            const QString line = in.readLine();
+
+            QRegularExpressionMatch m = trackRe.match(line);
+            if (m.hasMatch()) {
+                TrackCrc crc { m.captured(1).toInt(), m.captured(2).toUInt(nullptr, 16), m.captured(3).toUInt(nullptr, 16), m.captured(4).toUInt(nullptr, 16) };
+                crcs[crc.trackNum] = crc;
+                continue;
+            }
+
+            m = discRe.match(line);
+            if (m.hasMatch()) {
+                hasDiscCrc = true;
+                discCrc    = m.captured(1).toUInt(nullptr, 16);
+            }
+        }
+        file.close();
+    }
+
+    for (const TrackCrc &crc : mTrackCrcs) {
+        crcs[crc.trackNum] = crc;
+    }
+
+    if (mHasDiscCrc) {
+        hasDiscCrc = true;
+        discCrc    = mDiscCrc;
+    }
+
+    if (!file.open(QFile::WriteOnly | QFile::Truncate | QFile::Text)) {
+        qCWarning(LOG) << "Can't write CRC report" << fileName << file.errorString();
+        return;
+    }
+
+    auto toHex = [](quint32 value, int width) {
+        return QString::number(value, 16).toUpper().rightJustified(8, '0').rightJustified(width);
+    };
+
+    QTextStream out(&file);
+    out << "Track  AccurateRip v1  AccurateRip v2     CRC32\n";
+    for (const TrackCrc &crc : std::as_const(crcs)) {
+        out << QString::number(crc.trackNum).rightJustified(2, '0').rightJustified(5) << "  "
+            << toHex(crc.accurateRipV1, 14) << "  "
+            << toHex(crc.accurateRipV2, 14) << "  "
+            << toHex(crc.crc32, 8) << "\n";
+    }
+
+    if (hasDiscCrc) {
+        out << "\nCTDB CRC: " << toHex(discCrc, 8) << "\n";
+    }
 }
 
 /************************************************
  *
  ************************************************/
-void DiscPipeline::loadEmbeddedCue()
+void DiscPipeline::loadEmbeddedCue(Output *output)
 {
-    if (!mProfile.isEmbedCue()) {
+    if (!output->profile.isEmbedCue()) {
         return;
     }
 
-    CueCreator cue(mProfile, mDisc, mPregapType);
+    CueCreator cue(output->profile, mDisc, mPregapType);
     QBuffer    buf;
     cue.write(&buf);
-    mEmbeddedCue = QString::fromUtf8(buf.data());
+    output->embeddedCue = QString::fromUtf8(buf.data());
 }
 
 /************************************************
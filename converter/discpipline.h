@@ -28,12 +28,16 @@
 
 #include <QObject>
 #include <QTemporaryDir>
+#include <QSet>
 #include "track.h"
 #include "converter.h"
 #include "convertertypes.h"
 #include "profiles.h"
 #include "coverimage.h"
 #include "replaygain.h"
+#include "scratchspace.h"
+#include "journal.h"
+#include "worker.h"
 
 class Project;
 
@@ -45,41 +49,61 @@ class DiscPipeline : public QObject
 {
     Q_OBJECT
 public:
-    explicit DiscPipeline(const Profile &profile, Disc *disc, const QVector<const Track *> &reqTracks, QObject *parent = nullptr) noexcept(false);
+    explicit DiscPipeline(const Profiles &profiles, Disc *disc, const QVector<const Track *> &reqTracks, QObject *parent = nullptr) noexcept(false);
     virtual ~DiscPipeline();
 
     QList<ConvTrack> tracks() const { return mTracks; }
 
-    void startWorker(int *splitterCount, int *count);
+    /// The encoders and verifiers aren't started if their devices are used by another disc.
+    void startWorker(int *splitterCount, int *count, bool encoderDevicesFree = true);
     void stop();
     bool isRunning() const;
     int  runningThreadCount() const;
+    int  runningSplitterCount() const;
+
+    /// Emits trackProgressChanged for the running tracks whose percent has changed.
+    void collectProgress();
+
+    /// Track state transitions are recorded to the journal, if it is set.
+    void setJournal(Journal *journal) { mJournal = journal; }
+
+    /// The lossless results are decoded back and compared with the split audio.
+    bool isVerifyEnabled() const { return mVerifyEnabled; }
+    void setVerifyEnabled(bool value) { mVerifyEnabled = value; }
+
+    /// The AccurateRip and CTDB CRCs are written to a report next to the CUE file.
+    bool isAccurateRipEnabled() const { return mAccurateRipEnabled; }
+    void setAccurateRipEnabled(bool value) { mAccurateRipEnabled = value; }
+
+    /// The device the splitter reads the source audio from.
+    DeviceId sourceDevice() const { return mSourceDevice; }
+
+    /// The rotational and network devices of the source audio and the temporary directory.
+    QVector<DeviceId> splitterDevices() const { return mSplitterDevices; }
+
+    /// The rotational and network devices the encoders write and the verifiers read the results.
+    QVector<DeviceId> encoderDevices() const { return mEncoderDevices; }
+
+    /// The devices of the running splitter, encoders and verifiers.
+    QVector<DeviceId> busyDevices() const;
 
 signals:
     void readyStart();
     void threadFinished();
     void finished();
     void stopAllThreads();
+    void sourceRead(DeviceId device, qint64 bytes, qint64 elapsedMs);
     void trackProgressChanged(const Conv::ConvTrack &track, TrackState status, Percent percent);
 
 private slots:
-    void trackProgress(const Conv::ConvTrack &track, TrackState state, int percent);
+    void trackProgress(int trackId, TrackState state, int percent);
+    void encoderProgress(int output, int trackId, TrackState state);
     void trackError(const Conv::ConvTrack &track, const QString &message);
 
-    void trackDone(const Conv::ConvTrack &track, const QString &outFileName);
+    void addEncoderRequests(const Conv::ConvTrack &track, const QString &inputFile, const ReplayGain::Result &trackGain, const QByteArray &pcmChecksum);
+    void addTrackCrc(const Conv::ConvTrack &track, quint32 accurateRipV1, quint32 accurateRipV2, quint32 crc32);
 
 private:
-    Profile               mProfile;
-    Disc                 *mDisc = nullptr;
-    QString               mWorkDir;
-    QList<ConvTrack>      mTracks;
-    QMap<int, TrackState> mTrackStates;
-    QTemporaryDir        *mTmpDir = nullptr;
-    CoverImage            mCoverImage;
-    QString               mEmbeddedCue;
-    ReplayGain::AlbumGain mAlbumGain;
-    PreGapType            mPregapType = PreGapType::Skip;
-
     struct SplitterRequest
     {
         ConvTracks tracks;
@@ -88,34 +112,112 @@ private:
     };
 
     struct Request
+    {
+        ConvTrack          track;
+        QString            inputFile;
+        int                output = 0;
+        ReplayGain::Result trackGain;
+    };
+
+    struct TrackCrc
+    {
+        int     trackNum      = 0;
+        quint32 accurateRipV1 = 0;
+        quint32 accurateRipV2 = 0;
+        quint32 crc32         = 0;
+    };
+
+    struct VerifyRequest
     {
         ConvTrack track;
-        QString   inputFile;
+        QString   fileName;
+        int       output = 0;
+    };
+
+    // The split tracks are encoded once for every profile
+    struct Output
+    {
+        Profile               profile;
+        CoverImage            coverImage;
+        QString               embeddedCue;
+        ReplayGain::AlbumGain albumGain;
+        QList<Request>        albumGainRequests;
     };
 
+    QVector<Output>       mOutputs;
+    Journal              *mJournal = nullptr;
+    Disc                 *mDisc = nullptr;
+    QString               mWorkDir;
+    QList<ConvTrack>      mTracks;
+    QMap<int, TrackState> mTrackStates;
+    QMap<int, int>        mTrackPercents;
+    QMap<int, int>        mPendingOutputs;
+    QSet<int>             mFailedTracks;
+
+    // The encoding state of every output of the track: Queued, Encoding or OK
+    QMap<int, QVector<TrackState>> mOutputStates;
+    QMap<QString, int>    mInputFileRefs;
+    QTemporaryDir        *mTmpDir = nullptr;
+    PreGapType            mPregapType = PreGapType::Skip;
+
+    QSharedPointer<ProgressBoard>   mProgressBoard;
     QVector<QPointer<WorkerThread>> mThreads;
+    QPointer<WorkerThread>          mSplitterThread;
+    DeviceId                        mSourceDevice = 0;
+    QVector<DeviceId>               mSplitterDevices;
+    QVector<DeviceId>               mEncoderDevices;
+
+    ScratchSpace::Reservation mScratch;
+    QTemporaryDir            *mMemoryTmpDir = nullptr;
+    QMap<QString, qint64>     mScratchFiles;
     bool                            mInterrupted = false;
     QList<SplitterRequest>          mSplitterRequests;
     QList<Request>                  mEncoderRequests;
-    QList<Request>                  mAlbumGainRequests;
+
+    bool                  mVerifyEnabled = false;
+    QMap<int, QByteArray> mPcmChecksums;
+    QList<VerifyRequest>  mVerifyRequests;
+
+    bool                mAccurateRipEnabled = false;
+    QMap<int, TrackCrc> mTrackCrcs;
+    quint32             mDiscCrc    = 0;
+    bool                mHasDiscCrc = false;
+
+    const Profile &mainProfile() const { return mOutputs.first().profile; }
+    bool           isGainEnabled() const;
 
     void addSpliterRequest();
+    bool reserveScratch(SplitterRequest *request);
+    void releaseScratch();
     void startSplitter(const SplitterRequest &request);
+    void splitterFinished(const SplitterRequest &request, qint64 elapsedMs);
 
-    void addEncoderRequest(const Conv::ConvTrack &track, const QString &inputFile);
-    void startEncoder(const ConvTrack &track, const QString &inputFile);
+    void startEncoder(const Request &request);
+    void encoderFinished(const Request &request, const QString &outFileName, bool trackGainWritten);
+    void releaseInputFile(const QString &inputFile);
 
-    void writeGain(const Conv::ConvTrack &track, const QString &fileName, const ReplayGain::Result &trackGain);
+    void writeGain(int output, const Conv::ConvTrack &track, const QString &fileName, const ReplayGain::Result &trackGain, bool trackGainWritten);
+    void outputReady(int output, const Conv::ConvTrack &track, const QString &outFileName);
+    void startVerifier(const VerifyRequest &request);
+    void trackDone(int output, const Conv::ConvTrack &track, const QString &outFileName);
+    void verifyFailed(int output, const Conv::ConvTrack &track, const QString &outFileName, const QString &message);
+    void outputDone(const Conv::ConvTrack &track);
+
+    void writeJournal(int output, const Conv::ConvTrack &track, Journal::State state);
 
     void interrupt(TrackState state);
 
     void createDir(const QString &dirName) const;
 
-    void copyCoverImage() const;
-    void createEmbedImage();
+    void copyCoverImage(const Profile &profile) const;
+    void createEmbedImage(Output *output);
+
+    void writeOutCueFile(const Profile &profile);
+    void writeCrcReport(const Profile &profile) const;
+    void loadEmbeddedCue(Output *output);
 
-    void writeOutCueFile();
-    void loadEmbeddedCue();
+    bool isEncoding(int trackId) const;
+    int  encodingPercent(int trackId) const;
 
     bool hasPregap() const;
     void updateDiskState();
@@ -31,7 +31,10 @@
 #include <QDebug>
 #include <QLoggingCategory>
 #include "extprocess.h"
+#include "wavheader.h"
 #include "formats_out/metadatawriter.h"
+#include "formats_out/nativeencoder.h"
+#include <memory>
 
 namespace {
 Q_LOGGING_CATEGORY(LOG, "Encoder")
@@ -79,7 +82,7 @@ QProcess *Encoder::createEncoderProcess()
 /************************************************
  *
  ************************************************/
-QProcess *Encoder::createRasmpler(const QString &outFile)
+QProcess *Encoder::createRasmpler(const QString &outFile, const QString &inType, const QString &outType)
 {
     const InputAudioFile &audio = mTrack.audioFile();
 
@@ -89,13 +92,13 @@ QProcess *Encoder::createRasmpler(const QString &outFile)
     qCDebug(LOG) << "Input audio: bitsPerSample =" << audio.bitsPerSample() << " sampleRate =" << audio.sampleRate();
     qCDebug(LOG) << "Required:    bitsPerSample =" << bps << " sampleRate =" << rate;
 
-    if (bps == audio.bitsPerSample() && rate == audio.sampleRate()) {
+    if (mPreprocessed || (bps == audio.bitsPerSample() && rate == audio.sampleRate())) {
         qCDebug(LOG) << "Resampling is not required";
         return nullptr;
     }
 
     ExtProgram *prog = ExtProgram::sox();
-    QStringList args = resamplerArgs(bps, rate, outFile);
+    QStringList args = resamplerArgs(bps, rate, inType, outFile, outType);
 
     qCDebug(LOG) << "Start resampler:" << debugProgramArgs(prog->path(), args);
 
@@ -109,9 +112,9 @@ QProcess *Encoder::createRasmpler(const QString &outFile)
 /************************************************
 
 ************************************************/
-QProcess *Encoder::createDemph(const QString &outFile)
+QProcess *Encoder::createDemph(const QString &outFile, const QString &outType)
 {
-    if (!mTrack.preEmphased()) {
+    if (mPreprocessed || !mTrack.preEmphased()) {
         qCDebug(LOG) << "DeEmphasis is not required";
         return nullptr;
     }
@@ -124,7 +127,7 @@ QProcess *Encoder::createDemph(const QString &outFile)
     }
 
     ExtProgram *prog = ExtProgram::sox();
-    QStringList args = deemphasisArgs(outFile);
+    QStringList args = deemphasisArgs(outFile, outType);
 
     qCDebug(LOG) << "Start deEmphasis:" << debugProgramArgs(prog->path(), args);
 
@@ -140,9 +143,26 @@ QProcess *Encoder::createDemph(const QString &outFile)
  ************************************************/
 void Encoder::run()
 {
-    mReplayGainEnabled = mProfile.gainType() != GainType::Disable;
+    startProgress(track().id(), TrackState::Encoding);
 
-    emit trackProgress(track(), TrackState::Encoding, 0);
+    std::unique_ptr<NativeEncoder> native(createNativeEncoder());
+    if (native) {
+        runNativeEncoder(native.get());
+        return;
+    }
+
+    // sox writes the 32-bit WAV sizes, so the long pre-processed audio goes
+    // to a Wave64 file first. Then it's encoded like a split track.
+    if (isWave64Required()) {
+        try {
+            preprocessToWave64();
+        }
+        catch (const FlaconError &err) {
+            QString msg = tr("Track %1. Encoder error:", "Track error message, %1 is a track number").arg(track().trackNum()) + "<pre>" + err.what() + "</pre>";
+            emit    error(track(), msg);
+            return;
+        }
+    }
 
     QList<QProcess *> procs;
 
@@ -151,13 +171,13 @@ void Encoder::run()
         procs.insert(0, encoder);
     }
 
-    QProcess *resampler = createRasmpler(procs.isEmpty() ? mOutFile : "-");
+    QProcess *resampler = createRasmpler(procs.isEmpty() ? mOutFile : "-", "wav", "wav");
     if (resampler) {
 
         procs.insert(0, resampler);
     }
 
-    QProcess *demph = createDemph(procs.isEmpty() ? mOutFile : "-");
+    QProcess *demph = createDemph(procs.isEmpty() ? mOutFile : "-", "wav");
     if (demph) {
         procs.insert(0, demph);
     }
@@ -168,8 +188,8 @@ void Encoder::run()
         // so just rename/copy the file.
         qCDebug(LOG) << "Copy file: in = " << inputFile() << "out = " << outFile();
         copyFile();
-        emit trackProgress(track(), TrackState::Encoding, 100);
-        emit trackReady(track(), outFile(), ReplayGain::Result());
+        setProgress(track().id(), TrackState::Encoding, 100);
+        emit trackReady(track(), outFile(), mTrackGain, false);
         return;
     }
 
@@ -181,42 +201,102 @@ void Encoder::run()
             proc->setParent(&keeper);
         }
 
-        // We start all processes connected by a pipe
-        for (int i = 0; i < procs.count() - 1; ++i) {
-            QProcess *proc = procs[i];
-            proc->setStandardOutputProcess(procs[i + 1]);
-        }
+        // sox reads RF64, so only the encoder may need the legacy header
+        runPipe(procs, procs.first() != encoder || mProfile.outFormat()->options().testFlag(FormatOption::SupportRf64));
 
-        connect(procs.first(), &QProcess::bytesWritten, this, &Encoder::processBytesWritten);
+        if (!mKeepInputFile) {
+            deleteFile(mInputFile);
+        }
+        writeMetadata();
 
-        for (QProcess *proc : procs) {
-            proc->start();
-            proc->waitForStarted();
+        emit trackReady(track(), outFile(), mTrackGain, false);
+    }
+    catch (const FlaconError &err) {
+        if (!mKeepInputFile) {
+            deleteFile(mInputFile);
         }
+        QString msg = tr("Track %1. Encoder error:", "Track error message, %1 is a track number").arg(track().trackNum()) + "<pre>" + err.what() + "</pre>";
+        emit    error(track(), msg);
+    }
+}
 
-        readInputFile(procs.first());
+/************************************************
+ * The processes are connected by pipes, the first
+ * one reads the input file.
+ ************************************************/
+void Encoder::runPipe(const QList<QProcess *> &procs, bool supportRf64)
+{
+    for (int i = 0; i < procs.count() - 1; ++i) {
+        QProcess *proc = procs[i];
+        proc->setStandardOutputProcess(procs[i + 1]);
+    }
 
-        for (QProcess *p : procs) {
-            p->closeWriteChannel();
-            p->waitForFinished(-1);
-        }
+    connect(procs.first(), &QProcess::bytesWritten, this, &Encoder::processBytesWritten);
 
-        for (QProcess *p : procs) {
-            if (p->exitCode() != 0) {
-                throw(QString::fromLocal8Bit(p->readAllStandardError()));
-            }
+    for (QProcess *proc : procs) {
+        proc->start();
+        proc->waitForStarted();
+    }
+
+    readInputFile(procs.first(), supportRf64);
+
+    for (QProcess *p : procs) {
+        p->closeWriteChannel();
+        p->waitForFinished(-1);
+    }
+
+    for (QProcess *p : procs) {
+        if (p->exitCode() != 0) {
+            throw FlaconError(QString::fromLocal8Bit(p->readAllStandardError()));
         }
+    }
+}
 
-        deleteFile(mInputFile);
-        writeMetadata();
+/************************************************
+ * The de-emphasis and the resampler write Wave64,
+ * the result replaces the input file.
+ ************************************************/
+void Encoder::preprocessToWave64()
+{
+    const QString outFile = mOutFile + ".w64";
+    qCDebug(LOG) << "Pre-process to Wave64:" << outFile;
 
-        emit trackReady(track(), outFile(), mTrackGain.result());
+    QObject           keeper(this);
+    QList<QProcess *> procs;
+
+    QProcess *resampler = createRasmpler(outFile, isDeemphasisRequired() ? "w64" : "wav", "w64");
+    if (resampler) {
+        procs.insert(0, resampler);
     }
-    catch (const FlaconError &err) {
+
+    QProcess *demph = createDemph(procs.isEmpty() ? outFile : "-", "w64");
+    if (demph) {
+        procs.insert(0, demph);
+    }
+
+    if (procs.isEmpty()) {
+        return;
+    }
+
+    for (QProcess *proc : std::as_const(procs)) {
+        proc->setParent(&keeper);
+    }
+
+    try {
+        runPipe(procs, true);
+    }
+    catch (const FlaconError &) {
+        deleteFile(outFile);
+        throw;
+    }
+
+    if (!mKeepInputFile) {
         deleteFile(mInputFile);
-        QString msg = tr("Track %1. Encoder error:", "Track error message, %1 is a track number").arg(track().trackNum()) + "<pre>" + err.what() + "</pre>";
-        emit    error(track(), msg);
     }
+
+    mInputFile     = outFile;
+    mKeepInputFile = false;
+    mPreprocessed  = true;
 }
 
 /************************************************
@@ -229,6 +309,16 @@ void Encoder::writeMetadata() const
         return;
     }
 
+    setMetadata(writer);
+    writer->save();
+    delete writer;
+}
+
+/************************************************
+ *
+ ************************************************/
+void Encoder::setMetadata(MetadataWriter *writer) const
+{
     writer->setTags(mTrack);
     if (profile().isEmbedCue()) {
         writer->setEmbeddedCue(embeddedCue());
@@ -237,9 +327,169 @@ void Encoder::writeMetadata() const
     if (!coverImage().isEmpty()) {
         writer->setCoverImage(coverImage());
     }
+}
 
-    writer->save();
-    delete writer;
+/************************************************
+ *
+ ************************************************/
+bool Encoder::isResampleRequired() const
+{
+    const InputAudioFile &audio = mTrack.audioFile();
+
+    int bps  = calcQuality(audio.bitsPerSample(), mProfile.bitsPerSample(), mProfile.outFormat()->maxBitPerSample());
+    int rate = calcQuality(audio.sampleRate(), mProfile.sampleRate(), mProfile.outFormat()->maxSampleRate());
+
+    return bps != audio.bitsPerSample() || rate != audio.sampleRate();
+}
+
+/************************************************
+ * The estimate has some room for the resampler
+ * rounding, the WAV header must fit in 4 GiB too.
+ ************************************************/
+bool Encoder::isWave64Required(quint64 dataSize, int sampleRate, int bitsPerSample, int outSampleRate, int outBitsPerSample)
+{
+    static constexpr quint64 MAX_WAV_DATA_SIZE = 0xFFFFFFFFull - 1024 * 1024;
+
+    double ratio = 1.0;
+    if (sampleRate > 0 && outSampleRate > 0) {
+        ratio *= double(outSampleRate) / sampleRate;
+    }
+
+    if (bitsPerSample > 0 && outBitsPerSample > 0) {
+        ratio *= double(outBitsPerSample) / bitsPerSample;
+    }
+
+    return dataSize * ratio > double(MAX_WAV_DATA_SIZE);
+}
+
+/************************************************
+ *
+ ************************************************/
+bool Encoder::isWave64Required() const
+{
+    if (mPreprocessed || (!isResampleRequired() && !isDeemphasisRequired())) {
+        return false;
+    }
+
+    QFile file(inputFile());
+    if (!file.open(QFile::ReadOnly)) {
+        return false;
+    }
+
+    try {
+        const WavHeader wav(&file);
+        const int       bps  = calcQuality(wav.bitsPerSample(), mProfile.bitsPerSample(), mProfile.outFormat()->maxBitPerSample());
+        const int       rate = calcQuality(wav.sampleRate(), mProfile.sampleRate(), mProfile.outFormat()->maxSampleRate());
+
+        return isWave64Required(wav.dataSize(), wav.sampleRate(), wav.bitsPerSample(), rate, bps);
+    }
+    catch (const FlaconError &) {
+        // readInputFile reports the error
+        return false;
+    }
+}
+
+/************************************************
+ * Same conditions as in createDemph
+ ************************************************/
+bool Encoder::isDeemphasisRequired() const
+{
+    int rate = mTrack.audioFile().sampleRate();
+    return mTrack.preEmphased() && (rate == 44100 || rate == 48000);
+}
+
+/************************************************
+ * The in-process encoder is used if the format
+ * has one, the sox preprocessing isn't needed and
+ * the encoder supports the input stream.
+ ************************************************/
+NativeEncoder *Encoder::createNativeEncoder() const
+{
+    if (isDeemphasisRequired()) {
+        return nullptr;
+    }
+
+    std::unique_ptr<NativeEncoder> res(mProfile.outFormat()->createNativeEncoder(mProfile, mOutFile));
+    if (!res) {
+        return nullptr;
+    }
+
+    if (!res->isResampling() && isResampleRequired()) {
+        return nullptr;
+    }
+
+    QFile file(inputFile());
+    if (file.open(QFile::ReadOnly)) {
+        try {
+            if (!res->isSupported(WavHeader(&file))) {
+                return nullptr;
+            }
+        }
+        catch (const FlaconError &) {
+            // runNativeEncoder reports the error
+        }
+    }
+
+    return res.release();
+}
+
+/************************************************
+ * The tags and the track gain are written at
+ * stream creation, so there are no rewrites of
+ * the encoded file.
+ ************************************************/
+void Encoder::runNativeEncoder(NativeEncoder *encoder)
+{
+    qCDebug(LOG) << "Start native encoder: in =" << inputFile() << "out =" << outFile();
+
+    const bool writeGain = mProfile.gainType() != GainType::Disable;
+    try {
+        QFile file(inputFile());
+        if (!file.open(QFile::ReadOnly)) {
+            throw FlaconError(tr("I can't read %1 file", "Encoder error. %1 is a file name.").arg(inputFile()));
+        }
+
+        WavHeader wav(&file);
+
+        setMetadata(encoder);
+        if (writeGain) {
+            encoder->setTrackReplayGain(mTrackGain.gain(), mTrackGain.peak());
+        }
+
+        encoder->open(wav);
+
+        mProgress = -1;
+        mReady    = 0;
+        mTotal    = wav.dataSize();
+
+        const quint64 blockAlign = qMax<quint64>(wav.blockAlign(), 1);
+        const quint64 bufSize    = qBound(MIN_BUF_SIZE, mTotal / 200, MAX_BUF_SIZE) / blockAlign * blockAlign;
+
+        while (mReady < mTotal) {
+            QByteArray buf = file.read(qMin(bufSize, mTotal - mReady));
+            if (buf.isEmpty()) {
+                throw FlaconError(file.errorString());
+            }
+
+            encoder->write(buf.constData(), buf.size());
+            processBytesWritten(buf.size());
+        }
+
+        encoder->save();
+
+        if (!mKeepInputFile) {
+            deleteFile(mInputFile);
+        }
+
+        emit trackReady(track(), outFile(), mTrackGain, writeGain);
+    }
+    catch (const FlaconError &err) {
+        if (!mKeepInputFile) {
+            deleteFile(mInputFile);
+        }
+        QString msg = tr("Track %1. Encoder error:", "Track error message, %1 is a track number").arg(track().trackNum()) + "<pre>" + err.what() + "</pre>";
+        emit    error(track(), msg);
+    }
 }
 
 /************************************************
@@ -251,7 +501,7 @@ void Encoder::processBytesWritten(qint64 bytes)
     int p = ((mReady * 100.0) / mTotal);
     if (p != mProgress) {
         mProgress = p;
-        emit trackProgress(track(), TrackState::Encoding, mProgress);
+        setProgress(track().id(), TrackState::Encoding, mProgress);
     }
 }
 
@@ -272,9 +522,29 @@ void Encoder::setCoverImage(const CoverImage &value)
 }
 
 /************************************************
+ * The tracks longer than 4 GiB are RF64 files, the
+ * long pre-processed tracks are Wave64 files.
+ * If the program can't read RF64, it gets the WAV
+ * header with unknown sizes and reads the data
+ * to the end of the stream.
+ ************************************************/
+QByteArray Encoder::programInputHeader(const WavHeader &wav, bool supportRf64)
+{
+    if (wav.is64Bit()) {
+        return supportRf64 ? wav.toWav() : wav.toUnsizedWav();
+    }
+
+    if (wav.isRf64() && !supportRf64) {
+        return wav.toUnsizedWav();
+    }
 
+    return QByteArray();
+}
+
+/************************************************
+ *
  ************************************************/
-void Encoder::readInputFile(QProcess *process)
+void Encoder::readInputFile(QIODevice *out, bool supportRf64)
 {
     qCDebug(LOG) << "Read " << inputFile() << "file";
     QFile file(inputFile());
@@ -285,15 +555,21 @@ void Encoder::readInputFile(QProcess *process)
     mProgress = -1;
     mTotal    = file.size();
 
+    const QByteArray header = programInputHeader(WavHeader(&file), supportRf64);
+    if (!header.isEmpty()) {
+        qCDebug(LOG) << "Send the" << header.left(4) << "header instead of the file one";
+        out->write(header);
+    }
+    else {
+        file.seek(0);
+    }
+
     quint64    bufSize = qBound(MIN_BUF_SIZE, mTotal / 200, MAX_BUF_SIZE);
     QByteArray buf;
 
     while (!file.atEnd()) {
         buf = file.read(bufSize);
-        process->write(buf);
-        if (mReplayGainEnabled) {
-            mTrackGain.add(buf.constData(), buf.size());
-        }
+        out->write(buf);
     }
 }
 
@@ -302,8 +578,27 @@ void Encoder::readInputFile(QProcess *process)
  ************************************************/
 void Encoder::copyFile()
 {
+    // The Wave64 file gets the WAV or RF64 header
+    if (mPreprocessed) {
+        QFile out(outFile());
+        if (!out.open(QFile::WriteOnly | QFile::Truncate)) {
+            emit error(track(), tr("I can't write %1 file", "Encoder error. %1 is a file name.").arg(outFile()));
+            return;
+        }
+
+        try {
+            readInputFile(&out, true);
+        }
+        catch (const FlaconError &err) {
+            emit error(track(), err.what());
+        }
+        out.close();
+        deleteFile(mInputFile);
+        return;
+    }
+
     QFile srcFile(inputFile());
-    bool  res = srcFile.rename(outFile());
+    bool  res = mKeepInputFile ? srcFile.copy(outFile()) : srcFile.rename(outFile());
 
     if (!res) {
         emit error(track(),
@@ -314,12 +609,12 @@ void Encoder::copyFile()
 /************************************************
 
  ************************************************/
-QStringList Encoder::resamplerArgs(int bitsPerSample, int sampleRate, const QString &outFile)
+QStringList Encoder::resamplerArgs(int bitsPerSample, int sampleRate, const QString &inType, const QString &outFile, const QString &outType)
 {
     QStringList args;
 
     args << "--type"
-         << "wav";
+         << inType;
 
     args << "-"; // Read from STDIN
     if (bitsPerSample) {
@@ -327,7 +622,7 @@ QStringList Encoder::resamplerArgs(int bitsPerSample, int sampleRate, const QStr
     }
 
     args << "--type"
-         << "wav";
+         << outType;
     args << outFile;
 
     if (sampleRate) {
@@ -342,13 +637,13 @@ QStringList Encoder::resamplerArgs(int bitsPerSample, int sampleRate, const QStr
 /************************************************
 
  ************************************************/
-QStringList Encoder::deemphasisArgs(const QString &outFile)
+QStringList Encoder::deemphasisArgs(const QString &outFile, const QString &outType)
 {
     QStringList args;
 
     // clang-format off
     args << "--type" << "wav" << "-"; // Read from STDIN
-    args << "--type" << "wav" << outFile;
+    args << "--type" << outType << outFile;
     args << "deemph";
     // clang-format on
 
@@ -33,8 +33,13 @@
 #include "coverimage.h"
 #include "replaygain.h"
 
+class MetadataWriter;
+class NativeEncoder;
+
 namespace Conv {
 
+class WavHeader;
+
 class Encoder : public Worker
 {
     Q_OBJECT
@@ -55,14 +60,28 @@ public:
     void setOutFile(const QString &value) { mOutFile = value; }
     void setEmbeddedCue(const QString &value) { mEmbeddedCue = value; }
 
+    /// The input file is shared with other encoders, so it is not removed or moved.
+    bool isKeepInputFile() const { return mKeepInputFile; }
+    void setKeepInputFile(bool value) { mKeepInputFile = value; }
+
+    /// The gain is calculated by the splitter, the encoder just passes it on.
+    const ReplayGain::Result &trackGain() const { return mTrackGain; }
+    void                      setTrackGain(const ReplayGain::Result &value) { mTrackGain = value; }
+
     const CoverImage &coverImage() const { return mCoverImage; }
     void              setCoverImage(const CoverImage &value);
 
+    /// sox writes 32-bit WAV sizes, the pre-processed audio that can exceed them is written as Wave64.
+    static bool isWave64Required(quint64 dataSize, int sampleRate, int bitsPerSample, int outSampleRate, int outBitsPerSample);
+
+    /// The header the program gets instead of the header of the input file, empty if the file is passed as is.
+    static QByteArray programInputHeader(const WavHeader &wav, bool supportRf64);
+
 public slots:
     void run() override;
 
 signals:
-    void trackReady(const Conv::ConvTrack &track, const QString &outFileName, const ReplayGain::Result &trackGain);
+    void trackReady(const Conv::ConvTrack &track, const QString &outFileName, const ReplayGain::Result &trackGain, bool trackGainWritten);
 
 private slots:
     void processBytesWritten(qint64 bytes);
@@ -73,26 +92,37 @@ private:
     QString   mInputFile;
     QString   mOutFile;
     QString   mEmbeddedCue;
+    bool      mKeepInputFile = false;
+    bool      mPreprocessed  = false;
 
     CoverImage mCoverImage;
 
-    bool                  mReplayGainEnabled = false;
-    ReplayGain::TrackGain mTrackGain;
+    ReplayGain::Result mTrackGain;
 
     quint64 mTotal    = 0;
     quint64 mReady    = 0;
     int     mProgress = 0;
 
-    void readInputFile(QProcess *process);
+    void readInputFile(QIODevice *out, bool supportRf64);
     void copyFile();
 
+    void runPipe(const QList<QProcess *> &procs, bool supportRf64);
+    void preprocessToWave64();
+    bool isWave64Required() const;
+
     QProcess *createEncoderProcess();
-    QProcess *createRasmpler(const QString &outFile);
-    QProcess *createDemph(const QString &outFile);
+    QProcess *createRasmpler(const QString &outFile, const QString &inType, const QString &outType);
+    QProcess *createDemph(const QString &outFile, const QString &outType);
     void      writeMetadata() const;
+    void      setMetadata(MetadataWriter *writer) const;
+
+    bool           isResampleRequired() const;
+    bool           isDeemphasisRequired() const;
+    NativeEncoder *createNativeEncoder() const;
+    void           runNativeEncoder(NativeEncoder *encoder);
 
-    QStringList resamplerArgs(int bitsPerSample, int sampleRate, const QString &outFile);
-    QStringList deemphasisArgs(const QString &outFile);
+    QStringList resamplerArgs(int bitsPerSample, int sampleRate, const QString &inType, const QString &outFile, const QString &outType);
+    QStringList deemphasisArgs(const QString &outFile, const QString &outType);
 };
 
 } // namespace
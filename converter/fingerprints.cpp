@@ -0,0 +1,296 @@
+/* BEGIN_COMMON_COPYRIGHT_HEADER
+ * (c)LGPL2+
+ *
+ * Flacon - audio File Encoder
+ * https://github.com/flacon/flacon
+ *
+ * Copyright: 2024
+ *   Alexander Sokoloff <sokoloff.a@gmail.com>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * END_COMMON_COPYRIGHT_HEADER */
+
+#include "fingerprints.h"
+#include "track.h"
+#include "disc.h"
+#include "profiles.h"
+
+#include <QCryptographicHash>
+#include <QDateTime>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QStandardPaths>
+#include <QLoggingCategory>
+
+namespace {
+Q_LOGGING_CATEGORY(LOG, "Fingerprints")
+}
+
+using namespace Conv;
+
+/************************************************
+ *
+ ************************************************/
+class FingerprintHash : public QCryptographicHash
+{
+public:
+    FingerprintHash() :
+        QCryptographicHash(QCryptographicHash::Sha1) { }
+
+    void add(const QVariant &value)
+    {
+        addData(value.toString().toUtf8());
+        addData("\n", 1);
+    }
+
+    void addTags(const Track &track)
+    {
+        for (int t = 0; t <= int(TagId::TrackCount); ++t) {
+            add(track.tag(TagId(t)));
+        }
+    }
+};
+
+/************************************************
+ *
+ ************************************************/
+Fingerprints *Fingerprints::instance()
+{
+    static Fingerprints res;
+    return &res;
+}
+
+/************************************************
+ *
+ ************************************************/
+QString Fingerprints::fileName() const
+{
+    QString dir = QStandardPaths::writableLocation(QStandardPaths::AppLocalDataLocation);
+    if (dir.isEmpty()) {
+        return "";
+    }
+
+    return dir + "/fingerprints";
+}
+
+/************************************************
+ * Line format: audio metadata path
+ ************************************************/
+void Fingerprints::load()
+{
+    mLoaded = true;
+
+    QFile file(fileName());
+    if (file.fileName().isEmpty() || !file.open(QFile::ReadOnly)) {
+        return;
+    }
+
+    while (!file.atEnd()) {
+        const QByteArray line = file.readLine();
+        if (!line.endsWith('\n')) {
+            break;
+        }
+
+        const int a = line.indexOf(' ');
+        const int m = line.indexOf(' ', a + 1);
+        if (a < 1 || m < a + 2) {
+            continue;
+        }
+
+        Entry entry;
+        entry.audio    = line.left(a);
+        entry.metadata = line.mid(a + 1, m - a - 1);
+
+        mItems[QString::fromUtf8(line.mid(m + 1).chopped(1))] = entry;
+        ++mLines;
+    }
+}
+
+/************************************************
+ * The file is appended on every change,
+ * rewrite it when it has too many stale lines.
+ ************************************************/
+void Fingerprints::save()
+{
+    QFile file(fileName());
+    if (file.fileName().isEmpty()) {
+        return;
+    }
+
+    QDir().mkpath(QFileInfo(file).absolutePath());
+    if (!file.open(QFile::WriteOnly | QFile::Truncate)) {
+        qCWarning(LOG) << "Can't write" << file.fileName() << file.errorString();
+        return;
+    }
+
+    for (auto it = mItems.constBegin(); it != mItems.constEnd(); ++it) {
+        file.write(it->audio + " " + it->metadata + " " + it.key().toUtf8() + "\n");
+    }
+    mLines = mItems.count();
+}
+
+/************************************************
+ *
+ ************************************************/
+QByteArray Fingerprints::coverHash(const QString &fileName)
+{
+    if (fileName.isEmpty()) {
+        return QByteArray();
+    }
+
+    QFileInfo  fi(fileName);
+    QString    key = QString("%1:%2:%3").arg(fi.absoluteFilePath()).arg(fi.size()).arg(fi.lastModified().toMSecsSinceEpoch());
+    QByteArray res = mCoverHashes.value(key);
+    if (!res.isEmpty()) {
+        return res;
+    }
+
+    QFile file(fileName);
+    if (!file.open(QFile::ReadOnly)) {
+        return QByteArray();
+    }
+
+    QCryptographicHash hash(QCryptographicHash::Sha1);
+    hash.addData(&file);
+    res               = hash.result().toHex();
+    mCoverHashes[key] = res;
+    return res;
+}
+
+/************************************************
+ *
+ ************************************************/
+QByteArray Fingerprints::audioFingerprint(const Profile &profile, const Track &track)
+{
+    FingerprintHash hash;
+
+    QFileInfo audio(track.audioFile().filePath());
+    hash.add(audio.absoluteFilePath());
+    hash.add(audio.size());
+    hash.add(audio.lastModified().toMSecsSinceEpoch());
+
+    hash.add(track.index());
+    hash.add(track.cueIndex(0).milliseconds());
+    hash.add(track.cueIndex(1).milliseconds());
+    hash.add(track.duration());
+
+    hash.add(profile.formatId());
+    hash.add(int(profile.bitsPerSample()));
+    hash.add(int(profile.sampleRate()));
+    hash.add(int(profile.pregapType()));
+    hash.add(int(profile.gainType()));
+
+    const auto  values = profile.encoderValues();
+    QStringList keys   = values.keys();
+    keys.sort();
+    for (const QString &k : std::as_const(keys)) {
+        hash.add(k);
+        hash.add(values.value(k));
+    }
+
+    return hash.result().toHex();
+}
+
+/************************************************
+ * The embedded CUE contains the tags of all the
+ * disc tracks, so they are a part of the metadata.
+ ************************************************/
+QByteArray Fingerprints::metadataFingerprint(const Profile &profile, const Track &track)
+{
+    FingerprintHash hash;
+    hash.addTags(track);
+
+    const CoverOptions cover = profile.embedCoverOptions();
+    hash.add(int(cover.mode));
+    hash.add(cover.size);
+    if (cover.mode != CoverMode::Disable && track.disc()) {
+        hash.add(coverHash(track.disc()->coverImageFile()));
+    }
+
+    hash.add(profile.isEmbedCue());
+    if (profile.isEmbedCue() && track.disc()) {
+        for (int i = 0; i < track.disc()->count(); ++i) {
+            hash.addTags(*track.disc()->track(i));
+        }
+    }
+
+    return hash.result().toHex();
+}
+
+/************************************************
+ *
+ ************************************************/
+Fingerprints::Match Fingerprints::match(const Profile &profile, const Track &track)
+{
+    if (!mLoaded) {
+        load();
+    }
+
+    const QString resultFile = profile.resultFilePath(&track);
+    const auto    it         = mItems.constFind(resultFile);
+
+    if (it == mItems.constEnd() || !QFileInfo::exists(resultFile)) {
+        return Match::Changed;
+    }
+
+    if (it->audio != audioFingerprint(profile, track)) {
+        return Match::Changed;
+    }
+
+    if (it->metadata != metadataFingerprint(profile, track)) {
+        return Match::TagsChanged;
+    }
+
+    return Match::Same;
+}
+
+/************************************************
+ *
+ ************************************************/
+void Fingerprints::store(const Profile &profile, const Track &track)
+{
+    if (!mLoaded) {
+        load();
+    }
+
+    const QString resultFile = profile.resultFilePath(&track);
+
+    Entry entry;
+    entry.audio    = audioFingerprint(profile, track);
+    entry.metadata = metadataFingerprint(profile, track);
+
+    mItems[resultFile] = entry;
+
+    if (mLines > 2 * mItems.count() + 1000) {
+        save();
+        return;
+    }
+
+    QFile file(fileName());
+    if (file.fileName().isEmpty()) {
+        return;
+    }
+
+    QDir().mkpath(QFileInfo(file).absolutePath());
+    if (!file.open(QFile::WriteOnly | QFile::Append)) {
+        qCWarning(LOG) << "Can't write" << file.fileName() << file.errorString();
+        return;
+    }
+
+    file.write(entry.audio + " " + entry.metadata + " " + resultFile.toUtf8() + "\n");
+    ++mLines;
+}
@@ -0,0 +1,87 @@
+/* BEGIN_COMMON_COPYRIGHT_HEADER
+ * (c)LGPL2+
+ *
+ * Flacon - audio File Encoder
+ * https://github.com/flacon/flacon
+ *
+ * Copyright: 2024
+ *   Alexander Sokoloff <sokoloff.a@gmail.com>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * END_COMMON_COPYRIGHT_HEADER */
+
+#ifndef FINGERPRINTS_H
+#define FINGERPRINTS_H
+
+#include <QString>
+#include <QHash>
+#include <QByteArray>
+
+class Track;
+class Profile;
+
+namespace Conv {
+
+/************************************************
+ * Persistent fingerprints of the result files.
+ *
+ * The audio fingerprint covers everything that
+ * changes the encoded audio: the source file,
+ * the CUE index range and the encoder settings.
+ * The metadata fingerprint covers the tags and
+ * the cover. If only the latter differs, the
+ * result file needs just a metadata rewrite.
+ ************************************************/
+class Fingerprints
+{
+public:
+    enum class Match {
+        Changed,
+        TagsChanged,
+        Same,
+    };
+
+    static Fingerprints *instance();
+
+    Match match(const Profile &profile, const Track &track);
+    void  store(const Profile &profile, const Track &track);
+
+    static QByteArray audioFingerprint(const Profile &profile, const Track &track);
+    QByteArray        metadataFingerprint(const Profile &profile, const Track &track);
+
+private:
+    Fingerprints() = default;
+
+    struct Entry
+    {
+        QByteArray audio;
+        QByteArray metadata;
+    };
+
+    bool                       mLoaded = false;
+    QHash<QString, Entry>      mItems;
+    QHash<QString, QByteArray> mCoverHashes;
+    int                        mLines = 0;
+
+    QString    fileName() const;
+    void       load();
+    void       save();
+    QByteArray coverHash(const QString &fileName);
+};
+
+} // namespace Conv
+
+#endif // FINGERPRINTS_H
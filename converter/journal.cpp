@@ -0,0 +1,304 @@
+/* BEGIN_COMMON_COPYRIGHT_HEADER
+ * (c)LGPL2+
+ *
+ * Flacon - audio File Encoder
+ * https://github.com/flacon/flacon
+ *
+ * Copyright: 2024
+ *   Alexander Sokoloff <sokoloff.a@gmail.com>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * END_COMMON_COPYRIGHT_HEADER */
+
+#include "journal.h"
+#include "track.h"
+#include "disc.h"
+
+#include <QCryptographicHash>
+#include <QDateTime>
+#include <QDir>
+#include <QFileInfo>
+#include <QStandardPaths>
+#include <QLoggingCategory>
+
+namespace {
+Q_LOGGING_CATEGORY(LOG, "Journal")
+}
+
+using namespace Conv;
+
+/************************************************
+ *
+ ************************************************/
+static QByteArray stateToString(Journal::State state)
+{
+    switch (state) {
+        case Journal::State::Split:
+            return "split";
+        case Journal::State::Encoded:
+            return "encoded";
+        case Journal::State::GainWritten:
+            return "gain";
+        case Journal::State::Done:
+            return "done";
+    }
+    return "";
+}
+
+/************************************************
+ *
+ ************************************************/
+static bool strToState(const QByteArray &str, Journal::State *state)
+{
+    for (Journal::State s : { Journal::State::Split, Journal::State::Encoded, Journal::State::GainWritten, Journal::State::Done }) {
+        if (str == stateToString(s)) {
+            *state = s;
+            return true;
+        }
+    }
+    return false;
+}
+
+/************************************************
+ *
+ ************************************************/
+Journal::~Journal()
+{
+    mFile.close();
+}
+
+/************************************************
+ * Everything that changes the result files is
+ * a part of the batch id, so a changed batch
+ * never reuses the old results.
+ ************************************************/
+QByteArray Journal::batchId(const QVector<const Track *> &tracks, const Profiles &profiles)
+{
+    QCryptographicHash hash(QCryptographicHash::Sha1);
+    auto               add = [&hash](const QVariant &value) {
+        hash.addData(value.toString().toUtf8());
+        hash.addData("\n", 1);
+    };
+
+    for (const Profile &profile : profiles) {
+        add(profile.id());
+        add(profile.formatId());
+        add(int(profile.gainType()));
+        add(int(profile.bitsPerSample()));
+        add(int(profile.sampleRate()));
+        add(int(profile.pregapType()));
+        add(profile.isCreateCue());
+        add(profile.isEmbedCue());
+        add(int(profile.copyCoverOptions().mode));
+        add(profile.copyCoverOptions().size);
+        add(int(profile.embedCoverOptions().mode));
+        add(profile.embedCoverOptions().size);
+
+        const auto  values = profile.encoderValues();
+        QStringList keys   = values.keys();
+        keys.sort();
+        for (const QString &k : std::as_const(keys)) {
+            add(k);
+            add(values.value(k));
+        }
+    }
+
+    for (const Track *track : tracks) {
+        QFileInfo audio(track->audioFile().filePath());
+        add(audio.absoluteFilePath());
+        add(audio.size());
+        add(audio.lastModified().toMSecsSinceEpoch());
+        add(track->index());
+        add(track->cueIndex(0).milliseconds());
+        add(track->cueIndex(1).milliseconds());
+        add(track->duration());
+
+        for (int t = 0; t <= int(TagId::TrackCount); ++t) {
+            add(track->tag(TagId(t)));
+        }
+
+        if (track->disc()) {
+            add(track->disc()->coverImageFile());
+        }
+    }
+
+    return hash.result().toHex();
+}
+
+/************************************************
+ * The whole file is hashed, a file corrupted in
+ * the middle must not be taken as done.
+ ************************************************/
+QByteArray Journal::fileChecksum(const QString &fileName)
+{
+    QFile file(fileName);
+    if (!file.open(QFile::ReadOnly)) {
+        return QByteArray();
+    }
+
+    QCryptographicHash hash(QCryptographicHash::Sha1);
+    if (!hash.addData(&file)) {
+        return QByteArray();
+    }
+
+    return hash.result().toHex();
+}
+
+/************************************************
+ *
+ ************************************************/
+QString Journal::key(const Profile &profile, const Track &track)
+{
+    return profile.id() + "\t" + profile.resultFilePath(&track);
+}
+
+/************************************************
+ *
+ ************************************************/
+void Journal::open(const QVector<const Track *> &tracks, const Profiles &profiles)
+{
+    close();
+
+    QString dir = QStandardPaths::writableLocation(QStandardPaths::AppLocalDataLocation);
+    if (dir.isEmpty()) {
+        return;
+    }
+
+    dir += "/journal";
+    if (!QDir().mkpath(dir)) {
+        qCWarning(LOG) << "Can't create journal directory" << dir;
+        return;
+    }
+
+    for (const Profile &profile : profiles) {
+        for (const Track *track : tracks) {
+            mExpected << key(profile, *track);
+        }
+    }
+
+    mFile.setFileName(dir + "/" + batchId(tracks, profiles) + ".journal");
+    load();
+
+    if (!mFile.open(QFile::WriteOnly | QFile::Append)) {
+        qCWarning(LOG) << "Can't open journal" << mFile.fileName() << mFile.errorString();
+        return;
+    }
+
+    qCDebug(LOG) << "Journal" << mFile.fileName() << "contains" << mEntries.count() << "entries";
+}
+
+/************************************************
+ * Line format: state size checksum profile\tpath
+ ************************************************/
+void Journal::load()
+{
+    if (!mFile.open(QFile::ReadOnly)) {
+        return;
+    }
+
+    while (!mFile.atEnd()) {
+        const QByteArray line = mFile.readLine();
+        if (!line.endsWith('\n')) {
+            break; // The last line was not completely written
+        }
+
+        const QList<QByteArray> fields = line.chopped(1).split(' ');
+        if (fields.count() < 4) {
+            continue;
+        }
+
+        Entry entry;
+        if (!strToState(fields.at(0), &entry.state)) {
+            continue;
+        }
+        entry.size     = fields.at(1).toLongLong();
+        entry.checksum = fields.at(2);
+
+        // The key may contain spaces
+        const int  n   = fields.at(0).size() + fields.at(1).size() + fields.at(2).size() + 3;
+        const auto key = QString::fromUtf8(line.mid(n).chopped(1));
+        mEntries[key]  = entry;
+    }
+
+    mFile.close();
+}
+
+/************************************************
+ * The completed batch doesn't need the journal.
+ ************************************************/
+void Journal::close()
+{
+    if (!mFile.isOpen()) {
+        return;
+    }
+
+    bool complete = true;
+    for (const QString &k : std::as_const(mExpected)) {
+        if (mEntries.value(k).state != State::Done) {
+            complete = false;
+            break;
+        }
+    }
+
+    mFile.close();
+    if (complete) {
+        qCDebug(LOG) << "Batch is complete, remove journal" << mFile.fileName();
+        mFile.remove();
+    }
+
+    mEntries.clear();
+    mExpected.clear();
+}
+
+/************************************************
+ *
+ ************************************************/
+bool Journal::isDone(const Profile &profile, const Track &track) const
+{
+    const auto it = mEntries.constFind(key(profile, track));
+    if (it == mEntries.constEnd() || it->state != State::Done) {
+        return false;
+    }
+
+    const QString fileName = profile.resultFilePath(&track);
+    return QFileInfo(fileName).size() == it->size && fileChecksum(fileName) == it->checksum;
+}
+
+/************************************************
+ *
+ ************************************************/
+void Journal::write(const Profile &profile, const Track &track, State state)
+{
+    if (!mFile.isOpen()) {
+        return;
+    }
+
+    Entry entry;
+    entry.state = state;
+
+    if (state == State::Done) {
+        const QString fileName = profile.resultFilePath(&track);
+        entry.size             = QFileInfo(fileName).size();
+        entry.checksum         = fileChecksum(fileName);
+    }
+
+    const QString k = key(profile, track);
+    mEntries[k]     = entry;
+
+    QByteArray line = stateToString(state) + " " + QByteArray::number(entry.size) + " " + (entry.checksum.isEmpty() ? QByteArray("-") : entry.checksum) + " " + k.toUtf8() + "\n";
+    mFile.write(line);
+    mFile.flush();
+}
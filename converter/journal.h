@@ -0,0 +1,93 @@
+/* BEGIN_COMMON_COPYRIGHT_HEADER
+ * (c)LGPL2+
+ *
+ * Flacon - audio File Encoder
+ * https://github.com/flacon/flacon
+ *
+ * Copyright: 2024
+ *   Alexander Sokoloff <sokoloff.a@gmail.com>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * END_COMMON_COPYRIGHT_HEADER */
+
+#ifndef JOURNAL_H
+#define JOURNAL_H
+
+#include <QString>
+#include <QHash>
+#include <QSet>
+#include <QFile>
+#include <QVector>
+#include "profiles.h"
+
+class Track;
+
+namespace Conv {
+
+/************************************************
+ * Persistent log of the track state transitions.
+ *
+ * The journal file is named after the batch: the
+ * profiles and everything about the requested
+ * tracks that affects the result. When the same
+ * batch is started again after a crash or stop,
+ * tracks whose result file still matches the
+ * recorded checksum are not converted again.
+ * The file is removed when the batch completes.
+ ************************************************/
+class Journal
+{
+public:
+    enum class State {
+        Split,
+        Encoded,
+        GainWritten,
+        Done,
+    };
+
+    Journal() = default;
+    ~Journal();
+
+    void open(const QVector<const Track *> &tracks, const Profiles &profiles);
+    void close();
+
+    bool isOpen() const { return mFile.isOpen(); }
+    bool isDone(const Profile &profile, const Track &track) const;
+
+    void write(const Profile &profile, const Track &track, State state);
+
+    static QByteArray batchId(const QVector<const Track *> &tracks, const Profiles &profiles);
+    static QByteArray fileChecksum(const QString &fileName);
+
+private:
+    struct Entry
+    {
+        State      state = State::Split;
+        qint64     size  = 0;
+        QByteArray checksum;
+    };
+
+    QFile                 mFile;
+    QHash<QString, Entry> mEntries;
+    QSet<QString>         mExpected;
+
+    static QString key(const Profile &profile, const Track &track);
+    void           load();
+};
+
+} // namespace Conv
+
+#endif // JOURNAL_H
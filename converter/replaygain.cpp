@@ -59,7 +59,8 @@ using namespace ReplayGain;
 
 static constexpr int YULE_ORDER   = 10;
 static constexpr int BUTTER_ORDER = 2;
-static constexpr int NAX_CHAN_NUM = 2;
+static constexpr int MAX_CHAN_NUM = MAX_CHANNELS;
+static constexpr int HIST_SIZE    = 256;
 
 #define DEBUG_LEVELS 0
 #define DEBUG_FLOATS 0
@@ -277,7 +278,7 @@ private:
         int index            = 0;
     };
 
-    ChanState mChanState[NAX_CHAN_NUM];
+    ChanState mChanState[MAX_CHAN_NUM];
     int       mChan        = 0;
     const int mNumChannels = 0;
     const int mRatio       = 0;
@@ -345,11 +346,12 @@ public:
     void add_int32(const char *data, size_t size);
     void addFloatSample(uint32_t sample);
 
+    void   initWeights(quint32 channelMask);
     void   calc(uint32_t count);
-    void   calcStereoPeak(uint32_t count);
-    void   yuleFilterStereoSamples(float *samples, uint32_t size);
-    void   butterFilterStereoSamples(float *samples, uint32_t size);
-    double calcStereoRms(float *samples, uint32_t size) const;
+    void   calcPeak(uint32_t count);
+    void   yuleFilterSamples(float *samples, uint32_t size);
+    void   butterFilterSamples(float *samples, uint32_t size);
+    double calcRms(const float *samples, uint32_t size) const;
 
 public:
     Result &mResult;
@@ -357,10 +359,11 @@ public:
     bool       mHeaderReady = false;
     QByteArray mHeaderData;
 
-    int      mNumChannels   = 0;
-    uint32_t mSampleRate    = 0;
-    uint16_t mBitsPerSample = 0;
-    size_t   mRemains       = 0;
+    int      mNumChannels    = 0;
+    int      mFilterChannels = 0; // The mono is filtered as stereo
+    uint32_t mSampleRate     = 0;
+    uint16_t mBitsPerSample  = 0;
+    size_t   mRemains        = 0;
 
     uint     mIntSampleIndex = 0;
     uint32_t mIntSample      = 0;
@@ -376,13 +379,15 @@ public:
     double const *mButterCoeffA = nullptr;
     double const *mButterCoeffB = nullptr;
 
-    float mYuleHistA[256]    = { 0 };
-    float mYuleHistB[256]    = { 0 };
-    float butter_hist_a[256] = { 0 };
-    float butter_hist_b[256] = { 0 };
+    double mWeights[MAX_CHAN_NUM] = { 0 };
 
-    int mYuleHistI   = 20;
-    int mButterHistI = 4;
+    float mYuleHistA[MAX_CHAN_NUM][HIST_SIZE]   = { { 0 } };
+    float mYuleHistB[MAX_CHAN_NUM][HIST_SIZE]   = { { 0 } };
+    float mButterHistA[MAX_CHAN_NUM][HIST_SIZE] = { { 0 } };
+    float mButterHistB[MAX_CHAN_NUM][HIST_SIZE] = { { 0 } };
+
+    int mYuleHistI   = YULE_ORDER;
+    int mButterHistI = BUTTER_ORDER;
 };
 
 /************************************************
@@ -423,17 +428,20 @@ size_t TrackGain::Engine::loadHeader(const char *data, size_t size)
     mBitsPerSample = header.bitsPerSample();
     mRemains       = header.dataSize();
 
-    if (mNumChannels > 2) {
-        throw FlaconError("can't handle multichannel files yet!");
+    if (mNumChannels < 1 || mNumChannels > MAX_CHAN_NUM) {
+        throw FlaconError(QString("%1 channels are not supported!").arg(mNumChannels));
     }
 
+    mFilterChannels = std::max(mNumChannels, 2);
+    initWeights(header.channelMask() ? header.channelMask() : Conv::WavHeader::defaultChannelMask(mNumChannels));
+
     uint32_t sampleRate = mSampleRate;
     if (sampleRate >= 256000) {
         mDecimator = new Decimator(mNumChannels, 4);
         sampleRate /= 4;
     }
 
-    mFloatSamplesMaxSize = sampleRate / 20 * NAX_CHAN_NUM; // 2 - is always stereo
+    mFloatSamplesMaxSize = sampleRate / 20 * mFilterChannels;
     mFloatSamples        = new float[mFloatSamplesMaxSize];
 
     // Initialize filters;
@@ -463,6 +471,40 @@ size_t TrackGain::Engine::loadHeader(const char *data, size_t size)
     return header.dataStartPos() - prev;
 }
 
+/************************************************
+ * The channel weights are the same as ITU-R BS.1770:
+ * the surround channels are +1.5 dB, LFE is ignored.
+ * The channels are in the order of the mask bits, the
+ * stereo and the mono (filtered as stereo) are 1.0.
+ ************************************************/
+void TrackGain::Engine::initWeights(quint32 channelMask)
+{
+    static constexpr quint32 LOW_FREQUENCY = 0x0008;
+    static constexpr quint32 SURROUND      = 0x0030 | 0x0100 | 0x0600; // BL BR, BC, SL SR
+
+    quint32 bit = 1;
+    for (int c = 0; c < mFilterChannels; ++c) {
+        while (bit && !(channelMask & bit)) {
+            bit <<= 1;
+        }
+
+        if (mNumChannels <= 2 || !bit) {
+            mWeights[c] = 1.0;
+        }
+        else if (bit & LOW_FREQUENCY) {
+            mWeights[c] = 0.0;
+        }
+        else if (bit & SURROUND) {
+            mWeights[c] = 1.41;
+        }
+        else {
+            mWeights[c] = 1.0;
+        }
+
+        bit <<= 1;
+    }
+}
+
 /************************************************
  *
  ************************************************/
@@ -684,11 +726,15 @@ void TrackGain::Engine::add_int32(const char *data, size_t size)
  ************************************************/
 void TrackGain::Engine::calc(uint32_t count)
 {
-    calcStereoPeak(count);
-    yuleFilterStereoSamples(mFloatSamples, count);
-    butterFilterStereoSamples(mFloatSamples, count);
+    if (count < uint32_t(mFilterChannels)) {
+        return;
+    }
+
+    calcPeak(count);
+    yuleFilterSamples(mFloatSamples, count);
+    butterFilterSamples(mFloatSamples, count);
 
-    int32_t level = (int32_t)floor(100 * calcStereoRms(mFloatSamples, count));
+    int32_t level = (int32_t)floor(100 * calcRms(mFloatSamples, count));
 #if DEBUG_LEVELS
     printf("LEVEL: %d  PEAK: %f  cnt:%d\n", level, mResult.mPeak, count);
 #endif
@@ -707,7 +753,7 @@ void TrackGain::Engine::calc(uint32_t count)
 /************************************************
  * Update largest absolute sample value
  ************************************************/
-void TrackGain::Engine::calcStereoPeak(uint32_t count)
+void TrackGain::Engine::calcPeak(uint32_t count)
 {
     for (uint32_t i = 0; i < count; ++i) {
         mResult.mPeak = std::max(mResult.mPeak, std::abs(mFloatSamples[i]));
@@ -715,122 +761,93 @@ void TrackGain::Engine::calcStereoPeak(uint32_t count)
 }
 
 /************************************************
- * Optimized mplementation of 10th-order IIR stereo filter
+ * If filter history is very small magnitude, clear it completely to prevent denormals
+ * from rattling around in there forever (slowing us down).
  ************************************************/
-void TrackGain::Engine::yuleFilterStereoSamples(float *samples, uint32_t size)
+template <int ORDER>
+static void clearDenormals(float (*histA)[HIST_SIZE], float (*histB)[HIST_SIZE], int channels, int i)
 {
-    size = size / 2;
-    double left, right;
-    int    i, j;
-
-    i = mYuleHistI;
-
-    // If filter history is very small magnitude, clear it completely to prevent denormals
-    // from rattling around in there forever (slowing us down).
-
-    for (j = -20; j < 0; ++j)
-        if (fabs(mYuleHistA[i + j]) > 1e-10 || fabs(mYuleHistB[i + j]) > 1e-10)
-            break;
-
-    if (!j) {
-        memset(mYuleHistA, 0, sizeof(mYuleHistA));
-        memset(mYuleHistB, 0, sizeof(mYuleHistB));
-    }
-
-    while (size--) {
-        left  = (mYuleHistB[i] = samples[0]) * mYuleCoeffB[0];
-        right = (mYuleHistB[i + 1] = samples[1]) * mYuleCoeffB[0];
-        left += mYuleHistB[i - 2] * mYuleCoeffB[1] - mYuleHistA[i - 2] * mYuleCoeffA[1];
-        right += mYuleHistB[i - 1] * mYuleCoeffB[1] - mYuleHistA[i - 1] * mYuleCoeffA[1];
-        left += mYuleHistB[i - 4] * mYuleCoeffB[2] - mYuleHistA[i - 4] * mYuleCoeffA[2];
-        right += mYuleHistB[i - 3] * mYuleCoeffB[2] - mYuleHistA[i - 3] * mYuleCoeffA[2];
-        left += mYuleHistB[i - 6] * mYuleCoeffB[3] - mYuleHistA[i - 6] * mYuleCoeffA[3];
-        right += mYuleHistB[i - 5] * mYuleCoeffB[3] - mYuleHistA[i - 5] * mYuleCoeffA[3];
-        left += mYuleHistB[i - 8] * mYuleCoeffB[4] - mYuleHistA[i - 8] * mYuleCoeffA[4];
-        right += mYuleHistB[i - 7] * mYuleCoeffB[4] - mYuleHistA[i - 7] * mYuleCoeffA[4];
-        left += mYuleHistB[i - 10] * mYuleCoeffB[5] - mYuleHistA[i - 10] * mYuleCoeffA[5];
-        right += mYuleHistB[i - 9] * mYuleCoeffB[5] - mYuleHistA[i - 9] * mYuleCoeffA[5];
-        left += mYuleHistB[i - 12] * mYuleCoeffB[6] - mYuleHistA[i - 12] * mYuleCoeffA[6];
-        right += mYuleHistB[i - 11] * mYuleCoeffB[6] - mYuleHistA[i - 11] * mYuleCoeffA[6];
-        left += mYuleHistB[i - 14] * mYuleCoeffB[7] - mYuleHistA[i - 14] * mYuleCoeffA[7];
-        right += mYuleHistB[i - 13] * mYuleCoeffB[7] - mYuleHistA[i - 13] * mYuleCoeffA[7];
-        left += mYuleHistB[i - 16] * mYuleCoeffB[8] - mYuleHistA[i - 16] * mYuleCoeffA[8];
-        right += mYuleHistB[i - 15] * mYuleCoeffB[8] - mYuleHistA[i - 15] * mYuleCoeffA[8];
-        left += mYuleHistB[i - 18] * mYuleCoeffB[9] - mYuleHistA[i - 18] * mYuleCoeffA[9];
-        right += mYuleHistB[i - 17] * mYuleCoeffB[9] - mYuleHistA[i - 17] * mYuleCoeffA[9];
-        left += mYuleHistB[i - 20] * mYuleCoeffB[10] - mYuleHistA[i - 20] * mYuleCoeffA[10];
-        right += mYuleHistB[i - 19] * mYuleCoeffB[10] - mYuleHistA[i - 19] * mYuleCoeffA[10];
-        samples[0] = mYuleHistA[i] = (float)left;
-        samples[1] = mYuleHistA[i + 1] = (float)right;
-        samples += 2;
-
-        if ((i += 2) == 256) {
-            memcpy(mYuleHistA, mYuleHistA + 236, sizeof(mYuleHistA[0]) * 20);
-            memcpy(mYuleHistB, mYuleHistB + 236, sizeof(mYuleHistB[0]) * 20);
-            i = 20;
+    for (int c = 0; c < channels; ++c) {
+        for (int j = i - ORDER; j < i; ++j) {
+            if (fabs(histA[c][j]) > 1e-10 || fabs(histB[c][j]) > 1e-10) {
+                return;
+            }
         }
     }
 
-    mYuleHistI = i;
+    memset(histA, 0, sizeof(histA[0]) * MAX_CHAN_NUM);
+    memset(histB, 0, sizeof(histB[0]) * MAX_CHAN_NUM);
 }
 
 /************************************************
- * Optimized mplementation of 2nd-order IIR stereo filter
+ * Direct form I implementation of the IIR filter,
+ * the samples are interleaved, every channel has
+ * its own history.
  ************************************************/
-void TrackGain::Engine::butterFilterStereoSamples(float *samples, uint32_t size)
+template <int ORDER>
+static int filterSamples(float *samples, uint32_t size, int channels, const double *coeffA, const double *coeffB, float (*histA)[HIST_SIZE], float (*histB)[HIST_SIZE], int i)
 {
-    size = size / 2;
-    double left, right;
-    int    i, j;
+    clearDenormals<ORDER>(histA, histB, channels, i);
 
-    i = mButterHistI;
-
-    // If filter history is very small magnitude, clear it completely to prevent denormals
-    // from rattling around in there forever (slowing us down).
-
-    for (j = -4; j < 0; ++j)
-        if (fabs(butter_hist_a[i + j]) > 1e-10 || fabs(butter_hist_b[i + j]) > 1e-10)
-            break;
+    size = size / channels;
+    while (size--) {
+        for (int c = 0; c < channels; ++c) {
+            float *ha = histA[c];
+            float *hb = histB[c];
 
-    if (!j) {
-        memset(butter_hist_a, 0, sizeof(butter_hist_a));
-        memset(butter_hist_b, 0, sizeof(butter_hist_b));
-    }
+            double res = (hb[i] = samples[c]) * coeffB[0];
+            for (int k = 1; k <= ORDER; ++k) {
+                res += hb[i - k] * coeffB[k] - ha[i - k] * coeffA[k];
+            }
+            samples[c] = ha[i] = (float)res;
+        }
+        samples += channels;
 
-    while (size--) {
-        left  = (butter_hist_b[i] = samples[0]) * mButterCoeffB[0];
-        right = (butter_hist_b[i + 1] = samples[1]) * mButterCoeffB[0];
-        left += butter_hist_b[i - 2] * mButterCoeffB[1] - butter_hist_a[i - 2] * mButterCoeffA[1];
-        right += butter_hist_b[i - 1] * mButterCoeffB[1] - butter_hist_a[i - 1] * mButterCoeffA[1];
-        left += butter_hist_b[i - 4] * mButterCoeffB[2] - butter_hist_a[i - 4] * mButterCoeffA[2];
-        right += butter_hist_b[i - 3] * mButterCoeffB[2] - butter_hist_a[i - 3] * mButterCoeffA[2];
-        samples[0] = butter_hist_a[i] = (float)left;
-        samples[1] = butter_hist_a[i + 1] = (float)right;
-        samples += 2;
-
-        if ((i += 2) == 256) {
-            memcpy(butter_hist_a, butter_hist_a + 252, sizeof(butter_hist_a[0]) * 4);
-            memcpy(butter_hist_b, butter_hist_b + 252, sizeof(butter_hist_b[0]) * 4);
-            i = 4;
+        if (++i == HIST_SIZE) {
+            for (int c = 0; c < channels; ++c) {
+                memcpy(histA[c], histA[c] + HIST_SIZE - ORDER, sizeof(histA[c][0]) * ORDER);
+                memcpy(histB[c], histB[c] + HIST_SIZE - ORDER, sizeof(histB[c][0]) * ORDER);
+            }
+            i = ORDER;
         }
     }
 
-    mButterHistI = i;
+    return i;
 }
 
 /************************************************
- * Calculate stereo rms level. Minimum value is about -100 dB for digital silence. The 90 dB
- * offset is to compensate for the normalized float range and 3 dB is for stereo samples.
+ * 10th-order IIR filter
  ************************************************/
-double TrackGain::Engine::calcStereoRms(float *samples, uint32_t size) const
+void TrackGain::Engine::yuleFilterSamples(float *samples, uint32_t size)
+{
+    mYuleHistI = filterSamples<YULE_ORDER>(samples, size, mFilterChannels, mYuleCoeffA, mYuleCoeffB, mYuleHistA, mYuleHistB, mYuleHistI);
+}
+
+/************************************************
+ * 2nd-order IIR filter
+ ************************************************/
+void TrackGain::Engine::butterFilterSamples(float *samples, uint32_t size)
+{
+    mButterHistI = filterSamples<BUTTER_ORDER>(samples, size, mFilterChannels, mButterCoeffA, mButterCoeffB, mButterHistA, mButterHistB, mButterHistI);
+}
+
+/************************************************
+ * Calculate rms level. Minimum value is about -100 dB for digital silence. The 90 dB
+ * offset is to compensate for the normalized float range and 3 dB is for stereo samples,
+ * the multichannel power is the weighted sum of the channels, so it's louder than stereo.
+ ************************************************/
+double TrackGain::Engine::calcRms(const float *samples, uint32_t size) const
 {
     double sum = 1e-16;
 
-    for (uint32_t i = 0; i < size; ++i) {
-        sum += samples[i] * samples[i];
+    const uint32_t frames = size / mFilterChannels;
+    for (uint32_t i = 0; i < frames; ++i) {
+        for (int c = 0; c < mFilterChannels; ++c, ++samples) {
+            sum += mWeights[c] * (*samples * *samples);
+        }
     }
 
-    return 10 * log10(sum / (size / 2)) + 90.0 - 3.0;
+    return 10 * log10(sum / frames) + 90.0 - 3.0;
 }
 
 /************************************************
@@ -43,6 +43,9 @@
 
 namespace ReplayGain {
 
+/// The engine handles the layouts up to 7.1.
+constexpr int MAX_CHANNELS = 8;
+
 class Result
 {
     friend class TrackGain;
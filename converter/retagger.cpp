@@ -0,0 +1,132 @@
+/* BEGIN_COMMON_COPYRIGHT_HEADER
+ * (c)LGPL2+
+ *
+ * Flacon - audio File Encoder
+ * https://github.com/flacon/flacon
+ *
+ * Copyright: 2024
+ *   Alexander Sokoloff <sokoloff.a@gmail.com>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * END_COMMON_COPYRIGHT_HEADER */
+
+#include "retagger.h"
+#include "cuecreator.h"
+#include "track.h"
+#include "disc.h"
+#include "formats_out/metadatawriter.h"
+
+#include <QBuffer>
+#include <QFileInfo>
+#include <QLoggingCategory>
+#include <memory>
+
+namespace {
+Q_LOGGING_CATEGORY(LOG, "Retagger")
+}
+
+using namespace Conv;
+
+/************************************************
+ *
+ ************************************************/
+Retagger::Retagger(const Profile &profile) :
+    mProfile(profile)
+{
+    // The same as DiscPipeline uses for the embedded CUE
+    mPregapType = profile.isCreateCue() ? profile.pregapType() : PreGapType::Skip;
+}
+
+/************************************************
+ *
+ ************************************************/
+CoverImage Retagger::loadCoverImage(const Disc *disc) const
+{
+    const CoverOptions &opts = mProfile.embedCoverOptions();
+
+    QString file = opts.mode != CoverMode::Disable ? disc->coverImageFile() : "";
+    int     size = opts.mode == CoverMode::Scale ? opts.size : 0;
+
+    return file.isEmpty() ? CoverImage() : CoverImage(file, size);
+}
+
+/************************************************
+ *
+ ************************************************/
+QString Retagger::createEmbeddedCue(const Disc *disc) const
+{
+    CueCreator cue(mProfile, disc, mPregapType);
+    QBuffer    buf;
+    cue.write(&buf);
+
+    return QString::fromUtf8(buf.data());
+}
+
+/************************************************
+ *
+ ************************************************/
+void Retagger::prepare(const Disc *disc)
+{
+    if (!disc || mCoverImages.contains(disc)) {
+        return;
+    }
+
+    mCoverImages.insert(disc, loadCoverImage(disc));
+
+    if (mProfile.isEmbedCue()) {
+        mEmbeddedCues.insert(disc, createEmbeddedCue(disc));
+    }
+}
+
+/************************************************
+ *
+ ************************************************/
+void Retagger::retag(const Track &track) const noexcept(false)
+{
+    const QString fileName = mProfile.resultFilePath(&track);
+    qCDebug(LOG) << "Retag" << fileName;
+
+    if (!QFileInfo::exists(fileName)) {
+        throw FlaconError(QObject::tr("File %1 doesn't exist").arg(fileName));
+    }
+
+    std::unique_ptr<MetadataWriter> writer(mProfile.outFormat()->createMetadataWriter(fileName));
+    if (!writer) {
+        return;
+    }
+
+    writer->setRemoveEmptyTags(true);
+    writer->setTags(track);
+
+    const Disc *disc = track.disc();
+
+    // The file was tagged before, so the empty cue and cover remove the old ones
+    QString cue;
+    if (mProfile.isEmbedCue() && disc) {
+        auto it = mEmbeddedCues.constFind(disc);
+        cue     = it != mEmbeddedCues.constEnd() ? it.value() : createEmbeddedCue(disc);
+    }
+    writer->setEmbeddedCue(cue);
+
+    CoverImage image;
+    if (disc) {
+        auto it = mCoverImages.constFind(disc);
+        image   = it != mCoverImages.constEnd() ? it.value() : loadCoverImage(disc);
+    }
+    writer->setCoverImage(image);
+
+    writer->save();
+}
@@ -0,0 +1,69 @@
+/* BEGIN_COMMON_COPYRIGHT_HEADER
+ * (c)LGPL2+
+ *
+ * Flacon - audio File Encoder
+ * https://github.com/flacon/flacon
+ *
+ * Copyright: 2024
+ *   Alexander Sokoloff <sokoloff.a@gmail.com>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * END_COMMON_COPYRIGHT_HEADER */
+
+#ifndef RETAGGER_H
+#define RETAGGER_H
+
+#include <QHash>
+#include "profiles.h"
+#include "coverimage.h"
+
+class Track;
+class Disc;
+
+namespace Conv {
+
+/************************************************
+ * Rewrites the tags, the embedded CUE and the
+ * cover of an existing result file in place,
+ * the audio is not touched.
+ *
+ * prepare() caches the cover and the CUE of the
+ * disc, it's called from the main thread. After
+ * that retag() can be called from any thread.
+ ************************************************/
+class Retagger
+{
+public:
+    explicit Retagger(const Profile &profile);
+
+    const Profile &profile() const { return mProfile; }
+
+    void prepare(const Disc *disc);
+    void retag(const Track &track) const noexcept(false);
+
+private:
+    Profile                         mProfile;
+    PreGapType                      mPregapType = PreGapType::Skip;
+    QHash<const Disc *, CoverImage> mCoverImages;
+    QHash<const Disc *, QString>    mEmbeddedCues;
+
+    CoverImage loadCoverImage(const Disc *disc) const;
+    QString    createEmbeddedCue(const Disc *disc) const;
+};
+
+} // namespace Conv
+
+#endif // RETAGGER_H
@@ -0,0 +1,154 @@
+/* BEGIN_COMMON_COPYRIGHT_HEADER
+ * (c)LGPL2+
+ *
+ * Flacon - audio File Encoder
+ * https://github.com/flacon/flacon
+ *
+ * Copyright: 2024
+ *   Alexander Sokoloff <sokoloff.a@gmail.com>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * END_COMMON_COPYRIGHT_HEADER */
+
+#include "scratchspace.h"
+
+#include <QDir>
+#include <QFileInfo>
+#include <QStorageInfo>
+#include <QLoggingCategory>
+
+namespace {
+Q_LOGGING_CATEGORY(LOG, "ScratchSpace")
+}
+
+using namespace Conv;
+
+/************************************************
+ *
+ ************************************************/
+ScratchSpace *ScratchSpace::instance()
+{
+    static ScratchSpace res;
+    return &res;
+}
+
+/************************************************
+ * We use at most half of the free tmpfs space.
+ ************************************************/
+ScratchSpace::ScratchSpace()
+{
+#ifdef Q_OS_LINUX
+    const QString shm = "/dev/shm";
+    QFileInfo     fi(shm);
+    if (fi.isDir() && fi.isWritable()) {
+        QStorageInfo storage(shm);
+        if (storage.isValid() && storage.fileSystemType() == "tmpfs") {
+            mMemoryDir    = shm;
+            mMemoryBudget = storage.bytesAvailable() / 2;
+        }
+    }
+#endif
+    qCDebug(LOG) << "Memory dir" << mMemoryDir << "budget" << mMemoryBudget;
+}
+
+/************************************************
+ *
+ ************************************************/
+void ScratchSpace::setMemoryBudget(qint64 value)
+{
+    QMutexLocker locker(&mMutex);
+    mMemoryBudget = mMemoryDir.isEmpty() ? 0 : qMax(qint64(0), value);
+}
+
+/************************************************
+ *
+ ************************************************/
+bool ScratchSpace::isIdle() const
+{
+    if (mMemoryUsed > 0) {
+        return false;
+    }
+
+    for (qint64 used : mDiskUsed) {
+        if (used > 0) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/************************************************
+ *
+ ************************************************/
+ScratchSpace::Reservation ScratchSpace::reserve(qint64 bytes, const QString &diskDir, bool allowMemory)
+{
+    QMutexLocker locker(&mMutex);
+    Reservation  res;
+
+    if (allowMemory && !mMemoryDir.isEmpty() && mMemoryUsed + bytes <= mMemoryBudget) {
+        mMemoryUsed += bytes;
+        res.location = Location::Memory;
+        res.dir      = mMemoryDir;
+        res.bytes    = bytes;
+        qCDebug(LOG) << "Reserve" << bytes << "bytes in memory, used" << mMemoryUsed << "of" << mMemoryBudget;
+        return res;
+    }
+
+    QStorageInfo storage(diskDir);
+    qint64      &used = mDiskUsed[storage.rootPath()];
+    // bytesAvailable already excludes the files written so far,
+    // the used value is an upper bound, so we are on the safe side.
+    qint64 available = storage.isValid() ? storage.bytesAvailable() - DISK_RESERVE - used : 0;
+
+    if (bytes > available && !isIdle()) {
+        qCDebug(LOG) << "No space for" << bytes << "bytes in" << diskDir << "available" << available;
+        return res;
+    }
+
+    used += bytes;
+    res.location = Location::Disk;
+    res.dir      = storage.rootPath();
+    res.bytes    = bytes;
+    qCDebug(LOG) << "Reserve" << bytes << "bytes on" << res.dir << "used" << used;
+    return res;
+}
+
+/************************************************
+ *
+ ************************************************/
+void ScratchSpace::release(Reservation *reservation, qint64 bytes)
+{
+    QMutexLocker locker(&mMutex);
+    bytes = qBound(qint64(0), bytes, reservation->bytes);
+    reservation->bytes -= bytes;
+
+    switch (reservation->location) {
+        case Location::Memory:
+            mMemoryUsed -= bytes;
+            break;
+
+        case Location::Disk:
+            mDiskUsed[reservation->dir] -= bytes;
+            break;
+
+        case Location::None:
+            break;
+    }
+
+    if (reservation->bytes == 0) {
+        reservation->location = Location::None;
+    }
+}
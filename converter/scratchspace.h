@@ -0,0 +1,89 @@
+/* BEGIN_COMMON_COPYRIGHT_HEADER
+ * (c)LGPL2+
+ *
+ * Flacon - audio File Encoder
+ * https://github.com/flacon/flacon
+ *
+ * Copyright: 2024
+ *   Alexander Sokoloff <sokoloff.a@gmail.com>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * END_COMMON_COPYRIGHT_HEADER */
+
+#ifndef SCRATCHSPACE_H
+#define SCRATCHSPACE_H
+
+#include <QString>
+#include <QMap>
+#include <QMutex>
+
+namespace Conv {
+
+/************************************************
+ * Accounts the space taken by the split WAV files.
+ *
+ * A disc is split into RAM (tmpfs) when its tracks
+ * fit into the memory budget, otherwise into the
+ * work directory on disk. When neither has room,
+ * the reservation fails and the splitter waits
+ * until the encoders release some files. If
+ * nothing is reserved, nobody would release the
+ * space, so the disk reservation always succeeds.
+ ************************************************/
+class ScratchSpace
+{
+public:
+    enum class Location {
+        None,
+        Memory,
+        Disk,
+    };
+
+    struct Reservation
+    {
+        Location location = Location::None;
+        QString  dir; // The memory directory or the mount point of the disk
+        qint64   bytes = 0;
+    };
+
+    static ScratchSpace *instance();
+
+    QString memoryDir() const { return mMemoryDir; }
+    qint64  memoryBudget() const { return mMemoryBudget; }
+    void    setMemoryBudget(qint64 value);
+
+    // Free disk space we never use for the scratch files.
+    static constexpr qint64 DISK_RESERVE = 512 * 1024 * 1024;
+
+    Reservation reserve(qint64 bytes, const QString &diskDir, bool allowMemory = true);
+    void        release(Reservation *reservation, qint64 bytes);
+    void        releaseAll(Reservation *reservation) { release(reservation, reservation->bytes); }
+
+private:
+    ScratchSpace();
+
+    bool isIdle() const;
+
+    mutable QMutex        mMutex;
+    QString               mMemoryDir;
+    qint64                mMemoryBudget = 0;
+    qint64                mMemoryUsed   = 0;
+    QMap<QString, qint64> mDiskUsed;
+};
+
+} // namespace Conv
+
+#endif // SCRATCHSPACE_H
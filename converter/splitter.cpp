@@ -26,9 +26,11 @@
 #include "splitter.h"
 #include "disc.h"
 #include "decoder.h"
+#include "verifier.h"
 #include <QDebug>
 #include <QLoggingCategory>
 #include <QFile>
+#include <QCryptographicHash>
 
 namespace {
 Q_LOGGING_CATEGORY(LOG, "Splitter")
@@ -36,6 +38,39 @@ Q_LOGGING_CATEGORY(LOG, "Splitter")
 
 using namespace Conv;
 
+/************************************************
+ * Passes all written data to the ReplayGain,
+ * the PCM checksum and the AccurateRip CRC
+ ************************************************/
+class TrackFile : public QFile
+{
+public:
+    explicit TrackFile(const QString &name) :
+        QFile(name) { }
+
+    ReplayGain::TrackGain *gain    = nullptr;
+    QCryptographicHash    *pcmHash = nullptr;
+    AccurateRip::TrackCrc *crc     = nullptr;
+
+protected:
+    qint64 writeData(const char *data, qint64 len) override
+    {
+        qint64 res = QFile::writeData(data, len);
+        if (gain && res > 0) {
+            gain->add(data, res);
+        }
+
+        if (pcmHash && res > 0) {
+            pcmHash->addData(data, int(res));
+        }
+
+        if (crc && res > 0) {
+            crc->add(data, res);
+        }
+        return res;
+    }
+};
+
 struct Splitter::Job
 {
     struct Chunk
@@ -49,11 +84,13 @@ struct Splitter::Job
     const Disc     *disk = nullptr;
     Conv::ConvTrack track;
     QList<Chunk>    chunks;
+    QList<Chunk>    pregapChunks;
     QString         outFileName;
     bool            isPregap = false;
 
     Job(const Disc *disk, Conv::ConvTrack track, bool addPregap, bool addTrack, bool addPostgap);
     QList<Chunk>   getPart(const CueIndex &from, const CueIndex &to) const;
+    static quint64 bytesCount(const QList<Chunk> &chunks);
     void           merge();
     InputAudioFile getInputAudioFile(const QByteArray &fileTag) const;
 };
@@ -69,7 +106,8 @@ Splitter::Job::Job(const Disc *disk, Conv::ConvTrack track, bool addPregap, bool
     const Track next = (cur.index() + 1 < disk->count()) ? *(disk->track(cur.index() + 1)) : Track();
 
     if (addPregap) {
-        chunks << getPart(cur.cueIndex(0), cur.cueIndex(1));
+        pregapChunks = getPart(cur.cueIndex(0), cur.cueIndex(1));
+        chunks << pregapChunks;
     }
 
     if (addTrack) {
@@ -130,6 +168,18 @@ QList<Splitter::Job::Chunk> Splitter::Job::getPart(const CueIndex &from, const C
     return { first, second };
 }
 
+/************************************************
+ *
+ ************************************************/
+quint64 Splitter::Job::bytesCount(const QList<Chunk> &chunks)
+{
+    quint64 res = 0;
+    for (const Chunk &chunk : chunks) {
+        res += chunk.decoder->bytesCount(chunk.start, chunk.end);
+    }
+    return res;
+}
+
 /************************************************
  *
  ************************************************/
@@ -257,15 +307,49 @@ void Splitter::run()
         for (Job::Chunk &chunk : job.chunks) {
             chunk.decoder = decoders.value(chunk.file.filePath());
         }
+
+        for (Job::Chunk &chunk : job.pregapChunks) {
+            chunk.decoder = decoders.value(chunk.file.filePath());
+        }
     }
 
+    // ******************************************
+    // The AccurateRip CRCs are defined for CD audio only,
+    // the CTDB CRC needs all tracks of the disc.
+    bool cdQuality = true;
+    for (const Decoder *decoder : std::as_const(decoders)) {
+        cdQuality = cdQuality && decoder->wavHeader().isCdQuality();
+    }
+    const bool crcEnabled = mAccurateRipEnabled && cdQuality;
+
+    quint64 discBytes = 0;
+    int     discJobs  = 0;
+    for (const Job &job : jobs) {
+        if (!job.isPregap) {
+            discBytes += Job::bytesCount(job.chunks) - Job::bytesCount(job.pregapChunks);
+            discJobs++;
+        }
+    }
+
+    const bool           discCrcEnabled = crcEnabled && discJobs == mDisc->count();
+    AccurateRip::DiscCrc discCrc(discBytes);
+
     // ******************************************
     // Decode data
     for (const Job &job : jobs) {
         try {
-            processTrack(job);
+            const quint64         pregapBytes = Job::bytesCount(job.pregapChunks);
+            AccurateRip::TrackCrc crc(pregapBytes, Job::bytesCount(job.chunks) - pregapBytes, job.track.index() == 0, job.track.index() == mDisc->count() - 1);
+            crc.setDiscCrc(discCrcEnabled ? &discCrc : nullptr);
+
+            QByteArray         pcmChecksum;
+            ReplayGain::Result gain = processTrack(job, &pcmChecksum, (crcEnabled && !job.isPregap) ? &crc : nullptr);
             qCDebug(LOG) << "Splitter trackReady:" << job.track << job.outFileName;
-            emit trackReady(job.track, job.outFileName);
+            emit trackReady(job.track, job.outFileName, gain, pcmChecksum);
+
+            if (crcEnabled && !job.isPregap) {
+                emit trackCrcReady(job.track, crc.v1(), crc.v2(), crc.crc32());
+            }
         }
         catch (FlaconError &err) {
             if (job.isPregap) {
@@ -280,6 +364,10 @@ void Splitter::run()
             return;
         }
     }
+
+    if (discCrcEnabled) {
+        emit discCrcReady(discCrc.result());
+    }
 }
 
 struct ProgressCalc
@@ -293,24 +381,34 @@ struct ProgressCalc
 /************************************************
  *
  ************************************************/
-void Splitter::processTrack(const Job &job)
+ReplayGain::Result Splitter::processTrack(const Job &job, QByteArray *pcmChecksum, AccurateRip::TrackCrc *crc)
 {
 
-    emit trackProgress(job.track, TrackState::Splitting, 0);
+    const int trackId = job.track.id();
+
+    startProgress(trackId, TrackState::Splitting);
 
-    QFile outFile(job.outFileName);
+    ReplayGain::TrackGain trackGain;
+
+    TrackFile outFile(job.outFileName);
+    outFile.gain = mGainEnabled ? &trackGain : nullptr;
     if (!outFile.open(QFile::WriteOnly)) {
         throw outFile.errorString();
     }
 
-    uint32_t bytes = 0;
+    quint64 bytes = 0;
     for (const Job::Chunk &chunk : job.chunks) {
         bytes += chunk.decoder->bytesCount(chunk.start, chunk.end);
     }
 
     WavHeader hdr = job.chunks.first().decoder->wavHeader();
     hdr.resizeData(bytes);
-    outFile.write(hdr.toLegacyWav());
+    outFile.write(hdr.toWav());
+
+    // The header is not hashed, the encoders write their own.
+    QCryptographicHash pcmHash(Verifier::ALGORITHM);
+    outFile.pcmHash = mVerifyEnabled ? &pcmHash : nullptr;
+    outFile.crc     = crc;
 
     ProgressCalc progress;
     progress.totalSize = bytes;
@@ -321,9 +419,9 @@ void Splitter::processTrack(const Job &job)
 
             // Extract chunk .............................
             QObject keeper;
-            connect(chunk.decoder, &Decoder::progress, &keeper, [this, job, progress](int percents) {
+            connect(chunk.decoder, &Decoder::progress, &keeper, [this, trackId, progress](int percents) {
                 double chunkDone = double(percents) / 100 * progress.chunkSize;
-                emit   trackProgress(job.track, TrackState::Splitting, (progress.done + chunkDone) / progress.totalSize * 100);
+                setProgress(trackId, TrackState::Splitting, (progress.done + chunkDone) / progress.totalSize * 100);
             });
             progress.done += progress.chunkSize;
 
@@ -336,5 +434,11 @@ void Splitter::processTrack(const Job &job)
     }
 
     outFile.close();
-    emit trackProgress(job.track, TrackState::Splitting, 100);
+    setProgress(trackId, TrackState::Splitting, 100);
+
+    if (mVerifyEnabled) {
+        *pcmChecksum = pcmHash.result();
+    }
+
+    return trackGain.result();
 }
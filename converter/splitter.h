@@ -29,6 +29,8 @@
 #include "convertertypes.h"
 #include "worker.h"
 #include "profiles.h"
+#include "replaygain.h"
+#include "accuraterip.h"
 
 namespace Conv {
 
@@ -41,11 +43,25 @@ public:
     PreGapType pregapType() const { return mPregapType; }
     void       setPregapType(const PreGapType &pregapType);
 
+    /// Calculate the track ReplayGain while the track is being written.
+    bool isGainEnabled() const { return mGainEnabled; }
+    void setGainEnabled(bool value) { mGainEnabled = value; }
+
+    /// Calculate the checksum of the track PCM data for the output verification.
+    bool isVerifyEnabled() const { return mVerifyEnabled; }
+    void setVerifyEnabled(bool value) { mVerifyEnabled = value; }
+
+    /// Calculate the AccurateRip and the CTDB CRCs of the CD quality tracks.
+    bool isAccurateRipEnabled() const { return mAccurateRipEnabled; }
+    void setAccurateRipEnabled(bool value) { mAccurateRipEnabled = value; }
+
 public slots:
     void run() override;
 
 signals:
-    void trackReady(const Conv::ConvTrack &track, const QString &outFileName);
+    void trackReady(const Conv::ConvTrack &track, const QString &outFileName, const ReplayGain::Result &trackGain, const QByteArray &pcmChecksum);
+    void trackCrcReady(const Conv::ConvTrack &track, quint32 accurateRipV1, quint32 accurateRipV2, quint32 crc32);
+    void discCrcReady(quint32 ctdbCrc);
 
 private:
     struct Job;
@@ -53,9 +69,12 @@ private:
     const Disc      *mDisc = nullptr;
     const ConvTracks mTracks;
     const QString    mOutDir;
-    PreGapType       mPregapType = PreGapType::AddToFirstTrack;
+    PreGapType       mPregapType         = PreGapType::AddToFirstTrack;
+    bool             mGainEnabled        = false;
+    bool             mVerifyEnabled      = false;
+    bool             mAccurateRipEnabled = false;
 
-    void processTrack(const Job &job);
+    ReplayGain::Result processTrack(const Job &job, QByteArray *pcmChecksum, AccurateRip::TrackCrc *crc);
 };
 
 } // namespace
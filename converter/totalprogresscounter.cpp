@@ -42,18 +42,34 @@ TotalProgressCounter::TotalProgressCounter(QObject *parent) :
  ************************************************/
 void TotalProgressCounter::init(const Conv::Converter &converter)
 {
-    mTotalDuration = 0.0;
-    mResult        = 0.0;
-
+    QList<Track> tracks;
     for (const DiscPipeline *pipline : converter.diskPiplines()) {
         for (const Track &track : pipline->tracks()) {
-            TrackData data;
+            tracks << track;
+        }
+    }
 
-            data.duration = track.duration();
-            mTotalDuration += data.duration;
+    init(tracks);
+}
 
-            mTracks.insert(Key(track.disc(), track.index()), data);
-        }
+/************************************************
+ *
+ ************************************************/
+void TotalProgressCounter::init(const QList<Track> &tracks)
+{
+    mTracks.clear();
+    mTotalDuration = 0;
+    mDone          = 0;
+    mResult        = 0.0;
+    mTimer.start();
+
+    for (const Track &track : tracks) {
+        TrackData data;
+
+        data.duration = track.duration();
+        mTotalDuration += data.duration;
+
+        mTracks.insert(Key(track.disc(), track.index()), data);
     }
 }
 
@@ -62,21 +78,88 @@ void TotalProgressCounter::init(const Conv::Converter &converter)
  ************************************************/
 void TotalProgressCounter::setTrackProgress(const Track &track, TrackState state, int percent)
 {
-    if (state != TrackState::Encoding) {
+    auto it = mTracks.find(Key(track.disc(), track.index()));
+    if (it == mTracks.end()) {
         return;
     }
 
-    mTracks[Key(track.disc(), track.index())].percent = percent;
+    switch (state) {
+        case TrackState::Splitting:
+            it->started = true;
+            return;
+
+        case TrackState::Encoding:
+            it->started = true;
+            break;
 
-    Duration done = 0;
-    for (const TrackData &data : mTracks) {
-        done += data.duration * data.percent;
+        case TrackState::OK:
+            // The track was done by a previous run, it's not a part of this one
+            if (!it->started) {
+                mTotalDuration -= it->duration;
+                mTracks.erase(it);
+                updateResult();
+                return;
+            }
+            percent = 100;
+            break;
+
+        // The failed track won't be finished, so it isn't a part of the total
+        case TrackState::Error:
+        case TrackState::Aborted:
+        case TrackState::Canceled:
+            mDone -= qint64(it->duration) * it->percent;
+            mTotalDuration -= it->duration;
+            mTracks.erase(it);
+            updateResult();
+            return;
+
+        default:
+            return;
     }
 
+    // Only the difference is added, so the cost doesn't depend on the number of tracks
+    mDone += qint64(it->duration) * (percent - it->percent);
+    it->percent = percent;
+    updateResult();
+}
+
+/************************************************
+ *
+ ************************************************/
+void TotalProgressCounter::updateResult()
+{
     double prev = mResult;
-    mResult     = double(done) / mTotalDuration;
+    mResult     = mTotalDuration ? double(mDone) / mTotalDuration : 100.0;
 
     if (int(prev * 10) != int(mResult * 10)) {
-        emit changed(mResult);
+        emit changed(mResult, throughput(), eta());
+    }
+}
+
+/************************************************
+ *
+ ************************************************/
+double TotalProgressCounter::throughput() const
+{
+    qint64 elapsed = mTimer.isValid() ? mTimer.elapsed() : 0;
+    if (elapsed <= 0) {
+        return 0.0;
     }
+
+    // mDone is in milliseconds multiplied by percents
+    return double(mDone) / 100.0 / elapsed;
+}
+
+/************************************************
+ *
+ ************************************************/
+int TotalProgressCounter::eta() const
+{
+    double speed = throughput();
+    if (speed <= 0.0) {
+        return -1;
+    }
+
+    double left = double(mTotalDuration) * 100.0 - double(mDone);
+    return qRound(left / 100.0 / speed / 1000.0);
 }
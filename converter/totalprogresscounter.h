@@ -27,7 +27,8 @@
  * END_COMMON_COPYRIGHT_HEADER */
 
 #include <QObject>
-#include <QMap>
+#include <QHash>
+#include <QElapsedTimer>
 #include "track.h"
 #include "disc.h"
 
@@ -42,25 +43,37 @@ public:
     explicit TotalProgressCounter(QObject *parent = nullptr);
 
     void init(const Conv::Converter &converter);
+    void init(const QList<Track> &tracks);
     void setTrackProgress(const Track &track, TrackState state, int percent);
 
     double result() const { return mResult; }
 
+    /// Seconds of audio converted per second of the wall time.
+    double throughput() const;
+
+    /// Estimated time left in seconds, -1 if it's not known yet.
+    int eta() const;
+
 signals:
-    void changed(double percent);
+    void changed(double percent, double throughput, int eta);
 
 private:
     struct TrackData
     {
         Percent  percent  = 0;
         Duration duration = 0;
+        bool     started  = false;
     };
 
     using Key = std::pair<Disk *, TrackNum>;
-    QMap<Key, TrackData> mTracks;
+    QHash<Key, TrackData> mTracks;
+
+    Duration      mTotalDuration = 0;
+    qint64        mDone          = 0;
+    double        mResult        = 0.0;
+    QElapsedTimer mTimer;
 
-    Duration mTotalDuration = 0;
-    double   mResult        = 0.0;
+    void updateResult();
 };
 
 #endif // TOTALPROGRESSCOUNTER_H
@@ -0,0 +1,129 @@
+/* BEGIN_COMMON_COPYRIGHT_HEADER
+ * (c)LGPL2+
+ *
+ * Flacon - audio File Encoder
+ * https://github.com/flacon/flacon
+ *
+ * Copyright: 2024
+ *   Alexander Sokoloff <sokoloff.a@gmail.com>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * END_COMMON_COPYRIGHT_HEADER */
+
+#include "verifier.h"
+#include "decoder.h"
+#include "profiles.h"
+#include "formats_in/informat.h"
+#include "formats_out/outformat.h"
+#include <QLoggingCategory>
+
+namespace {
+Q_LOGGING_CATEGORY(LOG, "Verifier")
+}
+
+using namespace Conv;
+
+/************************************************
+ * Write-only device, all written data goes to the hash
+ ************************************************/
+class HashDevice : public QIODevice
+{
+public:
+    explicit HashDevice(QCryptographicHash *hash) :
+        mHash(hash) { }
+
+protected:
+    qint64 readData(char *, qint64) override { return -1; }
+    qint64 writeData(const char *data, qint64 len) override
+    {
+        mHash->addData(data, int(len));
+        return len;
+    }
+
+private:
+    QCryptographicHash *mHash;
+};
+
+/************************************************
+ *
+ ************************************************/
+Verifier::Verifier(const ConvTrack &track, const QString &fileName, const QByteArray &expected, QObject *parent) :
+    Worker(parent),
+    mTrack(track),
+    mFileName(fileName),
+    mExpected(expected)
+{
+}
+
+/************************************************
+ * The resampler and the deemphasis change the audio,
+ * the result can't be compared with the split file.
+ ************************************************/
+bool Verifier::isVerifiable(const Profile &profile, const ConvTrack &track)
+{
+    const OutFormat *format = profile.outFormat();
+    if (!format->options().testFlag(FormatOption::Lossless)) {
+        return false;
+    }
+
+    if (!InputFormat::allFileExts().contains("*." + format->ext())) {
+        return false;
+    }
+
+    const InputAudioFile &audio = track.audioFile();
+    if (calcQuality(audio.bitsPerSample(), profile.bitsPerSample(), format->maxBitPerSample()) != audio.bitsPerSample()) {
+        return false;
+    }
+
+    if (calcQuality(audio.sampleRate(), profile.sampleRate(), format->maxSampleRate()) != audio.sampleRate()) {
+        return false;
+    }
+
+    return !track.preEmphased();
+}
+
+/************************************************
+ *
+ ************************************************/
+void Verifier::run()
+{
+    QCryptographicHash hash(ALGORITHM);
+
+    try {
+        HashDevice device(&hash);
+        device.open(QIODevice::WriteOnly);
+
+        Decoder decoder;
+        decoder.open(mFileName);
+        decoder.extract(CueTime(), CueTime(), &device, false);
+        decoder.close();
+    }
+    catch (const FlaconError &err) {
+        qCWarning(LOG) << "Can't decode" << mFileName << err.what();
+        emit verifyFailed(mTrack, mFileName, tr("I can't verify <b>%1</b>:<br>%2", "Error message. %1 is a file name, %2 is a system error text.").arg(mFileName, err.what()));
+        return;
+    }
+
+    const QByteArray actual = hash.result();
+    if (actual != mExpected) {
+        qCWarning(LOG) << "Checksum mismatch" << mFileName << "expected" << mExpected.toHex() << "got" << actual.toHex();
+        emit verifyFailed(mTrack, mFileName, tr("The encoded file <b>%1</b> doesn't match the source audio.", "Error message. %1 is a file name.").arg(mFileName));
+        return;
+    }
+
+    qCDebug(LOG) << "Verified" << mFileName << actual.toHex();
+    emit trackVerified(mTrack, mFileName);
+}
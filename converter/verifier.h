@@ -0,0 +1,70 @@
+/* BEGIN_COMMON_COPYRIGHT_HEADER
+ * (c)LGPL2+
+ *
+ * Flacon - audio File Encoder
+ * https://github.com/flacon/flacon
+ *
+ * Copyright: 2024
+ *   Alexander Sokoloff <sokoloff.a@gmail.com>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * END_COMMON_COPYRIGHT_HEADER */
+
+#ifndef VERIFIER_H
+#define VERIFIER_H
+
+#include <QByteArray>
+#include <QCryptographicHash>
+#include "worker.h"
+
+class Profile;
+
+namespace Conv {
+
+/************************************************
+ * Decodes the encoded file and compares the MD5
+ * of its PCM data with the checksum the splitter
+ * calculated for the split track.
+ ************************************************/
+class Verifier : public Worker
+{
+    Q_OBJECT
+public:
+    static constexpr QCryptographicHash::Algorithm ALGORITHM = QCryptographicHash::Md5;
+
+    Verifier(const ConvTrack &track, const QString &fileName, const QByteArray &expected, QObject *parent = nullptr);
+
+    /// Only the lossless formats we can decode back are verifiable.
+    static bool isVerifiable(const Profile &profile, const ConvTrack &track);
+
+public slots:
+    void run() override;
+
+signals:
+    void trackVerified(const Conv::ConvTrack &track, const QString &fileName);
+
+    /// Only this track is failed, the other tracks of the disc aren't stopped.
+    void verifyFailed(const Conv::ConvTrack &track, const QString &fileName, const QString &message);
+
+private:
+    const ConvTrack  mTrack;
+    const QString    mFileName;
+    const QByteArray mExpected;
+};
+
+} // namespace
+
+#endif // VERIFIER_H
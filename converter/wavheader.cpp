@@ -34,10 +34,16 @@
 using namespace Conv;
 
 static const char *WAV_RIFF = "RIFF";
+static const char *WAV_RF64 = "RF64";
 static const char *WAV_WAVE = "WAVE";
+static const char *WAV_DS64 = "ds64";
 static const char *WAV_FMT  = "fmt ";
 static const char *WAV_DATA = "data";
 
+// The 32-bit size of the RF64 file, the actual size is in the ds64 chunk
+static constexpr quint32 RF64_UNKNOWN_SIZE = 0xFFFFFFFF;
+static constexpr quint32 DS64_CHUNK_SIZE   = 28;
+
 static const char                   *WAVE64_RIFF      = "riff";
 static const char                   *WAVE64_WAVE      = "wave";
 static const std::array<uint8_t, 16> WAVE64_GUID_RIFF = { 0x72, 0x69, 0x66, 0x66, 0x2E, 0x91, 0xCF, 0x11, 0xA5, 0xD6, 0x28, 0xDB, 0x04, 0xC1, 0x00, 0x00 };
@@ -267,8 +273,9 @@ WavHeader::WavHeader(QIODevice *stream) noexcept(false)
 
     mustRead(stream, tag, 4);
 
-    if (strcmp(tag, WAV_RIFF) == 0) {
+    if (strcmp(tag, WAV_RIFF) == 0 || strcmp(tag, WAV_RF64) == 0) {
         m64Bit = false;
+        mRf64  = strcmp(tag, WAV_RF64) == 0;
         readWavHeader(stream);
 
         return;
@@ -284,6 +291,47 @@ WavHeader::WavHeader(QIODevice *stream) noexcept(false)
     throw FlaconError("WAVE header is missing RIFF tag while processing file");
 }
 
+/************************************************
+ * The multichannel and high resolution streams
+ * use WAVE_FORMAT_EXTENSIBLE, the subformat GUID is
+ * KSDATAFORMAT_SUBTYPE_PCM or KSDATAFORMAT_SUBTYPE_IEEE_FLOAT
+ ************************************************/
+WavHeader::WavHeader(Format format, quint16 numChannels, quint32 sampleRate, quint16 bitsPerSample, quint64 dataSize, quint32 channelMask, quint16 validBitsPerSample)
+{
+    static const std::array<uint8_t, 14> SUBTYPE_TAIL = { 0x00, 0x00, 0x00, 0x00, 0x10, 0x00, 0x80, 0x00, 0x00, 0xAA, 0x00, 0x38, 0x9B, 0x71 };
+
+    if (validBitsPerSample == 0) {
+        validBitsPerSample = bitsPerSample;
+    }
+
+    const bool extensible = numChannels > 2 || bitsPerSample > 16 || channelMask != 0 || validBitsPerSample != bitsPerSample;
+
+    m64Bit         = true;
+    mFormat        = extensible ? Format_Extensible : format;
+    mNumChannels   = numChannels;
+    mSampleRate    = sampleRate;
+    mBitsPerSample = bitsPerSample;
+    mBlockAlign    = numChannels * bitsPerSample / 8;
+    mByteRate      = mBlockAlign * sampleRate;
+
+    if (extensible) {
+        mFmtSize            = FmtChunkExt;
+        mExtSize            = FmtChunkExt - FmtChunkMid;
+        mValidBitsPerSample = validBitsPerSample;
+        mChannelMask        = channelMask;
+
+        mSubFormat.clear();
+        mSubFormat << quint16(format);
+        for (const uint8_t &b : SUBTYPE_TAIL) {
+            mSubFormat += b;
+        }
+    }
+
+    mDataSize     = dataSize;
+    mDataStartPos = 16 + 8 + 16 + WAVE64_CHUNK_HEADER_SIZE + mFmtSize + WAVE64_CHUNK_HEADER_SIZE;
+    mFileSize     = mDataStartPos + mDataSize;
+}
+
 /************************************************
  * 52 49 46 46      RIFF
  * 24 B9 4D 02      file size - 8
@@ -301,10 +349,16 @@ WavHeader::WavHeader(QIODevice *stream) noexcept(false)
  * // Data
  *   64 61 74 61 	SubchunkID 		"data"
  *   00 B9 4D 02 	SubchunkSize
+ *
+ * The RF64 file has the same layout, the 64-bit
+ * sizes are stored in the ds64 chunk that follows
+ * the WAVE tag. See EBU Tech 3306.
  ************************************************/
 void WavHeader::readWavHeader(QIODevice *stream)
 {
-    this->mFileSize = readUInt32(stream) + 8;
+    this->mFileSize = quint64(readUInt32(stream)) + 8;
+
+    quint64 ds64DataSize = 0;
 
     FourCC waveTag;
     waveTag.load(stream);
@@ -322,7 +376,7 @@ void WavHeader::readWavHeader(QIODevice *stream)
         pos += 8;
 
         if (chunkId == WAV_DATA) {
-            this->mDataSize     = chunkSize;
+            this->mDataSize     = (mRf64 && chunkSize == RF64_UNKNOWN_SIZE) ? ds64DataSize : chunkSize;
             this->mDataStartPos = pos;
             return;
         }
@@ -331,7 +385,17 @@ void WavHeader::readWavHeader(QIODevice *stream)
             throw FlaconError(QString("[WAV] incorrect chunk size %1 at %2").arg(chunkSize).arg(pos - 4));
         }
 
-        if (chunkId == WAV_FMT) {
+        if (mRf64 && chunkId == WAV_DS64) {
+            if (chunkSize < DS64_CHUNK_SIZE) {
+                throw FlaconError("ds64 chunk in RF64 header hase incorrect length");
+            }
+
+            this->mFileSize = readUInt64(stream) + 8;
+            ds64DataSize    = readUInt64(stream);
+            mustRead(stream, chunkSize - 16); // Sample count and the table for other chunks
+            pos += chunkSize;
+        }
+        else if (chunkId == WAV_FMT) {
             loadFmtChunk(stream, chunkSize);
             pos += chunkSize;
         }
@@ -400,6 +464,19 @@ void WavHeader::readWave64Header(QIODevice *stream)
     throw FlaconError("data chunk not found");
 }
 
+/************************************************
+ * For WAVE_FORMAT_EXTENSIBLE the first two bytes
+ * of the subformat GUID are the data format code.
+ ************************************************/
+WavHeader::Format WavHeader::sampleFormat() const
+{
+    if (mFormat == Format_Extensible && mSubFormat.size() >= 2) {
+        return static_cast<Format>(qFromLittleEndian<quint16>(mSubFormat.constData()));
+    }
+
+    return mFormat;
+}
+
 /************************************************
  *
  ************************************************/
@@ -445,6 +522,29 @@ quint32 WavHeader::bytesPerSecond()
     return mNumChannels * mBitsPerSample * mSampleRate / 8;
 }
 
+/************************************************
+ * The layouts are the same as WAVEFORMATEXTENSIBLE
+ * defaults of the flac and wavpack programs:
+ * 4.0 and 5.x are the back surround, 6.1 has the
+ * back center and the side surround.
+ ************************************************/
+quint32 WavHeader::defaultChannelMask(quint16 numChannels)
+{
+    // clang-format off
+    switch (numChannels) {
+        case 1:  return 0x0004; // FC
+        case 2:  return 0x0003; // FL FR
+        case 3:  return 0x0007; // FL FR FC
+        case 4:  return 0x0033; // FL FR BL BR
+        case 5:  return 0x0037; // FL FR FC BL BR
+        case 6:  return 0x003F; // FL FR FC LFE BL BR
+        case 7:  return 0x070F; // FL FR FC LFE BC SL SR
+        case 8:  return 0x063F; // FL FR FC LFE BL BR SL SR
+    }
+    // clang-format on
+    return 0;
+}
+
 /************************************************
  *
  ************************************************/
@@ -523,7 +623,7 @@ QByteArray WavHeader::toByteArray() const
         return wave64ToByteArray();
     }
     else {
-        return wavToByteArray(true);
+        return wavToByteArray(true, mRf64);
     }
 }
 
@@ -532,7 +632,32 @@ QByteArray WavHeader::toByteArray() const
  ************************************************/
 QByteArray WavHeader::toLegacyWav() const
 {
-    return wavToByteArray(false);
+    return wavToByteArray(false, false);
+}
+
+/************************************************
+ * The largest fmt chunk is assumed, so the choice
+ * doesn't depend on the source header.
+ ************************************************/
+QByteArray WavHeader::toWav() const
+{
+    static constexpr quint64 MAX_LEGACY_HEADER_SIZE = 12 + 8 + FmtChunkExt + 8;
+
+    const bool fits = mDataSize + MAX_LEGACY_HEADER_SIZE - 8 <= 0xFFFFFFFF;
+    return wavToByteArray(false, !fits);
+}
+
+/************************************************
+ *
+ ************************************************/
+QByteArray WavHeader::toUnsizedWav() const
+{
+    QByteArray res = wavToByteArray(false, true);
+
+    // Drop the ds64 chunk, the header becomes RIFF
+    res.remove(12, 8 + DS64_CHUNK_SIZE);
+    res.replace(0, 4, WAV_RIFF);
+    return res;
 }
 
 /************************************************
@@ -552,15 +677,27 @@ QByteArray WavHeader::toLegacyWav() const
  * // Data
  *   64 61 74 61 	SubchunkID 		"data"
  *   00 B9 4D 02 	SubchunkSize
+ *
+ * For RF64 the 32-bit sizes are 0xFFFFFFFF, the
+ * actual sizes are in the ds64 chunk.
  ************************************************/
-QByteArray WavHeader::wavToByteArray(bool keepOtherChunks) const
+QByteArray WavHeader::wavToByteArray(bool keepOtherChunks, bool rf64) const
 {
     QByteArray res;
     res.reserve(mDataStartPos - 1);
-    res << WAV_RIFF;
+    res << (rf64 ? WAV_RF64 : WAV_RIFF);
     res << quint32(0);
     res << WAV_WAVE;
 
+    if (rf64) {
+        res << WAV_DS64;
+        res << DS64_CHUNK_SIZE;
+        res << quint64(0); // RIFF size
+        res << quint64(mDataSize);
+        res << quint64(mBlockAlign ? mDataSize / mBlockAlign : 0); // Sample count
+        res << quint32(0);                                         // Table length
+    }
+
     res << WAV_FMT;
     res << quint32(mFmtSize);
     res << quint16(mFormat);
@@ -585,20 +722,21 @@ QByteArray WavHeader::wavToByteArray(bool keepOtherChunks) const
     }
 
     res << WAV_DATA;
-    res << quint32(mDataSize);
+    res << quint32(rf64 ? RF64_UNKNOWN_SIZE : mDataSize);
 
     // Write file size .........
     quint64 fileSize = mDataSize + res.size() - 8;
+    if (rf64) {
+        qToLittleEndian<quint32>(RF64_UNKNOWN_SIZE, res.data() + 4);
+        qToLittleEndian<quint64>(fileSize, res.data() + 20);
+        return res;
+    }
+
     if (fileSize > 0xFFFFFFFF) {
         throw FlaconError("Stream is too big to fit in a legacy WAVE file");
     }
 
-    qint32 le = qToLittleEndian(quint32(fileSize));
-    res[4]    = (le >> 0) & 0xFF;
-    res[5]    = (le >> 8) & 0xFF;
-    res[6]    = (le >> 16) & 0xFF;
-    res[7]    = (le >> 24) & 0xFF;
-
+    qToLittleEndian<quint32>(quint32(fileSize), res.data() + 4);
     return res;
 }
 
@@ -647,7 +785,7 @@ QByteArray WavHeader::wave64ToByteArray() const
 /************************************************
  *
  ************************************************/
-void WavHeader::resizeData(quint32 dataSize)
+void WavHeader::resizeData(quint64 dataSize)
 {
     mDataSize = dataSize;
     mFileSize = mDataStartPos + mDataSize;
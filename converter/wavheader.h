@@ -75,6 +75,10 @@ public:
     WavHeader() = default;
     explicit WavHeader(QIODevice *stream) noexcept(false);
 
+    /// Creates the Wave64 header for the stream with the given parameters.
+    /// The zero validBitsPerSample means all bits of the sample are valid.
+    WavHeader(Format format, quint16 numChannels, quint32 sampleRate, quint16 bitsPerSample, quint64 dataSize, quint32 channelMask = 0, quint16 validBitsPerSample = 0);
+
     WavHeader(const WavHeader &other) = default;
     WavHeader &operator=(const WavHeader &other) = default;
 
@@ -84,13 +88,24 @@ public:
     QByteArray toByteArray() const;
     QByteArray toLegacyWav() const;
 
-    void resizeData(quint32 dataSize);
+    /// The legacy WAV header if the stream fits in 4 GiB, the RF64 header otherwise.
+    QByteArray toWav() const;
+
+    /// The legacy WAV header with unknown sizes, for the programs that
+    /// don't read RF64, they read the stream to the end.
+    QByteArray toUnsizedWav() const;
+
+    void resizeData(quint64 dataSize);
 
     static quint32 bytesPerSecond(Quality quality);
+
+    /// The speaker mask of the default WAVE channel order, used when the stream has no mask.
+    static quint32 defaultChannelMask(quint16 numChannels);
     quint32        bytesPerSecond();
 
     quint64 fileSize() const { return mFileSize; }
     Format  format() const { return mFormat; }
+    Format  sampleFormat() const;
     quint16 numChannels() const { return mNumChannels; }
     quint32 sampleRate() const { return mSampleRate; }
     quint32 byteRate() const { return mByteRate; }
@@ -102,6 +117,7 @@ public:
     quint64 dataStartPos() const { return mDataStartPos; }
     bool    isCdQuality() const;
     bool    is64Bit() const { return m64Bit; }
+    bool    isRf64() const { return mRf64; }
 
 protected:
     enum FmtChunkSize {
@@ -111,6 +127,7 @@ protected:
     };
 
     bool         m64Bit              = false;
+    bool         mRf64               = false;
     quint64      mFileSize           = 0;
     FmtChunkSize mFmtSize            = FmtChunkMin;
     Format       mFormat             = WavHeader::Format_Unknown;
@@ -134,7 +151,7 @@ private:
     void readWavHeader(QIODevice *stream);
     void readWave64Header(QIODevice *stream);
 
-    QByteArray wavToByteArray(bool keepOtherChunks) const;
+    QByteArray wavToByteArray(bool keepOtherChunks, bool rf64) const;
     QByteArray wave64ToByteArray() const;
 };
 
@@ -58,3 +58,27 @@ bool Worker::deleteFile(const QString &fileName) const
     else
         return true;
 }
+
+/************************************************
+ * The state changes always go through the signal
+ ************************************************/
+void Worker::startProgress(int trackId, TrackState state)
+{
+    if (mProgressBoard) {
+        mProgressBoard->setPercent(trackId, mProgressSlot, 0);
+    }
+    emit trackProgress(trackId, state, 0);
+}
+
+/************************************************
+
+ ************************************************/
+void Worker::setProgress(int trackId, TrackState state, int percent)
+{
+    if (mProgressBoard) {
+        mProgressBoard->setPercent(trackId, mProgressSlot, percent);
+    }
+    else {
+        emit trackProgress(trackId, state, percent);
+    }
+}
@@ -28,12 +28,37 @@
 
 #include "convertertypes.h"
 #include <QObject>
+#include <QSharedPointer>
+#include <atomic>
+#include <vector>
 #include "track.h"
 
 class Disc;
 
 namespace Conv {
 
+/************************************************
+ * The workers store the percents of the tracks
+ * here, the pipeline samples them by the timer.
+ * Every track has a slot per output, the encoders
+ * of different profiles work on the same track
+ * at the same time.
+ ************************************************/
+class ProgressBoard
+{
+public:
+    ProgressBoard(int count, int slots) :
+        mSlots(slots),
+        mPercents(count * slots) { }
+
+    int  percent(int trackId, int slot) const { return mPercents[trackId * mSlots + slot].load(std::memory_order_relaxed); }
+    void setPercent(int trackId, int slot, int percent) { mPercents[trackId * mSlots + slot].store(percent, std::memory_order_relaxed); }
+
+private:
+    const int                     mSlots;
+    std::vector<std::atomic<int>> mPercents;
+};
+
 class Worker : public QObject
 {
     Q_OBJECT
@@ -41,15 +66,29 @@ public:
     explicit Worker(QObject *parent = nullptr);
     virtual ~Worker();
 
+    /// Without the board every percent change is emitted as the trackProgress signal.
+    void setProgressBoard(const QSharedPointer<ProgressBoard> &board, int slot = 0)
+    {
+        mProgressBoard = board;
+        mProgressSlot  = slot;
+    }
+
 public slots:
     virtual void run() = 0;
 
 signals:
     void error(const Conv::ConvTrack &track, const QString &message);
-    void trackProgress(const Conv::ConvTrack &track, TrackState state, int percent);
+    void trackProgress(int trackId, TrackState state, int percent);
 
 protected:
     bool deleteFile(const QString &fileName) const;
+
+    void startProgress(int trackId, TrackState state);
+    void setProgress(int trackId, TrackState state, int percent);
+
+private:
+    QSharedPointer<ProgressBoard> mProgressBoard;
+    int                           mProgressSlot = 0;
 };
 
 } // namespace
@@ -36,6 +36,7 @@
 #include "inputaudiofile.h"
 #include "formats_in/informat.h"
 #include <QBuffer>
+#include <memory>
 
 /************************************************
  *
@@ -53,7 +54,9 @@ static void splitTitle(TrackTags *track, char separator)
  ************************************************/
 Cue::Cue(const QString &fileName) noexcept(false)
 {
-    CueData data(fileName);
+    // The scanner has usually parsed the file already
+    std::unique_ptr<CueData> prefetched(UcharDet::takePrefetched(fileName));
+    const CueData            data = prefetched ? std::move(*prefetched) : CueData(fileName);
     if (data.isEmpty()) {
         throw CueError(QObject::tr("<b>%1</b> is not a valid CUE file. The CUE sheet has no FILE tag.").arg(fileName));
     }
@@ -245,9 +248,7 @@ void Cue::setCodecName(const CueData &data)
     }
     else {
         UcharDet charDet;
-        foreach (const TrackTags &track, mTracks) {
-            charDet << track;
-        }
+        charDet << data;
 
         codec = TextCodec::codecForName(charDet.textCodecName());
     }
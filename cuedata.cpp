@@ -28,37 +28,220 @@
 #include <QFileInfo>
 #include <QFile>
 #include <QDebug>
+#include <cstring>
+#include <algorithm>
 #include "types.h"
 
+namespace {
+
+/************************************************
+ * Non-owning view on the part of the CUE buffer.
+ ************************************************/
+struct Span
+{
+    const char *begin = nullptr;
+    const char *end   = nullptr;
+
+    bool isEmpty() const { return begin == end; }
+    int  length() const { return int(end - begin); }
+
+    QByteArray toByteArray() const { return QByteArray(begin, length()); }
+
+    static bool isSpace(char c) { return c == ' ' || c == '\t' || c == '\n' || c == '\v' || c == '\f' || c == '\r'; }
+
+    Span trimmed() const
+    {
+        Span res = *this;
+        while (res.begin < res.end && isSpace(*res.begin)) {
+            res.begin++;
+        }
+
+        while (res.end > res.begin && isSpace(*(res.end - 1))) {
+            res.end--;
+        }
+        return res;
+    }
+
+    const char *find(char c) const
+    {
+        const void *p = memchr(begin, c, length());
+        return p ? static_cast<const char *>(p) : nullptr;
+    }
+
+    Span leftPart(char separator) const
+    {
+        const char *p = find(separator);
+        return { begin, p ? p : end };
+    }
+
+    Span rightPart(char separator) const
+    {
+        const char *p = find(separator);
+        return p ? Span { p + 1, end } : Span { end, end };
+    }
+
+    Span unQuote() const
+    {
+        if (length() > 2 && (*begin == '"' || *begin == '\'') && *begin == *(end - 1)) {
+            return { begin + 1, end - 1 };
+        }
+        return *this;
+    }
+
+    bool equalsUpper(const char *str) const
+    {
+        const char *p = begin;
+        for (; *str; ++str, ++p) {
+            if (p == end || (*p & ~0x20) != *str) {
+                return false;
+            }
+        }
+        return p == end;
+    }
+};
+
+/************************************************
+ * Most tag names are known in advance, we share
+ * one copy of each instead of allocating per line.
+ ************************************************/
+QByteArray internTag(const Span &span)
+{
+    static const QList<QByteArray> knownTags = {
+        "CATALOG", "CDTEXTFILE", "COMMENT", "DATE", "DISCID", "DISCNUMBER",
+        "FILE", "FLAGS", "GENRE", "INDEX", "ISRC", "PERFORMER", "POSTGAP",
+        "PREGAP", "REM", "SONGWRITER", "TITLE", "TOTALDISCS", "TRACK"
+    };
+
+    for (const QByteArray &tag : knownTags) {
+        if (span.equalsUpper(tag.constData())) {
+            return tag;
+        }
+    }
+
+    return span.toByteArray().toUpper();
+}
+
 /************************************************
  *
  ************************************************/
-static QByteArray unQuote(const QByteArray &line)
+const QByteArray &indexTag(int num)
 {
-    if (line.length() > 2 && (line.at(0) == '"' || line.at(0) == '\'') && line.at(0) == line.at(line.length() - 1)) {
-        return line.mid(1, line.length() - 2);
+    static const QVector<QByteArray> tags = []() {
+        QVector<QByteArray> res;
+        for (int i = 0; i < 100; ++i) {
+            res << QString("%1 %2").arg(CueData::INDEX_TAG).arg(i, 2, 10, QChar('0')).toLatin1();
+        }
+        return res;
+    }();
+
+    return tags.at(num);
+}
+
+/************************************************
+ *
+ ************************************************/
+const QByteArray &indexFileTag(int num)
+{
+    static const QVector<QByteArray> tags = []() {
+        QVector<QByteArray> res;
+        for (int i = 0; i < 100; ++i) {
+            res << indexTag(i) + " FILE";
+        }
+        return res;
+    }();
+
+    return tags.at(num);
+}
+
+/************************************************
+ *
+ ************************************************/
+QByteArray extractFileFromFileTag(const Span &value)
+{
+    const char *p = value.end;
+    while (p > value.begin && *(p - 1) != ' ') {
+        --p;
     }
-    return line;
+
+    if (p > value.begin)
+        return Span { value.begin, p - 1 }.unQuote().toByteArray();
+
+    return value.unQuote().toByteArray();
 }
 
 /************************************************
+ * Splits the buffer into the lines, the same way
+ * as QIODevice::readLine() does.
+ ************************************************/
+class LineReader
+{
+public:
+    LineReader(const char *begin, const char *end) :
+        mPos(begin),
+        mEnd(end)
+    {
+    }
+
+    bool atEnd() const { return mPos >= mEnd; }
+
+    Span readLine()
+    {
+        Span        res;
+        const void *p = memchr(mPos, '\n', mEnd - mPos);
+        res.begin     = mPos;
+        res.end       = p ? static_cast<const char *>(p) + 1 : mEnd;
+        mPos          = res.end;
+        return res;
+    }
 
+private:
+    const char *mPos;
+    const char *mEnd;
+};
+
+/************************************************
+ * The line is already trimmed and isn't empty
  ************************************************/
-static QByteArray extractFileFromFileTag(const QByteArray &value)
+void parseLine(const Span &line, QByteArray &tag, Span &value, const QString &fileName, uint lineNum)
 {
-    int n = value.lastIndexOf(' ');
-    if (n > -1)
-        return unQuote(value.left(n));
+    tag   = internTag(line.leftPart(' '));
+    value = line.rightPart(' ').trimmed();
+
+    if (tag == "REM") {
+        tag   = internTag(value.leftPart(' '));
+        value = value.rightPart(' ').trimmed();
+    }
 
-    return unQuote(value);
+    value = value.unQuote();
+
+    //=============================
+    if (tag == CueData::INDEX_TAG) {
+        bool ok;
+        int  num = value.leftPart(' ').toByteArray().toInt(&ok);
+        if (!ok)
+            throw FlaconError(QObject::tr("<b>%1</b> is not a valid CUE file. Incorrect track index on line %2.", "Cue parser error.")
+                                      .arg(fileName)
+                                      .arg(lineNum));
+
+        if (num < 0 || num > 99)
+            throw FlaconError(QObject::tr("<b>%1</b> is not a valid CUE file. Incorrect track index on line %2.", "Cue parser error.")
+                                      .arg(fileName)
+                                      .arg(lineNum));
+
+        tag   = indexTag(num);
+        value = value.rightPart(' ').trimmed();
+    }
 }
 
+} // namespace
+
 /************************************************
  *
  ************************************************/
 CueData::CueData(QIODevice *device) noexcept(false)
 {
-    read(device);
+    QByteArray buf = device->readAll();
+    read(buf.constData(), buf.constData() + buf.size());
 }
 
 /************************************************
@@ -77,7 +260,19 @@ CueData::CueData(const QString &fileName) :
         throw FlaconError(file.errorString());
     }
 
-    read(&file);
+    // We parse the file in place, falling back to reading when it can't be mapped.
+    const qint64 size = file.size();
+    const uchar *data = size > 0 ? file.map(0, size) : nullptr;
+    if (data) {
+        const char *begin = reinterpret_cast<const char *>(data);
+        read(begin, begin + size);
+        file.unmap(const_cast<uchar *>(data));
+    }
+    else {
+        QByteArray buf = file.readAll();
+        read(buf.constData(), buf.constData() + buf.size());
+    }
+
     file.close();
 }
 
@@ -85,25 +280,26 @@ CueData::CueData(const QString &fileName) :
  Complete CUE sheet syntax documentation
  https://github.com/flacon/flacon/blob/master/cuesheet_syntax.md
  ************************************************/
-void CueData::read(QIODevice *file)
+void CueData::read(const char *begin, const char *end)
 {
-    mBomCodec = detectBomCodec(file);
+    begin += skipBom(begin, end);
+    LineReader file(begin, end);
 
     uint       lineNum = 0;
     QByteArray tag;
-    QByteArray value;
+    Span       value;
     QByteArray audioFile;
 
     // Read global tags ..............................
-    while (!file->atEnd()) {
+    while (!file.atEnd()) {
         lineNum++;
-        QByteArray line = file->readLine().trimmed();
+        Span line = file.readLine().trimmed();
 
         if (line.isEmpty()) {
             continue;
         }
 
-        parseLine(line, tag, value, lineNum);
+        parseLine(line, tag, value, mFileName, lineNum);
 
         if (tag.isEmpty()) {
             continue;
@@ -118,29 +314,30 @@ void CueData::read(QIODevice *file)
             continue;
         }
 
-        mGlobalTags.insert(tag, value);
+        mGlobalTags.insert(tag, value.toByteArray());
     }
 
-    while (!file->atEnd()) {
-        bool ok;
+    while (!file.atEnd()) {
+        bool       ok;
+        QByteArray trackNum = value.leftPart(' ').toByteArray();
 
-        leftPart(value, ' ').toInt(&ok);
+        trackNum.toInt(&ok);
         if (!ok)
             throw FlaconError(QObject::tr("<b>%1</b> is not a valid CUE file. Incorrect track number on line %2.", "Cue parser error.")
                                       .arg(mFileName)
                                       .arg(lineNum));
 
         Tags track;
-        track.insert(TRACK_TAG, leftPart(value, ' '));
+        track.insert(TRACK_TAG, trackNum);
         track.insert(FILE_TAG, audioFile);
 
-        while (!file->atEnd()) {
+        while (!file.atEnd()) {
             lineNum++;
-            QByteArray line = file->readLine().trimmed();
+            Span line = file.readLine().trimmed();
             if (line.isEmpty())
                 continue;
 
-            parseLine(line, tag, value, lineNum);
+            parseLine(line, tag, value, mFileName, lineNum);
 
             if (tag.isEmpty())
                 continue;
@@ -153,12 +350,13 @@ void CueData::read(QIODevice *file)
                 continue;
             }
 
-            track.insert(tag, value);
+            track.insert(tag, value.toByteArray());
 
-            if (tag.startsWith(INDEX_TAG)) {
-                track.insert(tag + " FILE", audioFile);
+            // Only the "INDEX NN" tags have a space in the name
+            if (tag.startsWith(INDEX_TAG) && tag.length() == 8 && tag.at(5) == ' ') {
+                track.insert(indexFileTag((tag.at(6) - '0') * 10 + (tag.at(7) - '0')), audioFile);
 
-                if (tag.contains(" 01")) {
+                if (tag.endsWith(" 01")) {
                     track.insert(FILE_TAG, audioFile);
                 }
             }
@@ -168,69 +366,27 @@ void CueData::read(QIODevice *file)
 }
 
 /************************************************
- * Detect codepage and skip BOM
+ * Detect codepage, returns the length of the BOM
  ************************************************/
-TextCodec::BomCodec CueData::detectBomCodec(QIODevice *file)
+int CueData::skipBom(const char *begin, const char *end)
 {
-    QByteArray magic = file->read(3);
+    QByteArray magic = QByteArray::fromRawData(begin, int(std::min<qint64>(3, end - begin)));
 
     if (magic.startsWith("\xEF\xBB\xBF")) {
-        file->seek(3);
-        return TextCodec::BomCodec::UTF_8;
+        mBomCodec = TextCodec::BomCodec::UTF_8;
+        return 3;
     }
 
     if (magic.startsWith("\xFE\xFF")) {
-        file->seek(2);
-        return TextCodec::BomCodec::UTF_16BE;
+        mBomCodec = TextCodec::BomCodec::UTF_16BE;
+        return 2;
     }
 
     if (magic.startsWith("\xFF\xFE")) {
-        file->seek(2);
-        return TextCodec::BomCodec::UTF_16LE;
+        mBomCodec = TextCodec::BomCodec::UTF_16LE;
+        return 2;
     }
 
-    file->seek(0);
-    return TextCodec::BomCodec::Unknown;
-}
-
-/************************************************
- *
- ************************************************/
-void CueData::parseLine(const QByteArray &line, QByteArray &tag, QByteArray &value, uint lineNum) const
-{
-    QByteArray l = line.trimmed();
-
-    if (l.isEmpty()) {
-        tag   = "";
-        value = "";
-        return;
-    }
-
-    tag   = leftPart(l, ' ').toUpper();
-    value = rightPart(l, ' ').trimmed();
-
-    if (tag == "REM") {
-        tag   = leftPart(value, ' ').toUpper();
-        value = rightPart(value, ' ').trimmed();
-    }
-
-    value = unQuote(value);
-
-    //=============================
-    if (tag == INDEX_TAG) {
-        bool ok;
-        int  num = leftPart(value, ' ').toInt(&ok);
-        if (!ok)
-            throw FlaconError(QObject::tr("<b>%1</b> is not a valid CUE file. Incorrect track index on line %2.", "Cue parser error.")
-                                      .arg(mFileName)
-                                      .arg(lineNum));
-
-        if (num < 0 || num > 99)
-            throw FlaconError(QObject::tr("<b>%1</b> is not a valid CUE file. Incorrect track index on line %2.", "Cue parser error.")
-                                      .arg(mFileName)
-                                      .arg(lineNum));
-
-        tag   = QString("%1 %2").arg(INDEX_TAG).arg(num, 2, 10, QChar('0')).toLatin1();
-        value = rightPart(value, ' ').trimmed();
-    }
+    mBomCodec = TextCodec::BomCodec::Unknown;
+    return 0;
 }
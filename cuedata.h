@@ -61,9 +61,8 @@ private:
 
     TextCodec::BomCodec mBomCodec = TextCodec::BomCodec::Unknown;
 
-    void                read(QIODevice *device);
-    TextCodec::BomCodec detectBomCodec(QIODevice *file);
-    void                parseLine(const QByteArray &line, QByteArray &tag, QByteArray &value, uint lineNum) const;
+    void read(const char *begin, const char *end);
+    int  skipBom(const char *begin, const char *end);
 };
 
 #endif // CUEDATA_H
@@ -39,8 +39,6 @@
 #include <QBuffer>
 #include "textcodec.h"
 
-#define COVER_PREVIEW_SIZE 500
-
 /************************************************
 
  ************************************************/
@@ -71,9 +69,8 @@ void Disc::searchCoverImage(bool replaceExisting)
     }
 
     // Search cover ...................
-    QString dir        = QFileInfo(cueFilePath()).dir().absolutePath();
-    mCoverImagePreview = QImage();
-    mCoverImageFile    = searchCoverImage(dir);
+    QString dir     = QFileInfo(cueFilePath()).dir().absolutePath();
+    mCoverImageFile = searchCoverImage(dir);
 }
 
 /************************************************
@@ -157,7 +154,7 @@ void Disc::setCue(const Cue &cue)
         }
     }
 
-    Project::instance()->emitLayoutChanged();
+    Project::instance()->emitLayoutChanged(this);
     emit revalidateRequested();
 }
 
@@ -515,7 +512,7 @@ void Disc::activateTagSet(const QString &uri)
     syncTagsFromTracks();
     mCurrentTagsUri = uri;
     syncTagsToTracks();
-    Project::instance()->emitLayoutChanged();
+    Project::instance()->emitLayoutChanged(this);
 }
 
 /************************************************
@@ -549,23 +546,7 @@ void Disc::addTagSets(const QVector<Tracks> &discs)
  ************************************************/
 void Disc::setCoverImageFile(const QString &fileName)
 {
-    mCoverImageFile    = fileName;
-    mCoverImagePreview = QImage();
-}
-
-/************************************************
-
- ************************************************/
-QImage Disc::coverImagePreview() const
-{
-    if (!mCoverImageFile.isEmpty() && mCoverImagePreview.isNull()) {
-        mCoverImagePreview = coverImage();
-        if (!mCoverImagePreview.isNull()) {
-            mCoverImagePreview = mCoverImagePreview.scaled(COVER_PREVIEW_SIZE, COVER_PREVIEW_SIZE, Qt::KeepAspectRatio, Qt::SmoothTransformation);
-        }
-    }
-
-    return mCoverImagePreview;
+    mCoverImageFile = fileName;
 }
 
 /************************************************
@@ -90,7 +90,6 @@ public:
 
     QString coverImageFile() const { return mCoverImageFile; }
     void    setCoverImageFile(const QString &fileName);
-    QImage  coverImagePreview() const;
     QImage  coverImage() const;
 
     QString    discTag(TagId tagId) const;
@@ -125,8 +124,7 @@ private:
     InputAudioFile mAudioFile;
     mutable Track  mPreGapTrack;
 
-    QString        mCoverImageFile;
-    mutable QImage mCoverImagePreview;
+    QString mCoverImageFile;
 
     DiskState mState     = DiskState::NotRunning;
     QString   mCodecName = CODEC_AUTODETECT;
@@ -25,6 +25,10 @@
 
 #include "in_wv.h"
 
+#ifdef USE_LIBWAVPACK
+#include "wavpackdecoder.h"
+#endif
+
 REGISTER_INPUT_FORMAT(Format_Wv)
 
 /************************************************
@@ -51,3 +55,16 @@ QStringList Format_Wv::decoderArgs(const QString &fileName) const
 
     return args;
 }
+
+/************************************************
+ *
+ ************************************************/
+QIODevice *Format_Wv::createNativeDecoder(const QString &fileName) const
+{
+#ifdef USE_LIBWAVPACK
+    return new WavPackDecoder(fileName);
+#else
+    Q_UNUSED(fileName)
+    return nullptr;
+#endif
+}
@@ -39,6 +39,8 @@ public:
     ExtProgram         *decoderProgram() const override { return ExtProgram::wvunpack(); }
     virtual QStringList decoderArgs(const QString &fileName) const override;
 
+    QIODevice *createNativeDecoder(const QString &fileName) const override;
+
 protected:
     virtual bool checkMagic(const QByteArray &data) const override;
 };
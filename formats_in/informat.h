@@ -48,6 +48,10 @@ public:
     virtual ExtProgram *decoderProgram() const                     = 0;
     virtual QStringList decoderArgs(const QString &fileName) const = 0;
 
+    // The in-process decoder, returns nullptr if the format hasn't one.
+    // The device provides the WAVE stream, the caller takes ownership.
+    virtual QIODevice *createNativeDecoder(const QString &) const { return nullptr; }
+
     virtual QByteArray magic() const = 0;
     virtual uint       magicOffset() const { return 0; }
 
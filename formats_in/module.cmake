@@ -20,3 +20,28 @@ list(APPEND SOURCES
     ${CMAKE_CURRENT_LIST_DIR}/in_wave64.h
     ${CMAKE_CURRENT_LIST_DIR}/in_wave64.cpp
 )
+
+# libwavpack is shared by the WavPack decoder and encoder, see formats_out/wv/module.cmake
+option(USE_LIBWAVPACK "Decode and encode WavPack in-process with libwavpack when it's available" ON)
+if (USE_LIBWAVPACK)
+    find_package(PkgConfig)
+    pkg_search_module(WAVPACK wavpack>=5.0)
+endif()
+
+if (WAVPACK_FOUND)
+    message(STATUS "Using libwavpack version: ${WAVPACK_VERSION}")
+    add_definitions(-DUSE_LIBWAVPACK)
+    include_directories(${WAVPACK_INCLUDE_DIRS})
+    link_directories(${WAVPACK_LIBRARY_DIRS})
+    list(APPEND NATIVE_ENCODERS_LIBRARIES ${WAVPACK_LIBRARIES})
+
+    # The multithreaded encoding appeared in WavPack 5.5
+    if (WAVPACK_VERSION VERSION_GREATER_EQUAL 5.5)
+        add_definitions(-DWAVPACK_WORKER_THREADS)
+    endif()
+
+    list(APPEND SOURCES
+        ${CMAKE_CURRENT_LIST_DIR}/wavpackdecoder.h
+        ${CMAKE_CURRENT_LIST_DIR}/wavpackdecoder.cpp
+    )
+endif()
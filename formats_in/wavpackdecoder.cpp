@@ -0,0 +1,238 @@
+/* BEGIN_COMMON_COPYRIGHT_HEADER
+ * (c)LGPL2+
+ *
+ * Flacon - audio File Encoder
+ * https://github.com/flacon/flacon
+ *
+ * Copyright: 2024
+ *   Alexander Sokoloff <sokoloff.a@gmail.com>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * END_COMMON_COPYRIGHT_HEADER */
+
+#include "wavpackdecoder.h"
+#include "types.h"
+#include <QtEndian>
+#include <QLoggingCategory>
+
+namespace {
+Q_LOGGING_CATEGORY(LOG, "WavPackDecoder")
+}
+
+using namespace Conv;
+
+static constexpr int MAX_FRAMES = 4096;
+
+/************************************************
+ *
+ ************************************************/
+WavPackDecoder::WavPackDecoder(const QString &fileName, QObject *parent) :
+    QIODevice(parent),
+    mFileName(fileName)
+{
+}
+
+/************************************************
+ *
+ ************************************************/
+WavPackDecoder::~WavPackDecoder()
+{
+    close();
+}
+
+/************************************************
+ * The correction file (.wvc) is used if it's
+ * placed near the main file, as wvunpack does.
+ ************************************************/
+bool WavPackDecoder::open(OpenMode mode)
+{
+    if (mode & WriteOnly) {
+        setErrorString("The WavPack decoder is read only");
+        return false;
+    }
+
+#ifdef Q_OS_WIN
+    const int        flags = OPEN_WVC | OPEN_FILE_UTF8;
+    const QByteArray name  = mFileName.toUtf8();
+#else
+    const int        flags = OPEN_WVC;
+    const QByteArray name  = mFileName.toLocal8Bit();
+#endif
+
+    char error[80] = { '\0' };
+    mContext       = WavpackOpenFileInput(name.constData(), error, flags, 0);
+    if (!mContext) {
+        setErrorString(QString::fromLocal8Bit(error));
+        return false;
+    }
+
+    const int64_t samples = WavpackGetNumSamples64(mContext);
+    if (samples < 0 || (WavpackGetQualifyMode(mContext) & QMODE_DSD_AUDIO)) {
+        setErrorString("Unsupported WavPack stream");
+        mContext = WavpackCloseFile(mContext);
+        return false;
+    }
+
+    const int      channels = WavpackGetNumChannels(mContext);
+    const int      bytes    = WavpackGetBytesPerSample(mContext);
+    const bool     isFloat  = WavpackGetMode(mContext) & MODE_FLOAT;
+    const uint32_t rate     = WavpackGetSampleRate(mContext);
+
+    mWavHeader = WavHeader(isFloat ? WavHeader::Format_IEEE_FLOAT : WavHeader::Format_PCM,
+                           channels,
+                           rate,
+                           bytes * 8,
+                           quint64(samples) * channels * bytes,
+                           WavpackGetChannelMask(mContext),
+                           WavpackGetBitsPerSample(mContext));
+    mHeader    = mWavHeader.toByteArray();
+
+    qCDebug(LOG) << "Open" << mFileName << mWavHeader;
+    return QIODevice::open(ReadOnly | Unbuffered);
+}
+
+/************************************************
+ *
+ ************************************************/
+void WavPackDecoder::close()
+{
+    if (mContext) {
+        mContext = WavpackCloseFile(mContext);
+    }
+
+    mPending.clear();
+    mPendingPos = 0;
+    QIODevice::close();
+}
+
+/************************************************
+ *
+ ************************************************/
+qint64 WavPackDecoder::size() const
+{
+    return mHeader.size() + mWavHeader.dataSize();
+}
+
+/************************************************
+ * The library seeks to the block that contains
+ * the sample and decodes only the rest of this
+ * block.
+ ************************************************/
+bool WavPackDecoder::seek(qint64 pos)
+{
+    if (!mContext || !QIODevice::seek(pos)) {
+        return false;
+    }
+
+    const qint64 dataPos = qMax(pos - mHeader.size(), qint64(0));
+    const int    align   = mWavHeader.blockAlign();
+
+    if (!WavpackSeekSample64(mContext, dataPos / align)) {
+        // The context is unusable after the failed seek
+        setErrorString(QString("Can't seek to %1 sample").arg(dataPos / align));
+        mContext = WavpackCloseFile(mContext);
+        return false;
+    }
+
+    // The first bytes of the frame are skipped by the next read
+    mPending.clear();
+    mPendingPos = dataPos % align;
+    return true;
+}
+
+/************************************************
+ *
+ ************************************************/
+qint64 WavPackDecoder::readData(char *data, qint64 maxSize)
+{
+    if (!mContext) {
+        return -1;
+    }
+
+    qint64 done = 0;
+    qint64 pos  = this->pos();
+
+    if (pos < mHeader.size()) {
+        done = qMin(maxSize, mHeader.size() - pos);
+        memcpy(data, mHeader.constData() + pos, done);
+    }
+
+    while (done < maxSize) {
+        if (mPendingPos >= mPending.size()) {
+            decodeFrames(maxSize - done);
+            if (mPending.isEmpty()) {
+                break;
+            }
+        }
+
+        const qint64 n = qMin(maxSize - done, qint64(mPending.size() - mPendingPos));
+        memcpy(data + done, mPending.constData() + mPendingPos, n);
+        mPendingPos += n;
+        done += n;
+    }
+
+    return (done || !maxSize) ? done : -1;
+}
+
+/************************************************
+ * WavPack returns the 32-bit samples, the values
+ * are right justified to the bytes per sample.
+ * The float samples are returned as is.
+ ************************************************/
+void WavPackDecoder::decodeFrames(qint64 maxSize)
+{
+    const int channels = mWavHeader.numChannels();
+    const int align    = mWavHeader.blockAlign();
+    const int bytes    = align / channels;
+    const int frames   = qBound(qint64(1), (maxSize + mPendingPos) / align + 1, qint64(MAX_FRAMES));
+
+    mSamples.resize(frames * channels);
+    const uint32_t got = WavpackUnpackSamples(mContext, mSamples.data(), frames);
+
+    // mPendingPos is not zero after the seek in the middle of the frame
+    const qint64 skip = mPending.isEmpty() ? mPendingPos : 0;
+    mPending.resize(got * align);
+    mPendingPos = skip;
+
+    uchar         *dst = reinterpret_cast<uchar *>(mPending.data());
+    const int32_t *src = mSamples.constData();
+    for (uint32_t i = 0; i < got * channels; ++i, dst += bytes) {
+        switch (bytes) {
+            case 1:
+                dst[0] = uchar(src[i] + 128);
+                break;
+            case 2:
+                qToLittleEndian<qint16>(src[i], dst);
+                break;
+            case 3:
+                dst[0] = uchar(src[i]);
+                dst[1] = uchar(src[i] >> 8);
+                dst[2] = uchar(src[i] >> 16);
+                break;
+            case 4:
+                qToLittleEndian<qint32>(src[i], dst);
+                break;
+        }
+    }
+}
+
+/************************************************
+ *
+ ************************************************/
+qint64 WavPackDecoder::writeData(const char *, qint64)
+{
+    return -1;
+}
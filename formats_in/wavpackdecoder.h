@@ -0,0 +1,71 @@
+/* BEGIN_COMMON_COPYRIGHT_HEADER
+ * (c)LGPL2+
+ *
+ * Flacon - audio File Encoder
+ * https://github.com/flacon/flacon
+ *
+ * Copyright: 2024
+ *   Alexander Sokoloff <sokoloff.a@gmail.com>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * END_COMMON_COPYRIGHT_HEADER */
+
+#ifndef WAVPACKDECODER_H
+#define WAVPACKDECODER_H
+
+#include <QIODevice>
+#include <QVector>
+#include "converter/wavheader.h"
+#include <wavpack/wavpack.h>
+
+/************************************************
+ * Decodes the WavPack file in-process.
+ *
+ * The device looks like a Wave64 file: the header
+ * is followed by the PCM data. The device is
+ * random access, seek() goes to the sample
+ * without decoding the audio before it.
+ ************************************************/
+class WavPackDecoder : public QIODevice
+{
+public:
+    explicit WavPackDecoder(const QString &fileName, QObject *parent = nullptr);
+    ~WavPackDecoder() override;
+
+    bool open(OpenMode mode) override;
+    void close() override;
+
+    bool   isSequential() const override { return false; }
+    qint64 size() const override;
+    bool   seek(qint64 pos) override;
+
+protected:
+    qint64 readData(char *data, qint64 maxSize) override;
+    qint64 writeData(const char *data, qint64 maxSize) override;
+
+private:
+    QString          mFileName;
+    WavpackContext  *mContext = nullptr;
+    Conv::WavHeader  mWavHeader;
+    QByteArray       mHeader;
+    QVector<int32_t> mSamples;
+    QByteArray       mPending;
+    qint64           mPendingPos = 0;
+
+    void decodeFrames(qint64 maxSize);
+};
+
+#endif // WAVPACKDECODER_H
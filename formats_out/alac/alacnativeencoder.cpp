@@ -0,0 +1,524 @@
+/* BEGIN_COMMON_COPYRIGHT_HEADER
+ * (c)LGPL2+
+ *
+ * Flacon - audio File Encoder
+ * https://github.com/flacon/flacon
+ *
+ * Copyright: 2024
+ *   Alexander Sokoloff <sokoloff.a@gmail.com>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * END_COMMON_COPYRIGHT_HEADER */
+
+#include "alacnativeencoder.h"
+#include "../metadatawriter.h"
+#include <QtEndian>
+#include <QLoggingCategory>
+
+namespace {
+Q_LOGGING_CATEGORY(LOG, "AlacNativeEncoder")
+
+// Text tags, the gain and the album gain added later
+static constexpr int TAGS_PADDING = 16 * 1024;
+
+/************************************************
+ * Builds the big-endian MP4 atoms, the size of
+ * the atom is set when it's closed.
+ ************************************************/
+class AtomWriter
+{
+public:
+    void begin(const char *type)
+    {
+        mStack << mData.size();
+        u32(0);
+        mData.append(type, 4);
+    }
+
+    void beginFull(const char *type, quint8 version, quint32 flags)
+    {
+        begin(type);
+        u32(quint32(version) << 24 | flags);
+    }
+
+    void end()
+    {
+        const int start = mStack.takeLast();
+        qToBigEndian<quint32>(mData.size() - start, mData.data() + start);
+    }
+
+    void u8(quint8 value) { mData.append(char(value)); }
+    void u16(quint16 value) { append<quint16>(value); }
+    void u32(quint32 value) { append<quint32>(value); }
+    void u64(quint64 value) { append<quint64>(value); }
+
+    // The 32 or 64-bit time fields of the version 0 and 1 atoms
+    void time(bool version1, quint64 value) { version1 ? u64(value) : u32(quint32(value)); }
+
+    void fourcc(const char *value) { mData.append(value, 4); }
+    void zeros(int count) { mData.append(count, '\0'); }
+    void bytes(const QByteArray &value) { mData.append(value); }
+
+    void matrix()
+    {
+        for (quint32 v : { 0x00010000, 0, 0, 0, 0x00010000, 0, 0, 0, 0x40000000 }) {
+            u32(v);
+        }
+    }
+
+    int               pos() const { return mData.size(); }
+    const QByteArray &data() const { return mData; }
+
+private:
+    QByteArray   mData;
+    QVector<int> mStack;
+
+    template <typename T>
+    void append(T value)
+    {
+        char buf[sizeof(T)];
+        qToBigEndian<T>(value, buf);
+        mData.append(buf, sizeof(T));
+    }
+};
+
+/************************************************
+ * The format flags of the ALAC output format
+ * are the source bit depth.
+ ************************************************/
+static quint32 bitDepthFlag(int bitsPerSample)
+{
+    switch (bitsPerSample) {
+        case 16:
+            return 1;
+        case 20:
+            return 2;
+        case 24:
+            return 3;
+        case 32:
+            return 4;
+    }
+    return 0;
+}
+
+} // namespace
+
+using namespace Conv;
+
+/************************************************
+ *
+ ************************************************/
+AlacNativeEncoder::AlacNativeEncoder(const QString &filePath, bool fastMode) :
+    NativeEncoder(filePath),
+    mFastMode(fastMode),
+    mFile(filePath),
+    mInputFormat(),
+    mOutputFormat(),
+    mTagsPadding(TAGS_PADDING)
+{
+}
+
+/************************************************
+ * The multichannel ALAC uses its own channel
+ * order and the 'chan' atom, these streams are
+ * left to the external encoder.
+ ************************************************/
+bool AlacNativeEncoder::isSupported(const WavHeader &wav) const
+{
+    return wav.sampleFormat() == WavHeader::Format_PCM &&
+            wav.numChannels() <= 2 &&
+            (wav.bitsPerSample() == 16 || wav.bitsPerSample() == 24 || wav.bitsPerSample() == 32);
+}
+
+/************************************************
+ *
+ ************************************************/
+void AlacNativeEncoder::open(const WavHeader &wav)
+{
+    mWav = wav;
+
+    const quint32 frameSize = kALACDefaultFramesPerPacket;
+    const quint64 frames    = wav.dataSize() / qMax<quint16>(wav.blockAlign(), 1);
+
+    mInputFormat.mSampleRate       = wav.sampleRate();
+    mInputFormat.mFormatID         = kALACFormatLinearPCM;
+    mInputFormat.mFormatFlags      = kALACFormatFlagIsSignedInteger | kALACFormatFlagIsPacked;
+    mInputFormat.mBytesPerPacket   = wav.blockAlign();
+    mInputFormat.mFramesPerPacket  = 1;
+    mInputFormat.mBytesPerFrame    = wav.blockAlign();
+    mInputFormat.mChannelsPerFrame = wav.numChannels();
+    mInputFormat.mBitsPerChannel   = wav.bitsPerSample();
+
+    mOutputFormat.mSampleRate       = wav.sampleRate();
+    mOutputFormat.mFormatID         = kALACFormatAppleLossless;
+    mOutputFormat.mFormatFlags      = bitDepthFlag(wav.bitsPerSample());
+    mOutputFormat.mFramesPerPacket  = frameSize;
+    mOutputFormat.mChannelsPerFrame = wav.numChannels();
+
+    mEncoder.SetFastMode(mFastMode);
+    mEncoder.SetFrameSize(frameSize);
+    if (mEncoder.InitializeEncoder(mOutputFormat) != 0) {
+        throw FlaconError("Can't initialize the ALAC encoder");
+    }
+
+    uint32_t   cookieSize = mEncoder.GetMagicCookieSize(wav.numChannels());
+    QByteArray cookie(cookieSize, '\0');
+    mEncoder.GetMagicCookie(cookie.data(), &cookieSize);
+    cookie.resize(cookieSize);
+
+    mPacketsCount = quint32((frames + frameSize - 1) / frameSize);
+    mPacketSizes.reserve(mPacketsCount);
+    mPacket.resize(frameSize * wav.blockAlign() + kALACMaxEscapeHeaderBytes);
+    mLargeMdat = wav.dataSize() + quint64(mPacketsCount) * kALACMaxEscapeHeaderBytes > 0xFFFFFFF0ull;
+
+    // Layout: ftyp, moov, mdat
+    quint64    stszPos = 0;
+    quint64    stcoPos = 0;
+    QByteArray ftyp    = createFtyp();
+    QByteArray moov    = createMoov(frames, cookie, &stszPos, &stcoPos);
+
+    mMdatPos  = ftyp.size() + moov.size();
+    mStszPos  = ftyp.size() + stszPos;
+    mMdatSize = 0;
+    qToBigEndian<quint32>(quint32(mMdatPos + createMdatHeader().size()), moov.data() + stcoPos);
+
+    if (!mFile.open(QFile::WriteOnly | QFile::Truncate)) {
+        throw FlaconError(mFile.errorString());
+    }
+
+    QByteArray head = ftyp + moov + createMdatHeader();
+    if (mFile.write(head) != head.size()) {
+        throw FlaconError(mFile.errorString());
+    }
+
+    qCDebug(LOG) << "Start encoder:" << filePath() << "rate:" << wav.sampleRate() << "channels:" << wav.numChannels() << "packets:" << mPacketsCount;
+}
+
+/************************************************
+ *
+ ************************************************/
+QByteArray AlacNativeEncoder::createFtyp() const
+{
+    AtomWriter a;
+    a.begin("ftyp");
+    a.fourcc("M4A ");
+    a.u32(0);
+    a.fourcc("M4A ");
+    a.fourcc("mp42");
+    a.fourcc("isom");
+    a.end();
+    return a.data();
+}
+
+/************************************************
+ * All packets are placed in a single chunk, so the
+ * sizes of the tables depend only on the number of
+ * packets. The packet sizes and the chunk offset
+ * are filled later, stszPos and stcoPos are their
+ * positions in the returned data.
+ ************************************************/
+QByteArray AlacNativeEncoder::createMoov(quint64 frames, const QByteArray &cookie, quint64 *stszPos, quint64 *stcoPos) const
+{
+    const quint32 rate      = mWav.sampleRate();
+    const quint32 frameSize = mOutputFormat.mFramesPerPacket;
+    const bool    v1        = frames > 0xFFFFFFFFull;
+
+    AtomWriter a;
+    a.begin("moov");
+
+    a.beginFull("mvhd", v1, 0);
+    a.time(v1, 0); // creation time
+    a.time(v1, 0); // modification time
+    a.u32(rate);
+    a.time(v1, frames);
+    a.u32(0x00010000); // rate 1.0
+    a.u16(0x0100);     // volume 1.0
+    a.zeros(10);
+    a.matrix();
+    a.zeros(24);
+    a.u32(2); // next track ID
+    a.end();
+
+    a.begin("trak");
+
+    a.beginFull("tkhd", v1, 0x000007); // enabled, in movie, in preview
+    a.time(v1, 0);
+    a.time(v1, 0);
+    a.u32(1); // track ID
+    a.u32(0);
+    a.time(v1, frames);
+    a.zeros(8);
+    a.u16(0);      // layer
+    a.u16(0);      // alternate group
+    a.u16(0x0100); // volume 1.0
+    a.u16(0);
+    a.matrix();
+    a.u32(0); // width
+    a.u32(0); // height
+    a.end();
+
+    a.begin("mdia");
+
+    a.beginFull("mdhd", v1, 0);
+    a.time(v1, 0);
+    a.time(v1, 0);
+    a.u32(rate);
+    a.time(v1, frames);
+    a.u16(0x55C4); // "und" language
+    a.u16(0);
+    a.end();
+
+    a.beginFull("hdlr", 0, 0);
+    a.u32(0);
+    a.fourcc("soun");
+    a.zeros(12);
+    a.bytes("SoundHandler");
+    a.u8(0);
+    a.end();
+
+    a.begin("minf");
+
+    a.beginFull("smhd", 0, 0);
+    a.u16(0); // balance
+    a.u16(0);
+    a.end();
+
+    a.begin("dinf");
+    a.beginFull("dref", 0, 0);
+    a.u32(1);
+    a.beginFull("url ", 0, 0x000001); // the data is in this file
+    a.end();
+    a.end();
+    a.end();
+
+    a.begin("stbl");
+
+    a.beginFull("stsd", 0, 0);
+    a.u32(1);
+    a.begin("alac");
+    a.zeros(6);
+    a.u16(1); // data reference index
+    a.zeros(8);
+    a.u16(mWav.numChannels());
+    a.u16(mWav.bitsPerSample());
+    a.u16(0);
+    a.u16(0);
+    a.u32(rate < 0x10000 ? rate << 16 : 0); // 16.16, the actual rate is in the cookie
+    a.beginFull("alac", 0, 0);
+    a.bytes(cookie);
+    a.end();
+    a.end();
+    a.end();
+
+    a.beginFull("stts", 0, 0);
+    const quint32 fullPackets = quint32(frames / frameSize);
+    const quint32 lastFrames  = quint32(frames % frameSize);
+    a.u32((fullPackets ? 1 : 0) + (lastFrames ? 1 : 0));
+    if (fullPackets) {
+        a.u32(fullPackets);
+        a.u32(frameSize);
+    }
+    if (lastFrames) {
+        a.u32(1);
+        a.u32(lastFrames);
+    }
+    a.end();
+
+    a.beginFull("stsc", 0, 0);
+    a.u32(1);
+    a.u32(1); // first chunk
+    a.u32(mPacketsCount);
+    a.u32(1); // sample description index
+    a.end();
+
+    a.beginFull("stsz", 0, 0);
+    a.u32(0); // the packets have different sizes
+    a.u32(mPacketsCount);
+    *stszPos = a.pos();
+    a.zeros(mPacketsCount * 4);
+    a.end();
+
+    a.beginFull("stco", 0, 0);
+    a.u32(1);
+    *stcoPos = a.pos();
+    a.u32(0);
+    a.end();
+
+    a.end(); // stbl
+    a.end(); // minf
+    a.end(); // mdia
+    a.end(); // trak
+
+    // iTunes metadata, the tags are written by TagLib
+    a.begin("udta");
+    a.beginFull("meta", 0, 0);
+
+    a.beginFull("hdlr", 0, 0);
+    a.u32(0);
+    a.fourcc("mdir");
+    a.fourcc("appl");
+    a.zeros(8);
+    a.u8(0);
+    a.end();
+
+    a.begin("ilst");
+    a.end();
+
+    a.begin("free");
+    a.zeros(mTagsPadding);
+    a.end();
+
+    a.end(); // meta
+    a.end(); // udta
+
+    a.end(); // moov
+    return a.data();
+}
+
+/************************************************
+ * The large size is used if the audio data can
+ * exceed 4 GiB.
+ ************************************************/
+QByteArray AlacNativeEncoder::createMdatHeader() const
+{
+    AtomWriter a;
+    if (mLargeMdat) {
+        a.u32(1);
+        a.fourcc("mdat");
+        a.u64(16 + mMdatSize);
+    }
+    else {
+        a.u32(quint32(8 + mMdatSize));
+        a.fourcc("mdat");
+    }
+    return a.data();
+}
+
+/************************************************
+ * The encoder takes the packets of the frame size,
+ * only the last packet can be shorter.
+ ************************************************/
+void AlacNativeEncoder::write(const char *data, qint64 size)
+{
+    mPending.append(data, size);
+
+    const int packetBytes = mOutputFormat.mFramesPerPacket * mWav.blockAlign();
+    int       pos         = 0;
+    while (mPending.size() - pos >= packetBytes) {
+        encodePacket(mPending.data() + pos, packetBytes);
+        pos += packetBytes;
+    }
+    mPending.remove(0, pos);
+}
+
+/************************************************
+ *
+ ************************************************/
+void AlacNativeEncoder::encodePacket(char *data, int size)
+{
+    int32_t bytes = size;
+    int32_t err   = mEncoder.Encode(mInputFormat, mOutputFormat,
+                                    reinterpret_cast<unsigned char *>(data),
+                                    reinterpret_cast<unsigned char *>(mPacket.data()),
+                                    &bytes);
+    if (err != 0) {
+        throw FlaconError(QString("ALAC encoder error, the error code is %1").arg(err));
+    }
+
+    if (mFile.write(mPacket.constData(), bytes) != bytes) {
+        throw FlaconError(mFile.errorString());
+    }
+
+    mPacketSizes << quint32(bytes);
+    mMdatSize += bytes;
+}
+
+/************************************************
+ * Fills the packet sizes and the mdat size, then
+ * TagLib writes the tags into the reserved space.
+ ************************************************/
+void AlacNativeEncoder::save()
+{
+    if (!mPending.isEmpty()) {
+        encodePacket(mPending.data(), mPending.size());
+        mPending.clear();
+    }
+    mEncoder.Finish();
+
+    if (mPacketSizes.size() != int(mPacketsCount)) {
+        throw FlaconError(QString("ALAC encoder error: %1 packets were written instead of %2").arg(mPacketSizes.size()).arg(mPacketsCount));
+    }
+
+    QByteArray sizes(mPacketSizes.size() * 4, '\0');
+    for (int i = 0; i < mPacketSizes.size(); ++i) {
+        qToBigEndian<quint32>(mPacketSizes.at(i), sizes.data() + i * 4);
+    }
+
+    const QByteArray mdat = createMdatHeader();
+    if (!mFile.seek(mStszPos) || mFile.write(sizes) != sizes.size() ||
+        !mFile.seek(mMdatPos) || mFile.write(mdat) != mdat.size()) {
+        throw FlaconError(mFile.errorString());
+    }
+    mFile.close();
+
+    if (!mTagSetters.isEmpty()) {
+        Mp4MetaDataWriter writer(filePath());
+        for (const TagSetter &set : std::as_const(mTagSetters)) {
+            set(&writer);
+        }
+        writer.save();
+    }
+}
+
+/************************************************
+ *
+ ************************************************/
+void AlacNativeEncoder::setTags(const Track &track)
+{
+    mTagSetters << [track](MetadataWriter *writer) { writer->setTags(track); };
+}
+
+/************************************************
+ *
+ ************************************************/
+void AlacNativeEncoder::setEmbeddedCue(const QString &)
+{
+}
+
+/************************************************
+ *
+ ************************************************/
+void AlacNativeEncoder::setCoverImage(const CoverImage &image)
+{
+    mTagsPadding += image.data().size();
+    mTagSetters << [image](MetadataWriter *writer) { writer->setCoverImage(image); };
+}
+
+/************************************************
+ *
+ ************************************************/
+void AlacNativeEncoder::setTrackReplayGain(float gain, float peak)
+{
+    mTagSetters << [gain, peak](MetadataWriter *writer) { writer->setTrackReplayGain(gain, peak); };
+}
+
+/************************************************
+ *
+ ************************************************/
+void AlacNativeEncoder::setAlbumReplayGain(float gain, float peak)
+{
+    mTagSetters << [gain, peak](MetadataWriter *writer) { writer->setAlbumReplayGain(gain, peak); };
+}
@@ -0,0 +1,88 @@
+/* BEGIN_COMMON_COPYRIGHT_HEADER
+ * (c)LGPL2+
+ *
+ * Flacon - audio File Encoder
+ * https://github.com/flacon/flacon
+ *
+ * Copyright: 2024
+ *   Alexander Sokoloff <sokoloff.a@gmail.com>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * END_COMMON_COPYRIGHT_HEADER */
+
+#ifndef ALACNATIVEENCODER_H
+#define ALACNATIVEENCODER_H
+
+#include "../nativeencoder.h"
+#include <QFile>
+#include <functional>
+#include <alac/ALACEncoder.h>
+
+/************************************************
+ * Encodes ALAC and writes the M4A file with the
+ * moov atom before the audio data (fast start).
+ *
+ * The moov atom is sized beforehand: the number of
+ * packets is known from the WAV header. The free
+ * atom after the ilst reserves space for tags, so
+ * the tags are written in place, and later updates,
+ * like the album gain, don't move the audio data.
+ ************************************************/
+class AlacNativeEncoder : public NativeEncoder
+{
+public:
+    AlacNativeEncoder(const QString &filePath, bool fastMode);
+
+    bool isSupported(const Conv::WavHeader &wav) const override;
+
+    void open(const Conv::WavHeader &wav) override;
+    void write(const char *data, qint64 size) override;
+    void save() override;
+
+    void setTags(const Track &track) override;
+    void setEmbeddedCue(const QString &cue) override;
+    void setCoverImage(const CoverImage &image) override;
+
+    void setTrackReplayGain(float gain, float peak) override;
+    void setAlbumReplayGain(float gain, float peak) override;
+
+private:
+    using TagSetter = std::function<void(MetadataWriter *)>;
+
+    bool                   mFastMode;
+    QFile                  mFile;
+    Conv::WavHeader        mWav;
+    ALACEncoder            mEncoder;
+    AudioFormatDescription mInputFormat;
+    AudioFormatDescription mOutputFormat;
+    QByteArray             mPending;
+    QByteArray             mPacket;
+    QVector<quint32>       mPacketSizes;
+    quint32                mPacketsCount = 0;
+    quint64                mStszPos      = 0;
+    quint64                mMdatPos      = 0;
+    quint64                mMdatSize     = 0;
+    bool                   mLargeMdat    = false;
+    QList<TagSetter>       mTagSetters;
+    int                    mTagsPadding;
+
+    QByteArray createFtyp() const;
+    QByteArray createMoov(quint64 frames, const QByteArray &cookie, quint64 *stszPos, quint64 *stcoPos) const;
+    QByteArray createMdatHeader() const;
+    void       encodePacket(char *data, int size);
+};
+
+#endif // ALACNATIVEENCODER_H
@@ -27,6 +27,10 @@
 #include "alacconfigpage.h"
 #include "../metadatawriter.h"
 
+#ifdef USE_LIBALAC
+#include "alacnativeencoder.h"
+#endif
+
 /************************************************
  *
  ************************************************/
@@ -90,3 +94,17 @@ MetadataWriter *OutFormat_Alac::createMetadataWriter(const QString &filePath) co
 {
     return new Mp4MetaDataWriter(filePath);
 }
+
+/************************************************
+ *
+ ************************************************/
+NativeEncoder *OutFormat_Alac::createNativeEncoder(const Profile &profile, const QString &filePath) const
+{
+#ifdef USE_LIBALAC
+    return new AlacNativeEncoder(filePath, profile.encoderValue("Compression").toInt() == 0);
+#else
+    Q_UNUSED(profile)
+    Q_UNUSED(filePath)
+    return nullptr;
+#endif
+}
@@ -43,6 +43,7 @@ public:
     QStringList encoderArgs(const Profile &profile, const QString &outFile) const override;
 
     MetadataWriter *createMetadataWriter(const QString &filePath) const override;
+    NativeEncoder  *createNativeEncoder(const Profile &profile, const QString &filePath) const override;
 };
 
 #endif // ALACOITFORMAT_H
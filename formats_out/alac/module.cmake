@@ -6,3 +6,23 @@ list(APPEND SOURCES
   ${CMAKE_CURRENT_LIST_DIR}/alacconfigpage.cpp
   ${CMAKE_CURRENT_LIST_DIR}/alacconfigpage.ui
 )
+
+# The Apple ALAC codec library, as packaged by https://github.com/mikebrady/alac
+option(USE_LIBALAC "Encode ALAC in-process with libalac when it's available" ON)
+if (USE_LIBALAC)
+    find_package(PkgConfig)
+    pkg_search_module(ALAC alac)
+endif()
+
+if (ALAC_FOUND)
+    message(STATUS "Using libalac version: ${ALAC_VERSION}")
+    add_definitions(-DUSE_LIBALAC)
+    include_directories(${ALAC_INCLUDE_DIRS})
+    link_directories(${ALAC_LIBRARY_DIRS})
+    list(APPEND NATIVE_ENCODERS_LIBRARIES ${ALAC_LIBRARIES})
+
+    list(APPEND SOURCES
+      ${CMAKE_CURRENT_LIST_DIR}/alacnativeencoder.h
+      ${CMAKE_CURRENT_LIST_DIR}/alacnativeencoder.cpp
+    )
+endif()
@@ -81,6 +81,14 @@ void FlacMetadataWriter::setEmbeddedCue(const QString &cue)
  ************************************************/
 void FlacMetadataWriter::setCoverImage(const CoverImage &image)
 {
+    // The retagged file already has the pictures
+    if (isRemoveEmptyTags()) {
+        mFile.removePictures();
+        if (mFile.hasXiphComment()) {
+            mFile.xiphComment()->removeAllPictures();
+        }
+    }
+
     if (!image.isEmpty()) {
         TagLib::ByteVector dt(image.data().data(), image.data().size());
 
@@ -39,7 +39,7 @@ OutFormat_Flac::OutFormat_Flac()
     mId      = "FLAC";
     mExt     = "flac";
     mName    = "FLAC";
-    mOptions = FormatOption::Lossless | FormatOption::SupportGain | FormatOption::SupportEmbeddedCue | FormatOption::SupportEmbeddedImage;
+    mOptions = FormatOption::Lossless | FormatOption::SupportGain | FormatOption::SupportEmbeddedCue | FormatOption::SupportEmbeddedImage | FormatOption::SupportRf64;
 }
 
 /************************************************
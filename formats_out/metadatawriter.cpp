@@ -58,13 +58,19 @@ QString MetadataWriter::peakToString(float &peak) const
 }
 
 /************************************************
- *
+ * On retag the empty value removes the field, so the
+ * value the user cleared doesn't stay in the file.
  ************************************************/
 void MetadataWriter::setXiphTag(TagLib::Ogg::XiphComment *tags, const QString &key, const QString &value) const
 {
-    if (!value.isEmpty()) {
-        tags->addField(key.toStdString(), TagLib::String(value.toStdString(), TagLib::String::UTF8), true);
+    if (value.isEmpty()) {
+        if (mRemoveEmptyTags) {
+            tags->removeFields(key.toStdString());
+        }
+        return;
     }
+
+    tags->addField(key.toStdString(), TagLib::String(value.toStdString(), TagLib::String::UTF8), true);
 }
 
 /************************************************
@@ -99,14 +105,25 @@ void MetadataWriter::setXiphTags(TagLib::Ogg::XiphComment *tags, const Track &tr
  ************************************************/
 void MetadataWriter::setXiphEmbeddedCue(TagLib::Ogg::XiphComment *tags, const QString &cue) const
 {
-    tags->addField("CUESHEET", TagLib::String(cue.toStdString(), TagLib::String::UTF8), true);
+    setXiphTag(tags, "CUESHEET", cue);
 }
 
 /************************************************
- *
+ * On retag the previous cover is replaced, the empty
+ * image just removes it.
  ************************************************/
 void MetadataWriter::setXiphCoverImage(TagLib::Ogg::XiphComment *tags, const CoverImage &image) const
 {
+    if (mRemoveEmptyTags) {
+        tags->removeAllPictures();
+        tags->removeFields("METADATA_BLOCK_PICTURE");
+        tags->removeFields("COVERART");
+    }
+
+    if (image.isEmpty()) {
+        return;
+    }
+
     TagLib::ByteVector dt(image.data().data(), image.data().size());
 
     TagLib::FLAC::Picture pic;
@@ -145,10 +162,14 @@ void MetadataWriter::setXiphAlbumReplayGain(TagLib::Ogg::XiphComment *tags, floa
  ************************************************/
 void MetadataWriter::setApeTags(TagLib::APE::Tag *tags, const Track &track) const
 {
-    auto writeStrTag = [tags](const QString &tagName, const QString &value) {
-        if (!value.isEmpty()) {
-            tags->addValue(tagName.toStdString(), TagLib::String(value.toStdString(), TagLib::String::UTF8), true);
+    auto writeStrTag = [this, tags](const QString &tagName, const QString &value) {
+        if (value.isEmpty()) {
+            if (mRemoveEmptyTags) {
+                tags->removeItem(tagName.toStdString());
+            }
+            return;
         }
+        tags->addValue(tagName.toStdString(), TagLib::String(value.toStdString(), TagLib::String::UTF8), true);
     };
 
     writeStrTag("ARTIST", track.artist());
@@ -165,10 +186,17 @@ void MetadataWriter::setApeTags(TagLib::APE::Tag *tags, const Track &track) cons
 }
 
 /************************************************
- *
+ * On retag the empty image removes the cover
  ************************************************/
 void MetadataWriter::setApeCoverImage(TagLib::APE::Tag *tags, const CoverImage &image) const
 {
+    if (image.isEmpty()) {
+        if (mRemoveEmptyTags) {
+            tags->removeItem("Cover Art (Front)");
+        }
+        return;
+    }
+
     TagLib::ByteVector imgData(image.data().data(), image.data().size());
 
     TagLib::ByteVector data;
@@ -241,10 +269,14 @@ void Mp4MetaDataWriter::setTags(const Track &track)
 {
     TagLib::PropertyMap props = mFile.properties();
 
-    auto writeStrTag = [&props](const QString &tagName, const QString &value) {
-        if (!value.isEmpty()) {
-            props.replace(TagLib::String(tagName.toStdString(), TagLib::String::UTF8), TagLib::String(value.toStdString(), TagLib::String::UTF8));
+    auto writeStrTag = [this, &props](const QString &tagName, const QString &value) {
+        if (value.isEmpty()) {
+            if (isRemoveEmptyTags()) {
+                props.erase(TagLib::String(tagName.toStdString(), TagLib::String::UTF8));
+            }
+            return;
         }
+        props.replace(TagLib::String(tagName.toStdString(), TagLib::String::UTF8), TagLib::String(value.toStdString(), TagLib::String::UTF8));
     };
 
     writeStrTag("ARTIST", track.artist());
@@ -272,12 +304,17 @@ void Mp4MetaDataWriter::setEmbeddedCue(const QString &)
  ************************************************/
 void Mp4MetaDataWriter::setCoverImage(const CoverImage &image)
 {
-    if (!image.isEmpty()) {
-        TagLib::ByteVector data(image.data().data(), image.data().size());
-
-        TagLib::MP4::CoverArt cover(coverFormatToTagLib(image.format()), data);
-        mFile.tag()->setItem("covr", TagLib::MP4::CoverArtList().append(cover));
+    if (image.isEmpty()) {
+        if (isRemoveEmptyTags()) {
+            mFile.tag()->removeItem("covr");
+        }
+        return;
     }
+
+    TagLib::ByteVector data(image.data().data(), image.data().size());
+
+    TagLib::MP4::CoverArt cover(coverFormatToTagLib(image.format()), data);
+    mFile.tag()->setItem("covr", TagLib::MP4::CoverArtList().append(cover));
 }
 
 /************************************************
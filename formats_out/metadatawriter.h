@@ -58,6 +58,12 @@ public:
     virtual void setTrackReplayGain(float gain, float peak) = 0;
     virtual void setAlbumReplayGain(float gain, float peak) = 0;
 
+    // The retagged file already has the tags, so the empty value
+    // and the empty image remove the old ones. The freshly encoded
+    // file just skips them.
+    bool isRemoveEmptyTags() const { return mRemoveEmptyTags; }
+    void setRemoveEmptyTags(bool value) { mRemoveEmptyTags = value; }
+
 protected:
     QString gainToString(float &gain) const;
     QString peakToString(float &peak) const;
@@ -73,6 +79,9 @@ protected:
     void setApeCoverImage(TagLib::APE::Tag *tags, const CoverImage &image) const;
     void setApeTrackReplayGain(TagLib::APE::Tag *tags, float gain, float peak) const;
     void setApeAlbumReplayGain(TagLib::APE::Tag *tags, float gain, float peak) const;
+
+private:
+    bool mRemoveEmptyTags = false;
 };
 
 class NullMetadataWriter : public MetadataWriter
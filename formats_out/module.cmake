@@ -8,6 +8,9 @@ list(APPEND SOURCES
     ${CMAKE_CURRENT_LIST_DIR}/metadatawriter.h
     ${CMAKE_CURRENT_LIST_DIR}/metadatawriter.cpp
 
+    ${CMAKE_CURRENT_LIST_DIR}/nativeencoder.h
+    ${CMAKE_CURRENT_LIST_DIR}/nativeencoder.cpp
+
 )
 
 include(${CMAKE_CURRENT_LIST_DIR}/aac/module.cmake)
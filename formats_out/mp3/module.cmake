@@ -8,4 +8,21 @@ list(APPEND SOURCES
   ${CMAKE_CURRENT_LIST_DIR}/mp3metadatawriter.cpp
 )
 
+# LAME doesn't install a pkg-config file
+option(USE_LIBMP3LAME "Encode MP3 in-process with libmp3lame when it's available" ON)
+if (USE_LIBMP3LAME)
+    find_path(MP3LAME_INCLUDE_DIR lame/lame.h)
+    find_library(MP3LAME_LIBRARY mp3lame)
+endif()
 
+if (MP3LAME_INCLUDE_DIR AND MP3LAME_LIBRARY)
+    message(STATUS "Using libmp3lame: ${MP3LAME_LIBRARY}")
+    add_definitions(-DUSE_LIBMP3LAME)
+    include_directories(${MP3LAME_INCLUDE_DIR})
+    list(APPEND NATIVE_ENCODERS_LIBRARIES ${MP3LAME_LIBRARY})
+
+    list(APPEND SOURCES
+      ${CMAKE_CURRENT_LIST_DIR}/mp3nativeencoder.h
+      ${CMAKE_CURRENT_LIST_DIR}/mp3nativeencoder.cpp
+    )
+endif()
@@ -75,32 +75,42 @@ static TagLib::ID3v2::Frame *addFrame(TagLib::ID3v2::Tag *tags, const TagLib::By
  ************************************************/
 void Mp3MetaDataWriter::setTags(const Track &track)
 {
-    TagLib::ID3v2::Tag *tags = mFile.ID3v2Tag(true);
+    setId3v2Tags(mFile.ID3v2Tag(true), track, isRemoveEmptyTags());
+}
 
-    if (!track.artist().isEmpty())
+/************************************************
+
+ ************************************************/
+void Mp3MetaDataWriter::setId3v2Tags(TagLib::ID3v2::Tag *tags, const Track &track, bool removeEmpty)
+{
+    // TagLib removes the frame for the empty value, on retag this clears the old one
+    if (removeEmpty || !track.artist().isEmpty())
         tags->setArtist(TagLib::String(track.artist().toUtf8().data(), TagLib::String::UTF8));
 
-    if (!track.album().isEmpty())
+    if (removeEmpty || !track.album().isEmpty())
         tags->setAlbum(TagLib::String(track.album().toUtf8().data(), TagLib::String::UTF8));
 
-    if (!track.genre().isEmpty())
+    if (removeEmpty || !track.genre().isEmpty())
         tags->setGenre(TagLib::String(track.genre().toUtf8().data(), TagLib::String::UTF8));
 
-    if (!track.title().isEmpty())
+    if (removeEmpty || !track.title().isEmpty())
         tags->setTitle(TagLib::String(track.title().toUtf8().data(), TagLib::String::UTF8));
 
-    if (!track.comment().isEmpty())
+    if (removeEmpty || !track.comment().isEmpty())
         tags->setComment(TagLib::String(track.comment().toUtf8().data(), TagLib::String::UTF8));
 
     {
         int year = track.date().toInt();
-        if (year)
+        if (removeEmpty || year)
             tags->setYear(year);
     }
 
     if (!track.tag(TagId::AlbumArtist).isEmpty()) {
         addFrame(tags, "TPE2")->setText(TagLib::String(track.tag(TagId::AlbumArtist).toUtf8().data(), TagLib::String::UTF8));
     }
+    else if (removeEmpty) {
+        tags->removeFrames("TPE2");
+    }
 
     addFrame(tags, "TRCK")->setText(QString("%1/%2").arg(track.trackNum()).arg(track.trackCount()).toStdString());
     addFrame(tags, "TPOS")->setText(QString("%1/%2").arg(track.discNum()).arg(track.discCount()).toStdString());
@@ -118,7 +128,22 @@ void Mp3MetaDataWriter::setEmbeddedCue(const QString &)
  ************************************************/
 void Mp3MetaDataWriter::setCoverImage(const CoverImage &image)
 {
-    TagLib::ID3v2::Tag                  *tags = mFile.ID3v2Tag(true);
+    setId3v2CoverImage(mFile.ID3v2Tag(true), image, isRemoveEmptyTags());
+}
+
+/************************************************
+
+ ************************************************/
+void Mp3MetaDataWriter::setId3v2CoverImage(TagLib::ID3v2::Tag *tags, const CoverImage &image, bool removeEmpty)
+{
+    if (removeEmpty) {
+        tags->removeFrames("APIC");
+    }
+
+    if (image.isEmpty()) {
+        return;
+    }
+
     TagLib::ID3v2::AttachedPictureFrame *apic = new TagLib::ID3v2::AttachedPictureFrame();
 
     TagLib::ByteVector img(image.data().data(), image.data().size());
@@ -135,22 +160,9 @@ void Mp3MetaDataWriter::setCoverImage(const CoverImage &image)
  ************************************************/
 void Mp3MetaDataWriter::setTrackReplayGain(float gain, float peak)
 {
-    using namespace TagLib::ID3v2;
-    Tag *tags = mFile.ID3v2Tag(true);
-
-    {
-        UserTextIdentificationFrame *frame = new UserTextIdentificationFrame();
-        frame->setDescription("replaygain_track_gain");
-        frame->setText(gainToString(gain).toStdString());
-        tags->addFrame(frame);
-    }
-
-    {
-        UserTextIdentificationFrame *frame = new UserTextIdentificationFrame();
-        frame->setDescription("replaygain_track_peak");
-        frame->setText(gainToString(peak).toStdString());
-        tags->addFrame(frame);
-    }
+    TagLib::ID3v2::Tag *tags = mFile.ID3v2Tag(true);
+    setId3v2UserText(tags, "replaygain_track_gain", gainToString(gain));
+    setId3v2UserText(tags, "replaygain_track_peak", gainToString(peak));
 }
 
 /************************************************
@@ -158,20 +170,21 @@ void Mp3MetaDataWriter::setTrackReplayGain(float gain, float peak)
  ************************************************/
 void Mp3MetaDataWriter::setAlbumReplayGain(float gain, float peak)
 {
-    using namespace TagLib::ID3v2;
-    Tag *tags = mFile.ID3v2Tag(true);
-
-    {
-        UserTextIdentificationFrame *frame = new UserTextIdentificationFrame();
-        frame->setDescription("replaygain_album_gain");
-        frame->setText(gainToString(gain).toStdString());
-        tags->addFrame(frame);
-    }
+    TagLib::ID3v2::Tag *tags = mFile.ID3v2Tag(true);
+    setId3v2UserText(tags, "replaygain_album_gain", gainToString(gain));
+    setId3v2UserText(tags, "replaygain_album_peak", gainToString(peak));
+}
 
-    {
-        UserTextIdentificationFrame *frame = new UserTextIdentificationFrame();
-        frame->setDescription("replaygain_album_peak");
-        frame->setText(gainToString(peak).toStdString());
+/************************************************
+ *
+ ************************************************/
+void Mp3MetaDataWriter::setId3v2UserText(TagLib::ID3v2::Tag *tags, const QString &description, const QString &value)
+{
+    TagLib::ID3v2::UserTextIdentificationFrame *frame = TagLib::ID3v2::UserTextIdentificationFrame::find(tags, description.toStdString());
+    if (!frame) {
+        frame = new TagLib::ID3v2::UserTextIdentificationFrame();
+        frame->setDescription(description.toStdString());
         tags->addFrame(frame);
     }
+    frame->setText(value.toStdString());
 }
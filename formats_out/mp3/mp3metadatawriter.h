@@ -28,6 +28,7 @@
 
 #include "../metadatawriter.h"
 #include <taglib/mpegfile.h>
+#include <taglib/id3v2tag.h>
 
 class Mp3MetaDataWriter : public MetadataWriter
 {
@@ -42,6 +43,11 @@ public:
     void setTrackReplayGain(float gain, float peak) override;
     void setAlbumReplayGain(float gain, float peak) override;
 
+    // Shared with Mp3NativeEncoder, which builds the tag without a file.
+    static void setId3v2Tags(TagLib::ID3v2::Tag *tags, const Track &track, bool removeEmpty = false);
+    static void setId3v2CoverImage(TagLib::ID3v2::Tag *tags, const CoverImage &image, bool removeEmpty = false);
+    static void setId3v2UserText(TagLib::ID3v2::Tag *tags, const QString &description, const QString &value);
+
 private:
     TagLib::MPEG::File mFile;
 };
@@ -0,0 +1,260 @@
+/* BEGIN_COMMON_COPYRIGHT_HEADER
+ * (c)LGPL2+
+ *
+ * Flacon - audio File Encoder
+ * https://github.com/flacon/flacon
+ *
+ * Copyright: 2024
+ *   Alexander Sokoloff <sokoloff.a@gmail.com>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * END_COMMON_COPYRIGHT_HEADER */
+
+#include "mp3nativeencoder.h"
+#include "mp3metadatawriter.h"
+#include "out_mp3.h"
+#include <lame/lame.h>
+#include <taglib/id3v1tag.h>
+#include <QLoggingCategory>
+
+namespace {
+Q_LOGGING_CATEGORY(LOG, "Mp3NativeEncoder")
+}
+
+using namespace Conv;
+
+/************************************************
+ *
+ ************************************************/
+Mp3NativeEncoder::Mp3NativeEncoder(const QString &filePath, const Settings &settings) :
+    NativeEncoder(filePath),
+    mSettings(settings),
+    mFile(filePath)
+{
+}
+
+/************************************************
+ *
+ ************************************************/
+Mp3NativeEncoder::~Mp3NativeEncoder()
+{
+    destroy();
+}
+
+/************************************************
+ *
+ ************************************************/
+void Mp3NativeEncoder::destroy()
+{
+    if (mLame) {
+        lame_close(mLame);
+        mLame = nullptr;
+    }
+    mFile.close();
+}
+
+/************************************************
+ * Same settings as the lame arguments in
+ * OutFormat_Mp3::encoderArgs
+ ************************************************/
+void Mp3NativeEncoder::applySettings()
+{
+    const QString &preset = mSettings.preset;
+
+    if (preset == VBR_MEDIUM) {
+        lame_set_preset(mLame, MEDIUM);
+    }
+
+    else if (preset == VBR_STATDARD) {
+        lame_set_preset(mLame, STANDARD);
+    }
+
+    else if (preset == VBR_EXTRIME) {
+        lame_set_preset(mLame, EXTREME);
+    }
+
+    else if (preset == CBR_INSANE) {
+        lame_set_preset(mLame, INSANE);
+    }
+
+    else if (preset == CBR_KBPS) {
+        lame_set_VBR(mLame, vbr_off);
+        lame_set_brate(mLame, mSettings.bitrate);
+    }
+
+    else if (preset == ABR_KBPS) {
+        lame_set_preset(mLame, mSettings.bitrate);
+    }
+
+    else if (preset == VBR_QUALITY) {
+        lame_set_VBR(mLame, vbr_default);
+        lame_set_VBR_quality(mLame, 9 - mSettings.quality);
+    }
+
+    lame_set_findReplayGain(mLame, mSettings.replayGain ? 1 : 0);
+}
+
+/************************************************
+ * The ID3v2 tag is rendered with padding, so the
+ * gain frames written later by Mp3MetaDataWriter
+ * fit in place. The first MP3 frame is the
+ * placeholder for the LAME/Xing header.
+ ************************************************/
+void Mp3NativeEncoder::open(const WavHeader &wav)
+{
+    mWav = wav;
+
+    if (wav.numChannels() < 1 || wav.numChannels() > 2) {
+        throw FlaconError(QString("MP3 supports only mono and stereo, the audio has %1 channels").arg(wav.numChannels()));
+    }
+
+    if (!mFile.open(QFile::WriteOnly | QFile::Truncate)) {
+        throw FlaconError(mFile.errorString());
+    }
+
+    mLame = lame_init();
+    if (!mLame) {
+        throw FlaconError("Can't allocate memory");
+    }
+
+    lame_set_num_channels(mLame, wav.numChannels());
+    lame_set_in_samplerate(mLame, wav.sampleRate());
+    lame_set_write_id3tag_automatic(mLame, 0);
+    lame_set_bWriteVbrTag(mLame, 1);
+    applySettings();
+
+    if (lame_init_params(mLame) < 0) {
+        throw FlaconError("Can't initialize the LAME encoder");
+    }
+
+    TagLib::ByteVector tag = mTags.render();
+    writeData(tag.data(), tag.size());
+    mAudioStart = mFile.pos();
+
+    qCDebug(LOG) << "Start encoder:" << filePath() << "rate:" << wav.sampleRate() << "channels:" << wav.numChannels() << "preset:" << mSettings.preset;
+}
+
+/************************************************
+ *
+ ************************************************/
+void Mp3NativeEncoder::writeData(const char *data, qint64 size)
+{
+    if (mFile.write(data, size) != size) {
+        throw FlaconError(mFile.errorString());
+    }
+}
+
+/************************************************
+ *
+ ************************************************/
+void Mp3NativeEncoder::write(const char *data, qint64 size)
+{
+    toFloat(mWav, data, size, &mBuffer);
+
+    const int    channels = mWav.numChannels();
+    const int    frames   = mBuffer.size() / channels;
+    const float *src      = mBuffer.constData();
+
+    mLeft.resize(frames);
+    mRight.resize(frames);
+    for (int i = 0; i < frames; ++i) {
+        mLeft[i]  = src[i * channels];
+        mRight[i] = src[i * channels + channels - 1];
+    }
+
+    // The worst case from lame.h
+    mMp3Buffer.resize(frames * 5 / 4 + 7200);
+
+    int res = lame_encode_buffer_ieee_float(mLame, mLeft.constData(), mRight.constData(), frames,
+                                            reinterpret_cast<unsigned char *>(mMp3Buffer.data()), mMp3Buffer.size());
+    if (res < 0) {
+        throw FlaconError(QString("LAME encoder error %1").arg(res));
+    }
+
+    writeData(mMp3Buffer.constData(), res);
+}
+
+/************************************************
+ * The LAME tag is known only at the end, it
+ * replaces the placeholder frame. The ID3v1 tag
+ * is appended as MPEG::File::save does.
+ ************************************************/
+void Mp3NativeEncoder::save()
+{
+    mMp3Buffer.resize(7200);
+    int res = lame_encode_flush(mLame, reinterpret_cast<unsigned char *>(mMp3Buffer.data()), mMp3Buffer.size());
+    if (res < 0) {
+        throw FlaconError(QString("LAME encoder error %1").arg(res));
+    }
+    writeData(mMp3Buffer.constData(), res);
+
+    unsigned char lameTag[2880];
+    size_t        lameTagSize = lame_get_lametag_frame(mLame, lameTag, sizeof(lameTag));
+    if (lameTagSize > 0 && lameTagSize <= sizeof(lameTag)) {
+        const qint64 end = mFile.pos();
+        mFile.seek(mAudioStart);
+        writeData(reinterpret_cast<const char *>(lameTag), qint64(lameTagSize));
+        mFile.seek(end);
+    }
+
+    TagLib::ID3v1::Tag id3v1;
+    TagLib::Tag::duplicate(&mTags, &id3v1, true);
+    TagLib::ByteVector tag = id3v1.render();
+    writeData(tag.data(), tag.size());
+
+    destroy();
+}
+
+/************************************************
+ *
+ ************************************************/
+void Mp3NativeEncoder::setTags(const Track &track)
+{
+    Mp3MetaDataWriter::setId3v2Tags(&mTags, track);
+}
+
+/************************************************
+ *
+ ************************************************/
+void Mp3NativeEncoder::setEmbeddedCue(const QString &)
+{
+}
+
+/************************************************
+ *
+ ************************************************/
+void Mp3NativeEncoder::setCoverImage(const CoverImage &image)
+{
+    Mp3MetaDataWriter::setId3v2CoverImage(&mTags, image);
+}
+
+/************************************************
+ *
+ ************************************************/
+void Mp3NativeEncoder::setTrackReplayGain(float gain, float peak)
+{
+    Mp3MetaDataWriter::setId3v2UserText(&mTags, "replaygain_track_gain", gainToString(gain));
+    Mp3MetaDataWriter::setId3v2UserText(&mTags, "replaygain_track_peak", gainToString(peak));
+}
+
+/************************************************
+ *
+ ************************************************/
+void Mp3NativeEncoder::setAlbumReplayGain(float gain, float peak)
+{
+    Mp3MetaDataWriter::setId3v2UserText(&mTags, "replaygain_album_gain", gainToString(gain));
+    Mp3MetaDataWriter::setId3v2UserText(&mTags, "replaygain_album_peak", gainToString(peak));
+}
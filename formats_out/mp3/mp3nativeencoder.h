@@ -0,0 +1,77 @@
+/* BEGIN_COMMON_COPYRIGHT_HEADER
+ * (c)LGPL2+
+ *
+ * Flacon - audio File Encoder
+ * https://github.com/flacon/flacon
+ *
+ * Copyright: 2024
+ *   Alexander Sokoloff <sokoloff.a@gmail.com>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * END_COMMON_COPYRIGHT_HEADER */
+
+#ifndef MP3NATIVEENCODER_H
+#define MP3NATIVEENCODER_H
+
+#include "../nativeencoder.h"
+#include <QFile>
+#include <taglib/id3v2tag.h>
+
+struct lame_global_struct;
+
+class Mp3NativeEncoder : public NativeEncoder
+{
+public:
+    struct Settings
+    {
+        QString preset;
+        int     bitrate    = 0; // kbps, for the CBR and ABR presets
+        int     quality    = 0; // 0 .. 9, for the VBR quality preset
+        bool    replayGain = false;
+    };
+
+    Mp3NativeEncoder(const QString &filePath, const Settings &settings);
+    ~Mp3NativeEncoder() override;
+
+    void open(const Conv::WavHeader &wav) override;
+    void write(const char *data, qint64 size) override;
+    void save() override;
+
+    void setTags(const Track &track) override;
+    void setEmbeddedCue(const QString &cue) override;
+    void setCoverImage(const CoverImage &image) override;
+
+    void setTrackReplayGain(float gain, float peak) override;
+    void setAlbumReplayGain(float gain, float peak) override;
+
+private:
+    Settings            mSettings;
+    TagLib::ID3v2::Tag  mTags;
+    QFile               mFile;
+    lame_global_struct *mLame = nullptr;
+    Conv::WavHeader     mWav;
+    QVector<float>      mBuffer;
+    QVector<float>      mLeft;
+    QVector<float>      mRight;
+    QByteArray          mMp3Buffer;
+    qint64              mAudioStart = 0;
+
+    void applySettings();
+    void writeData(const char *data, qint64 size);
+    void destroy();
+};
+
+#endif // MP3NATIVEENCODER_H
@@ -27,13 +27,9 @@
 #include "mp3metadatawriter.h"
 #include <QDebug>
 
-static constexpr char VBR_MEDIUM[]   = "vbrMedium";
-static constexpr char VBR_STATDARD[] = "vbrStandard";
-static constexpr char VBR_EXTRIME[]  = "vbrExtreme";
-static constexpr char VBR_QUALITY[]  = "vbrQuality";
-static constexpr char CBR_INSANE[]   = "cbrInsane";
-static constexpr char CBR_KBPS[]     = "cbrKbps";
-static constexpr char ABR_KBPS[]     = "abrKbps";
+#ifdef USE_LIBMP3LAME
+#include "mp3nativeencoder.h"
+#endif
 
 /************************************************
 
@@ -141,6 +137,26 @@ MetadataWriter *OutFormat_Mp3::createMetadataWriter(const QString &filePath) con
     return new Mp3MetaDataWriter(filePath);
 }
 
+/************************************************
+ *
+ ************************************************/
+NativeEncoder *OutFormat_Mp3::createNativeEncoder(const Profile &profile, const QString &filePath) const
+{
+#ifdef USE_LIBMP3LAME
+    Mp3NativeEncoder::Settings settings;
+    settings.preset     = profile.encoderValue("Preset").toString();
+    settings.bitrate    = profile.encoderValue("Bitrate").toInt();
+    settings.quality    = profile.encoderValue("Quality").toInt();
+    settings.replayGain = strToGainType(profile.encoderValue("ReplayGain").toString()) == GainType::Track;
+
+    return new Mp3NativeEncoder(filePath, settings);
+#else
+    Q_UNUSED(profile)
+    Q_UNUSED(filePath)
+    return nullptr;
+#endif
+}
+
 /************************************************
 
  ************************************************/
@@ -32,6 +32,14 @@
 #include "../converter/encoder.h"
 #include "../metadatawriter.h"
 
+static constexpr char VBR_MEDIUM[]   = "vbrMedium";
+static constexpr char VBR_STATDARD[] = "vbrStandard";
+static constexpr char VBR_EXTRIME[]  = "vbrExtreme";
+static constexpr char VBR_QUALITY[]  = "vbrQuality";
+static constexpr char CBR_INSANE[]   = "cbrInsane";
+static constexpr char CBR_KBPS[]     = "cbrKbps";
+static constexpr char ABR_KBPS[]     = "abrKbps";
+
 class OutFormat_Mp3 : public OutFormat
 {
 public:
@@ -48,6 +56,7 @@ public:
     QStringList encoderArgs(const Profile &profile, const QString &outFile) const override;
 
     MetadataWriter *createMetadataWriter(const QString &filePath) const override;
+    NativeEncoder  *createNativeEncoder(const Profile &profile, const QString &filePath) const override;
 };
 
 class ConfigPage_Mp3 : public EncoderConfigPage, private Ui::mp3ConfigPage
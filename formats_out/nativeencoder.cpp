@@ -0,0 +1,166 @@
+/* BEGIN_COMMON_COPYRIGHT_HEADER
+ * (c)LGPL2+
+ *
+ * Flacon - audio File Encoder
+ * https://github.com/flacon/flacon
+ *
+ * Copyright: 2024
+ *   Alexander Sokoloff <sokoloff.a@gmail.com>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * END_COMMON_COPYRIGHT_HEADER */
+
+#include "nativeencoder.h"
+#include <QtEndian>
+#include <cstring>
+
+using namespace Conv;
+
+/************************************************
+ *
+ ************************************************/
+NativeEncoder::NativeEncoder(const QString &filePath) :
+    MetadataWriter(filePath),
+    mFilePath(filePath)
+{
+}
+
+/************************************************
+ * The WAV data is interleaved little-endian PCM,
+ * 8-bit samples are unsigned.
+ ************************************************/
+static inline qint32 readSample(const uchar *p, int bytesPerSample)
+{
+    switch (bytesPerSample) {
+        case 1:
+            return qint32(p[0]) - 128;
+        case 2:
+            return qFromLittleEndian<qint16>(p);
+        case 3:
+            return qint32(quint32(p[0]) << 8 | quint32(p[1]) << 16 | quint32(p[2]) << 24) >> 8;
+        case 4:
+            return qFromLittleEndian<qint32>(p);
+    }
+    return 0;
+}
+
+/************************************************
+ * Converts the interleaved samples to floats in
+ * the [-1.0, 1.0) range
+ ************************************************/
+void NativeEncoder::toFloat(const WavHeader &wav, const char *data, qint64 size, QVector<float> *out)
+{
+    const int bytesPerSample = wav.bitsPerSample() / 8;
+    const int count          = bytesPerSample ? int(size / bytesPerSample) : 0;
+    out->resize(count);
+
+    const uchar *p   = reinterpret_cast<const uchar *>(data);
+    float       *dst = out->data();
+
+    if (wav.sampleFormat() == WavHeader::Format_IEEE_FLOAT) {
+        for (int i = 0; i < count; ++i, p += bytesPerSample) {
+            if (bytesPerSample == 8) {
+                quint64 bits = qFromLittleEndian<quint64>(p);
+                double  value;
+                std::memcpy(&value, &bits, sizeof(value));
+                dst[i] = float(value);
+            }
+            else {
+                quint32 bits = qFromLittleEndian<quint32>(p);
+                std::memcpy(&dst[i], &bits, sizeof(float));
+            }
+        }
+        return;
+    }
+
+    const float scale = 1.0f / float(1u << (bytesPerSample * 8 - 1));
+    for (int i = 0; i < count; ++i, p += bytesPerSample) {
+        dst[i] = readSample(p, bytesPerSample) * scale;
+    }
+}
+
+/************************************************
+ * Converts the interleaved samples to 32-bit
+ * integers, the values keep the source bit depth.
+ ************************************************/
+void NativeEncoder::toInt32(const WavHeader &wav, const char *data, qint64 size, QVector<qint32> *out)
+{
+    const int bytesPerSample = wav.bitsPerSample() / 8;
+    const int count          = bytesPerSample ? int(size / bytesPerSample) : 0;
+    out->resize(count);
+
+    const uchar *p   = reinterpret_cast<const uchar *>(data);
+    qint32      *dst = out->data();
+    for (int i = 0; i < count; ++i, p += bytesPerSample) {
+        dst[i] = readSample(p, bytesPerSample);
+    }
+}
+
+/************************************************
+ * WAV and Vorbis use different channel orders for
+ * the multichannel audio, see
+ *   https://xiph.org/vorbis/doc/Vorbis_I_spec.html#x1-810004.3.9
+ ************************************************/
+void NativeEncoder::toVorbisChannelOrder(int channels, QVector<float> *samples)
+{
+    // clang-format off
+    static const int order[8][8] = {
+        { 0 },                      // 1.0 mono
+        { 0, 1 },                   // 2.0 stereo
+        { 0, 2, 1 },                // 3.0 channel ('wide') stereo
+        { 0, 1, 2, 3 },             // 4.0 discrete quadraphonic
+        { 0, 2, 1, 3, 4 },          // 5.0 surround
+        { 0, 2, 1, 4, 5, 3 },       // 5.1 surround
+        { 0, 2, 1, 5, 6, 4, 3 },    // 6.1 surround
+        { 0, 2, 1, 6, 7, 4, 5, 3 }, // 7.1 surround
+    };
+    // clang-format on
+
+    if (channels < 3 || channels > 8) {
+        return;
+    }
+
+    float  frame[8];
+    float *p   = samples->data();
+    float *end = p + samples->size() - channels + 1;
+    for (; p < end; p += channels) {
+        std::memcpy(frame, p, channels * sizeof(float));
+        for (int c = 0; c < channels; ++c) {
+            p[c] = frame[order[channels - 1][c]];
+        }
+    }
+}
+
+/************************************************
+ * The Vorbis mapping doesn't tell the back and side
+ * surround apart, so 5.x may use any of them.
+ * The stream without a mask has the default layout.
+ ************************************************/
+bool NativeEncoder::hasVorbisChannelLayout(const WavHeader &wav)
+{
+    static constexpr quint32 BACK = 0x0030; // BL BR
+    static constexpr quint32 SIDE = 0x0600; // SL SR
+
+    const int     channels = wav.numChannels();
+    const quint32 mask     = wav.channelMask();
+    const quint32 def      = WavHeader::defaultChannelMask(channels);
+
+    if (channels <= 2 || mask == 0 || mask == def) {
+        return true;
+    }
+
+    return (channels == 5 || channels == 6) && mask == ((def & ~BACK) | SIDE);
+}
@@ -0,0 +1,71 @@
+/* BEGIN_COMMON_COPYRIGHT_HEADER
+ * (c)LGPL2+
+ *
+ * Flacon - audio File Encoder
+ * https://github.com/flacon/flacon
+ *
+ * Copyright: 2024
+ *   Alexander Sokoloff <sokoloff.a@gmail.com>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * END_COMMON_COPYRIGHT_HEADER */
+
+#ifndef NATIVEENCODER_H
+#define NATIVEENCODER_H
+
+#include <QVector>
+#include "metadatawriter.h"
+#include "converter/wavheader.h"
+
+/************************************************
+ * The encoder that works in-process, without an
+ * external program.
+ *
+ * All tags are set before open(), so they are
+ * written at stream creation and the file
+ * doesn't need to be rewritten afterwards.
+ * save() finishes the stream.
+ ************************************************/
+class NativeEncoder : public MetadataWriter
+{
+public:
+    explicit NativeEncoder(const QString &filePath);
+
+    virtual void open(const Conv::WavHeader &wav)       = 0;
+    virtual void write(const char *data, qint64 size) = 0;
+
+    /// The encoder accepts any sample rate, the external resampler is not needed.
+    virtual bool isResampling() const { return false; }
+
+    /// The external encoder is used for the streams the encoder can't handle.
+    virtual bool isSupported(const Conv::WavHeader &) const { return true; }
+
+protected:
+    QString filePath() const { return mFilePath; }
+
+    static void toFloat(const Conv::WavHeader &wav, const char *data, qint64 size, QVector<float> *out);
+    static void toInt32(const Conv::WavHeader &wav, const char *data, qint64 size, QVector<qint32> *out);
+
+    static void toVorbisChannelOrder(int channels, QVector<float> *samples);
+
+    /// The speaker mask of the stream matches the layout toVorbisChannelOrder() expects.
+    static bool hasVorbisChannelLayout(const Conv::WavHeader &wav);
+
+private:
+    QString mFilePath;
+};
+
+#endif // NATIVEENCODER_H
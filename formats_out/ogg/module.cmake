@@ -7,3 +7,22 @@ list(APPEND SOURCES
   ${CMAKE_CURRENT_LIST_DIR}/oggmetadatawriter.h
   ${CMAKE_CURRENT_LIST_DIR}/oggmetadatawriter.cpp
 )
+
+option(USE_LIBVORBISENC "Encode Ogg Vorbis in-process with libvorbisenc when it's available" ON)
+if (USE_LIBVORBISENC)
+    find_package(PkgConfig)
+    pkg_search_module(VORBISENC vorbisenc)
+endif()
+
+if (VORBISENC_FOUND)
+    message(STATUS "Using libvorbisenc version: ${VORBISENC_VERSION}")
+    add_definitions(-DUSE_LIBVORBISENC)
+    include_directories(${VORBISENC_INCLUDE_DIRS})
+    link_directories(${VORBISENC_LIBRARY_DIRS})
+    list(APPEND NATIVE_ENCODERS_LIBRARIES ${VORBISENC_LIBRARIES})
+
+    list(APPEND SOURCES
+      ${CMAKE_CURRENT_LIST_DIR}/vorbisnativeencoder.h
+      ${CMAKE_CURRENT_LIST_DIR}/vorbisnativeencoder.cpp
+    )
+endif()
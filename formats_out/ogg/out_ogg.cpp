@@ -29,6 +29,10 @@
 #include "oggmetadatawriter.h"
 #include <QByteArray>
 
+#ifdef USE_LIBVORBISENC
+#include "vorbisnativeencoder.h"
+#endif
+
 /************************************************
 
  ************************************************/
@@ -112,6 +116,33 @@ MetadataWriter *OutFormat_Ogg::createMetadataWriter(const QString &filePath) con
     return new OggMetaDataWriter(filePath);
 }
 
+/************************************************
+ *
+ ************************************************/
+NativeEncoder *OutFormat_Ogg::createNativeEncoder(const Profile &profile, const QString &filePath) const
+{
+#ifdef USE_LIBVORBISENC
+    auto bitrate = [&profile](const QString &key) -> long {
+        bool ok  = false;
+        int  val = profile.encoderValue(key).toInt(&ok);
+        return ok && val > 0 ? val * 1000L : -1;
+    };
+
+    VorbisNativeEncoder::Settings settings;
+    settings.useQuality  = profile.encoderValue("UseQuality").toBool();
+    settings.quality     = profile.encoderValue("Quality").toFloat();
+    settings.minBitrate  = bitrate("MinBitrate");
+    settings.normBitrate = bitrate("NormBitrate");
+    settings.maxBitrate  = bitrate("MaxBitrate");
+
+    return new VorbisNativeEncoder(filePath, settings);
+#else
+    Q_UNUSED(profile)
+    Q_UNUSED(filePath)
+    return nullptr;
+#endif
+}
+
 /************************************************
 
  ************************************************/
@@ -48,6 +48,7 @@ public:
     QStringList encoderArgs(const Profile &profile, const QString &outFile) const override;
 
     MetadataWriter *createMetadataWriter(const QString &filePath) const override;
+    NativeEncoder  *createNativeEncoder(const Profile &profile, const QString &filePath) const override;
 };
 
 class ConfigPage_Ogg : public EncoderConfigPage, private Ui::oggConfigPage
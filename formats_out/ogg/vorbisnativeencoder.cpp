@@ -0,0 +1,260 @@
+/* BEGIN_COMMON_COPYRIGHT_HEADER
+ * (c)LGPL2+
+ *
+ * Flacon - audio File Encoder
+ * https://github.com/flacon/flacon
+ *
+ * Copyright: 2024
+ *   Alexander Sokoloff <sokoloff.a@gmail.com>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * END_COMMON_COPYRIGHT_HEADER */
+
+#include "vorbisnativeencoder.h"
+#include <QRandomGenerator>
+#include <QLoggingCategory>
+
+namespace {
+Q_LOGGING_CATEGORY(LOG, "VorbisNativeEncoder")
+}
+
+using namespace Conv;
+
+/************************************************
+ *
+ ************************************************/
+VorbisNativeEncoder::VorbisNativeEncoder(const QString &filePath, const Settings &settings) :
+    NativeEncoder(filePath),
+    mSettings(settings),
+    mFile(filePath)
+{
+}
+
+/************************************************
+ *
+ ************************************************/
+VorbisNativeEncoder::~VorbisNativeEncoder()
+{
+    destroy();
+}
+
+/************************************************
+ *
+ ************************************************/
+void VorbisNativeEncoder::destroy()
+{
+    if (mOpened) {
+        ogg_stream_clear(&mStream);
+        vorbis_block_clear(&mBlock);
+        vorbis_dsp_clear(&mDsp);
+        vorbis_comment_clear(&mComment);
+        vorbis_info_clear(&mInfo);
+        mOpened = false;
+    }
+    mFile.close();
+}
+
+/************************************************
+ * Without quality and bitrates oggenc uses the
+ * quality 3, we do the same.
+ ************************************************/
+void VorbisNativeEncoder::initEncoder(int channels, long sampleRate)
+{
+    vorbis_info_init(&mInfo);
+
+    const Settings &s       = mSettings;
+    const bool      bitrate = !s.useQuality && (s.minBitrate > 0 || s.normBitrate > 0 || s.maxBitrate > 0);
+
+    int err = 0;
+    if (bitrate) {
+        err = vorbis_encode_init(&mInfo, channels, sampleRate, s.maxBitrate, s.normBitrate, s.minBitrate);
+    }
+    else {
+        float quality = s.useQuality ? s.quality : 3;
+        err           = vorbis_encode_init_vbr(&mInfo, channels, sampleRate, qBound(-1.0f, quality, 10.0f) / 10.0f);
+    }
+
+    if (err) {
+        vorbis_info_clear(&mInfo);
+        throw FlaconError(QString("Can't initialize the Vorbis encoder, the error code is %1").arg(err));
+    }
+}
+
+/************************************************
+ * The streams with other speaker layouts are left
+ * to the external encoder, it remaps the channels.
+ ************************************************/
+bool VorbisNativeEncoder::isSupported(const WavHeader &wav) const
+{
+    return hasVorbisChannelLayout(wav);
+}
+
+/************************************************
+ * The three header packets are flushed on their
+ * own pages, so the audio starts on a new page.
+ ************************************************/
+void VorbisNativeEncoder::open(const WavHeader &wav)
+{
+    mWav = wav;
+
+    if (!mFile.open(QFile::WriteOnly | QFile::Truncate)) {
+        throw FlaconError(mFile.errorString());
+    }
+
+    initEncoder(wav.numChannels(), wav.sampleRate());
+
+    vorbis_comment_init(&mComment);
+    const TagLib::Ogg::FieldListMap &fields = mTags.fieldListMap();
+    for (auto it = fields.begin(); it != fields.end(); ++it) {
+        for (const TagLib::String &value : it->second) {
+            vorbis_comment_add_tag(&mComment, it->first.toCString(true), value.toCString(true));
+        }
+    }
+
+    vorbis_analysis_init(&mDsp, &mInfo);
+    vorbis_block_init(&mDsp, &mBlock);
+    ogg_stream_init(&mStream, int(QRandomGenerator::global()->generate() & 0x7FFFFFFF));
+    mOpened = true;
+
+    ogg_packet header;
+    ogg_packet comment;
+    ogg_packet codebooks;
+    vorbis_analysis_headerout(&mDsp, &mComment, &header, &comment, &codebooks);
+    ogg_stream_packetin(&mStream, &header);
+    ogg_stream_packetin(&mStream, &comment);
+    ogg_stream_packetin(&mStream, &codebooks);
+
+    ogg_page page;
+    while (ogg_stream_flush(&mStream, &page)) {
+        writePage(page);
+    }
+
+    qCDebug(LOG) << "Start encoder:" << filePath() << "rate:" << wav.sampleRate() << "channels:" << wav.numChannels();
+}
+
+/************************************************
+ *
+ ************************************************/
+void VorbisNativeEncoder::write(const char *data, qint64 size)
+{
+    const int channels = mWav.numChannels();
+
+    toFloat(mWav, data, size, &mBuffer);
+    toVorbisChannelOrder(channels, &mBuffer);
+
+    const int frames = mBuffer.size() / channels;
+    float   **buffer = vorbis_analysis_buffer(&mDsp, frames);
+
+    const float *src = mBuffer.constData();
+    for (int i = 0; i < frames; ++i) {
+        for (int c = 0; c < channels; ++c) {
+            buffer[c][i] = *src++;
+        }
+    }
+
+    vorbis_analysis_wrote(&mDsp, frames);
+    encodeBlocks();
+}
+
+/************************************************
+ *
+ ************************************************/
+void VorbisNativeEncoder::encodeBlocks()
+{
+    ogg_packet packet;
+    ogg_page   page;
+
+    while (vorbis_analysis_blockout(&mDsp, &mBlock) == 1) {
+        vorbis_analysis(&mBlock, nullptr);
+        vorbis_bitrate_addblock(&mBlock);
+
+        while (vorbis_bitrate_flushpacket(&mDsp, &packet)) {
+            ogg_stream_packetin(&mStream, &packet);
+
+            while (ogg_stream_pageout(&mStream, &page)) {
+                writePage(page);
+            }
+        }
+    }
+}
+
+/************************************************
+ *
+ ************************************************/
+void VorbisNativeEncoder::writePage(const ogg_page &page)
+{
+    if (mFile.write(reinterpret_cast<const char *>(page.header), page.header_len) != page.header_len ||
+        mFile.write(reinterpret_cast<const char *>(page.body), page.body_len) != page.body_len) {
+        throw FlaconError(mFile.errorString());
+    }
+}
+
+/************************************************
+ * The end of the stream, the last packets are
+ * flushed with the EOS page.
+ ************************************************/
+void VorbisNativeEncoder::save()
+{
+    vorbis_analysis_wrote(&mDsp, 0);
+    encodeBlocks();
+
+    ogg_page page;
+    while (ogg_stream_flush(&mStream, &page)) {
+        writePage(page);
+    }
+
+    destroy();
+}
+
+/************************************************
+ *
+ ************************************************/
+void VorbisNativeEncoder::setTags(const Track &track)
+{
+    setXiphTags(&mTags, track);
+}
+
+/************************************************
+ *
+ ************************************************/
+void VorbisNativeEncoder::setEmbeddedCue(const QString &cue)
+{
+    setXiphEmbeddedCue(&mTags, cue);
+}
+
+/************************************************
+ *
+ ************************************************/
+void VorbisNativeEncoder::setCoverImage(const CoverImage &image)
+{
+    setXiphCoverImage(&mTags, image);
+}
+
+/************************************************
+ *
+ ************************************************/
+void VorbisNativeEncoder::setTrackReplayGain(float gain, float peak)
+{
+    setXiphTrackReplayGain(&mTags, gain, peak);
+}
+
+/************************************************
+ *
+ ************************************************/
+void VorbisNativeEncoder::setAlbumReplayGain(float gain, float peak)
+{
+    setXiphAlbumReplayGain(&mTags, gain, peak);
+}
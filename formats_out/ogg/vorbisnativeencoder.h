@@ -0,0 +1,82 @@
+/* BEGIN_COMMON_COPYRIGHT_HEADER
+ * (c)LGPL2+
+ *
+ * Flacon - audio File Encoder
+ * https://github.com/flacon/flacon
+ *
+ * Copyright: 2024
+ *   Alexander Sokoloff <sokoloff.a@gmail.com>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * END_COMMON_COPYRIGHT_HEADER */
+
+#ifndef VORBISNATIVEENCODER_H
+#define VORBISNATIVEENCODER_H
+
+#include "../nativeencoder.h"
+#include <QFile>
+#include <taglib/xiphcomment.h>
+#include <vorbis/vorbisenc.h>
+
+class VorbisNativeEncoder : public NativeEncoder
+{
+public:
+    struct Settings
+    {
+        bool  useQuality  = true;
+        float quality     = 0;  // -1 .. 10, as in oggenc
+        long  minBitrate  = -1; // bits per second, -1 is not set
+        long  normBitrate = -1;
+        long  maxBitrate  = -1;
+    };
+
+    VorbisNativeEncoder(const QString &filePath, const Settings &settings);
+    ~VorbisNativeEncoder() override;
+
+    void open(const Conv::WavHeader &wav) override;
+    void write(const char *data, qint64 size) override;
+    void save() override;
+
+    bool isSupported(const Conv::WavHeader &wav) const override;
+
+    void setTags(const Track &track) override;
+    void setEmbeddedCue(const QString &cue) override;
+    void setCoverImage(const CoverImage &image) override;
+
+    void setTrackReplayGain(float gain, float peak) override;
+    void setAlbumReplayGain(float gain, float peak) override;
+
+private:
+    Settings                 mSettings;
+    TagLib::Ogg::XiphComment mTags;
+    QFile                    mFile;
+    Conv::WavHeader          mWav;
+    QVector<float>           mBuffer;
+    bool                     mOpened = false;
+
+    vorbis_info      mInfo;
+    vorbis_comment   mComment;
+    vorbis_dsp_state mDsp;
+    vorbis_block     mBlock;
+    ogg_stream_state mStream;
+
+    void initEncoder(int channels, long sampleRate);
+    void encodeBlocks();
+    void writePage(const ogg_page &page);
+    void destroy();
+};
+
+#endif // VORBISNATIVEENCODER_H
@@ -7,3 +7,22 @@ list(APPEND SOURCES
   ${CMAKE_CURRENT_LIST_DIR}/opusmetadatawriter.h
   ${CMAKE_CURRENT_LIST_DIR}/opusmetadatawriter.cpp
 )
+
+option(USE_LIBOPUSENC "Encode Opus in-process with libopusenc when it's available" ON)
+if (USE_LIBOPUSENC)
+    find_package(PkgConfig)
+    pkg_search_module(OPUSENC libopusenc)
+endif()
+
+if (OPUSENC_FOUND)
+    message(STATUS "Using libopusenc version: ${OPUSENC_VERSION}")
+    add_definitions(-DUSE_LIBOPUSENC)
+    include_directories(${OPUSENC_INCLUDE_DIRS})
+    link_directories(${OPUSENC_LIBRARY_DIRS})
+    list(APPEND NATIVE_ENCODERS_LIBRARIES ${OPUSENC_LIBRARIES})
+
+    list(APPEND SOURCES
+      ${CMAKE_CURRENT_LIST_DIR}/opusnativeencoder.h
+      ${CMAKE_CURRENT_LIST_DIR}/opusnativeencoder.cpp
+    )
+endif()
@@ -91,6 +91,7 @@ void OpusMetadataWriter::setTrackReplayGain(float gain, float peak)
 {
     TagLib::Ogg::XiphComment *tags = mFile.tag();
     setXiphTrackReplayGain(tags, gain, peak);
+    setXiphTag(tags, "R128_TRACK_GAIN", r128Gain(gain));
 }
 
 /************************************************
@@ -101,4 +102,15 @@ void OpusMetadataWriter::setAlbumReplayGain(float gain, float peak)
 {
     TagLib::Ogg::XiphComment *tags = mFile.tag();
     setXiphAlbumReplayGain(tags, gain, peak);
+    setXiphTag(tags, "R128_ALBUM_GAIN", r128Gain(gain));
+}
+
+/************************************************
+  ReplayGain is relative to -18 LUFS, R128 gain is
+  relative to -23 LUFS and is stored as a Q7.8
+  fixed point number, see RFC 7845 section 5.2.1
+ ************************************************/
+QString OpusMetadataWriter::r128Gain(float gain)
+{
+    return QString::number(qBound(-32768, qRound((gain - 5.0f) * 256.0f), 32767));
 }
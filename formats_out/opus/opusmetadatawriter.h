@@ -42,6 +42,8 @@ public:
     void setTrackReplayGain(float gain, float peak) override;
     void setAlbumReplayGain(float gain, float peak) override;
 
+    static QString r128Gain(float gain);
+
 private:
     TagLib::Ogg::Opus::File mFile;
 };
@@ -0,0 +1,208 @@
+/* BEGIN_COMMON_COPYRIGHT_HEADER
+ * (c)LGPL2+
+ *
+ * Flacon - audio File Encoder
+ * https://github.com/flacon/flacon
+ *
+ * Copyright: 2024
+ *   Alexander Sokoloff <sokoloff.a@gmail.com>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * END_COMMON_COPYRIGHT_HEADER */
+
+#include "opusnativeencoder.h"
+#include "opusmetadatawriter.h"
+#include <opusenc.h>
+#include <QLoggingCategory>
+
+namespace {
+Q_LOGGING_CATEGORY(LOG, "OpusNativeEncoder")
+}
+
+using namespace Conv;
+
+/************************************************
+ *
+ ************************************************/
+static int writeCallback(void *userData, const unsigned char *ptr, opus_int32 len)
+{
+    QFile *file = static_cast<QFile *>(userData);
+    return file->write(reinterpret_cast<const char *>(ptr), len) == len ? 0 : 1;
+}
+
+/************************************************
+ *
+ ************************************************/
+static int closeCallback(void *userData)
+{
+    static_cast<QFile *>(userData)->close();
+    return 0;
+}
+
+/************************************************
+ *
+ ************************************************/
+OpusNativeEncoder::OpusNativeEncoder(const QString &filePath, const QString &bitrateType, int bitrate) :
+    NativeEncoder(filePath),
+    mBitrateType(bitrateType),
+    mBitrate(bitrate),
+    mFile(filePath)
+{
+}
+
+/************************************************
+ *
+ ************************************************/
+OpusNativeEncoder::~OpusNativeEncoder()
+{
+    destroy();
+}
+
+/************************************************
+ *
+ ************************************************/
+void OpusNativeEncoder::destroy()
+{
+    if (mEncoder) {
+        ope_encoder_destroy(mEncoder);
+        mEncoder = nullptr;
+    }
+    mFile.close();
+}
+
+/************************************************
+ * The streams with other speaker layouts are left
+ * to the external encoder, it remaps the channels.
+ ************************************************/
+bool OpusNativeEncoder::isSupported(const WavHeader &wav) const
+{
+    return hasVorbisChannelLayout(wav);
+}
+
+/************************************************
+ * The OpusTags packet is written with the first
+ * page, so all tags must be set before.
+ * libopusenc resamples any input rate to 48 kHz.
+ ************************************************/
+void OpusNativeEncoder::open(const WavHeader &wav)
+{
+    mWav = wav;
+
+    if (!mFile.open(QFile::WriteOnly | QFile::Truncate)) {
+        throw FlaconError(mFile.errorString());
+    }
+
+    OggOpusComments *comments = ope_comments_create();
+    if (!comments) {
+        throw FlaconError("Can't allocate memory");
+    }
+
+    const TagLib::Ogg::FieldListMap &fields = mTags.fieldListMap();
+    for (auto it = fields.begin(); it != fields.end(); ++it) {
+        for (const TagLib::String &value : it->second) {
+            ope_comments_add(comments, it->first.toCString(true), value.toCString(true));
+        }
+    }
+
+    // Family 0 is mono or stereo, family 1 is the Vorbis channel order up to 8 channels.
+    const int channels = wav.numChannels();
+    const int family   = channels <= 2 ? 0 : channels <= 8 ? 1 : 255;
+
+    OpusEncCallbacks callbacks = { writeCallback, closeCallback };
+
+    int err  = OPE_OK;
+    mEncoder = ope_encoder_create_callbacks(&callbacks, &mFile, comments, wav.sampleRate(), channels, family, &err);
+    ope_comments_destroy(comments);
+
+    if (!mEncoder) {
+        throw FlaconError(ope_strerror(err));
+    }
+
+    ope_encoder_ctl(mEncoder, OPUS_SET_BITRATE(mBitrate * 1000));
+    ope_encoder_ctl(mEncoder, OPUS_SET_VBR(1));
+    ope_encoder_ctl(mEncoder, OPUS_SET_VBR_CONSTRAINT(mBitrateType == "CVBR" ? 1 : 0));
+
+    qCDebug(LOG) << "Start encoder:" << filePath() << "rate:" << wav.sampleRate() << "channels:" << channels << "bitrate:" << mBitrate << mBitrateType;
+}
+
+/************************************************
+ *
+ ************************************************/
+void OpusNativeEncoder::write(const char *data, qint64 size)
+{
+    toFloat(mWav, data, size, &mBuffer);
+    toVorbisChannelOrder(mWav.numChannels(), &mBuffer);
+
+    int err = ope_encoder_write_float(mEncoder, mBuffer.constData(), mBuffer.size() / mWav.numChannels());
+    if (err != OPE_OK) {
+        throw FlaconError(ope_strerror(err));
+    }
+}
+
+/************************************************
+ *
+ ************************************************/
+void OpusNativeEncoder::save()
+{
+    int err = ope_encoder_drain(mEncoder);
+    destroy();
+
+    if (err != OPE_OK) {
+        throw FlaconError(ope_strerror(err));
+    }
+}
+
+/************************************************
+ *
+ ************************************************/
+void OpusNativeEncoder::setTags(const Track &track)
+{
+    setXiphTags(&mTags, track);
+}
+
+/************************************************
+ *
+ ************************************************/
+void OpusNativeEncoder::setEmbeddedCue(const QString &cue)
+{
+    setXiphEmbeddedCue(&mTags, cue);
+}
+
+/************************************************
+ *
+ ************************************************/
+void OpusNativeEncoder::setCoverImage(const CoverImage &image)
+{
+    setXiphCoverImage(&mTags, image);
+}
+
+/************************************************
+ *
+ ************************************************/
+void OpusNativeEncoder::setTrackReplayGain(float gain, float peak)
+{
+    setXiphTrackReplayGain(&mTags, gain, peak);
+    setXiphTag(&mTags, "R128_TRACK_GAIN", OpusMetadataWriter::r128Gain(gain));
+}
+
+/************************************************
+ *
+ ************************************************/
+void OpusNativeEncoder::setAlbumReplayGain(float gain, float peak)
+{
+    setXiphAlbumReplayGain(&mTags, gain, peak);
+    setXiphTag(&mTags, "R128_ALBUM_GAIN", OpusMetadataWriter::r128Gain(gain));
+}
@@ -0,0 +1,68 @@
+/* BEGIN_COMMON_COPYRIGHT_HEADER
+ * (c)LGPL2+
+ *
+ * Flacon - audio File Encoder
+ * https://github.com/flacon/flacon
+ *
+ * Copyright: 2024
+ *   Alexander Sokoloff <sokoloff.a@gmail.com>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * END_COMMON_COPYRIGHT_HEADER */
+
+#ifndef OPUSNATIVEENCODER_H
+#define OPUSNATIVEENCODER_H
+
+#include "../nativeencoder.h"
+#include <QFile>
+#include <taglib/xiphcomment.h>
+
+struct OggOpusEnc;
+
+class OpusNativeEncoder : public NativeEncoder
+{
+public:
+    OpusNativeEncoder(const QString &filePath, const QString &bitrateType, int bitrate);
+    ~OpusNativeEncoder() override;
+
+    void open(const Conv::WavHeader &wav) override;
+    void write(const char *data, qint64 size) override;
+    void save() override;
+
+    bool isSupported(const Conv::WavHeader &wav) const override;
+
+    bool isResampling() const override { return true; }
+
+    void setTags(const Track &track) override;
+    void setEmbeddedCue(const QString &cue) override;
+    void setCoverImage(const CoverImage &image) override;
+
+    void setTrackReplayGain(float gain, float peak) override;
+    void setAlbumReplayGain(float gain, float peak) override;
+
+private:
+    QString                  mBitrateType;
+    int                      mBitrate = 0;
+    TagLib::Ogg::XiphComment mTags;
+    QFile                    mFile;
+    OggOpusEnc              *mEncoder = nullptr;
+    Conv::WavHeader          mWav;
+    QVector<float>           mBuffer;
+
+    void destroy();
+};
+
+#endif // OPUSNATIVEENCODER_H
@@ -27,6 +27,10 @@
 #include "opusmetadatawriter.h"
 #include <QDebug>
 
+#ifdef USE_LIBOPUSENC
+#include "opusnativeencoder.h"
+#endif
+
 static const constexpr char *BITRATE_TYPE_KEY = "BitrateType";
 static const constexpr char *BITRATE_KEY      = "Bitrate";
 
@@ -101,6 +105,20 @@ MetadataWriter *OutFormat_Opus::createMetadataWriter(const QString &filePath) co
     return new OpusMetadataWriter(filePath);
 }
 
+/************************************************
+
+ ************************************************/
+NativeEncoder *OutFormat_Opus::createNativeEncoder(const Profile &profile, const QString &filePath) const
+{
+#ifdef USE_LIBOPUSENC
+    return new OpusNativeEncoder(filePath, profile.encoderValue(BITRATE_TYPE_KEY).toString(), profile.encoderValue(BITRATE_KEY).toInt());
+#else
+    Q_UNUSED(profile)
+    Q_UNUSED(filePath)
+    return nullptr;
+#endif
+}
+
 /************************************************
 
  ************************************************/
@@ -47,6 +47,7 @@ public:
     QStringList encoderArgs(const Profile &profile, const QString &outFile) const override;
 
     MetadataWriter *createMetadataWriter(const QString &filePath) const override;
+    NativeEncoder  *createNativeEncoder(const Profile &profile, const QString &filePath) const override;
 };
 
 class ConfigPage_Opus : public EncoderConfigPage, private Ui::ConfigPage_Opus
@@ -98,6 +98,8 @@ OutFormat *OutFormat::formatForId(const QString &id)
  ************************************************/
 bool OutFormat::check(const Profile &profile, QStringList *errors) const
 {
+    // The in-process encoder falls back to the program for the streams
+    // it doesn't support, so the program is required anyway.
     ExtProgram *prog = encoderProgram(profile);
     if (!prog) {
         return true;
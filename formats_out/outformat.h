@@ -41,6 +41,7 @@ class EncoderConfigPage;
 class Profile;
 
 class MetadataWriter;
+class NativeEncoder;
 
 class OutFormat
 {
@@ -69,6 +70,9 @@ public:
 
     virtual MetadataWriter *createMetadataWriter(const QString &filePath) const = 0;
 
+    /// Returns nullptr if the format is encoded only by the external program.
+    virtual NativeEncoder *createNativeEncoder(const Profile &, const QString &) const { return nullptr; }
+
 protected:
     QString       mId;
     QString       mName;
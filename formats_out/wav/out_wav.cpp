@@ -34,7 +34,7 @@ OutFormat_Wav::OutFormat_Wav()
     mId      = "WAV";
     mExt     = "wav";
     mName    = "WAV";
-    mOptions = FormatOption::Lossless;
+    mOptions = FormatOption::Lossless | FormatOption::SupportRf64;
 }
 
 /************************************************
@@ -7,3 +7,11 @@ list(APPEND SOURCES
   ${CMAKE_CURRENT_LIST_DIR}/wvmetadatawriter.h
   ${CMAKE_CURRENT_LIST_DIR}/wvmetadatawriter.cpp
 )
+
+# libwavpack is found in formats_in/module.cmake
+if (WAVPACK_FOUND)
+    list(APPEND SOURCES
+      ${CMAKE_CURRENT_LIST_DIR}/wavpacknativeencoder.h
+      ${CMAKE_CURRENT_LIST_DIR}/wavpacknativeencoder.cpp
+    )
+endif()
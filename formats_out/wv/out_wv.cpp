@@ -27,6 +27,10 @@
 #include <QDebug>
 #include "wvmetadatawriter.h"
 
+#ifdef USE_LIBWAVPACK
+#include "wavpacknativeencoder.h"
+#endif
+
 static const constexpr char *COMPRESSION_KEY = "Compression";
 static const constexpr char *REPLAY_GAIN_KEY = "ReplayGain";
 
@@ -38,7 +42,7 @@ OutFormat_Wv::OutFormat_Wv()
     mId      = "WV";
     mExt     = "wv";
     mName    = "WavPack";
-    mOptions = FormatOption::Lossless | FormatOption::SupportGain | FormatOption::SupportEmbeddedImage;
+    mOptions = FormatOption::Lossless | FormatOption::SupportGain | FormatOption::SupportEmbeddedImage | FormatOption::SupportRf64;
 }
 
 /************************************************
@@ -106,6 +110,20 @@ MetadataWriter *OutFormat_Wv::createMetadataWriter(const QString &filePath) cons
     return new WvMetadataWriter(filePath);
 }
 
+/************************************************
+ *
+ ************************************************/
+NativeEncoder *OutFormat_Wv::createNativeEncoder(const Profile &profile, const QString &filePath) const
+{
+#ifdef USE_LIBWAVPACK
+    return new WavPackNativeEncoder(filePath, profile.encoderValue(COMPRESSION_KEY).toInt());
+#else
+    Q_UNUSED(profile)
+    Q_UNUSED(filePath)
+    return nullptr;
+#endif
+}
+
 /************************************************
 
  ************************************************/
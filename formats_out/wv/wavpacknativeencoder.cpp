@@ -0,0 +1,211 @@
+/* BEGIN_COMMON_COPYRIGHT_HEADER
+ * (c)LGPL2+
+ *
+ * Flacon - audio File Encoder
+ * https://github.com/flacon/flacon
+ *
+ * Copyright: 2024
+ *   Alexander Sokoloff <sokoloff.a@gmail.com>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * END_COMMON_COPYRIGHT_HEADER */
+
+#include "wavpacknativeencoder.h"
+#include <QThread>
+#include <QLoggingCategory>
+
+namespace {
+Q_LOGGING_CATEGORY(LOG, "WavPackNativeEncoder")
+}
+
+using namespace Conv;
+
+// The converter already encodes several tracks at once
+static constexpr int MAX_WORKER_THREADS = 4;
+
+/************************************************
+ *
+ ************************************************/
+WavPackNativeEncoder::WavPackNativeEncoder(const QString &filePath, int compression) :
+    NativeEncoder(filePath),
+    mCompression(compression),
+    mFile(filePath)
+{
+}
+
+/************************************************
+ *
+ ************************************************/
+WavPackNativeEncoder::~WavPackNativeEncoder()
+{
+    destroy();
+}
+
+/************************************************
+ *
+ ************************************************/
+void WavPackNativeEncoder::destroy()
+{
+    if (mContext) {
+        mContext = WavpackCloseFile(mContext);
+    }
+    mFile.close();
+}
+
+/************************************************
+ * The blocks are written as they are ready, the
+ * total number of samples is known beforehand, so
+ * the first block doesn't need to be rewritten.
+ ************************************************/
+int WavPackNativeEncoder::writeBlock(void *id, void *data, int32_t size)
+{
+    QFile *file = static_cast<QFile *>(id);
+    return file->write(static_cast<const char *>(data), size) == size;
+}
+
+/************************************************
+ * The 64-bit floats aren't supported by WavPack.
+ ************************************************/
+bool WavPackNativeEncoder::isSupported(const WavHeader &wav) const
+{
+    return wav.sampleFormat() != WavHeader::Format_IEEE_FLOAT || wav.bitsPerSample() == 32;
+}
+
+/************************************************
+ * The compression levels are the same as for the
+ * wavpack program: 0 is -f, 1 is -h, 2 is -hh.
+ ************************************************/
+void WavPackNativeEncoder::open(const WavHeader &wav)
+{
+    mWav = wav;
+
+    const bool isFloat = wav.sampleFormat() == WavHeader::Format_IEEE_FLOAT;
+
+    if (!mFile.open(QFile::WriteOnly | QFile::Truncate)) {
+        throw FlaconError(mFile.errorString());
+    }
+
+    mContext = WavpackOpenFileOutput(writeBlock, &mFile, nullptr);
+    if (!mContext) {
+        throw FlaconError("Can't initialize the WavPack encoder");
+    }
+
+    WavpackConfig config;
+    memset(&config, 0, sizeof(config));
+    config.bytes_per_sample = wav.bitsPerSample() / 8;
+    config.bits_per_sample  = wav.validBitsPerSample() ? wav.validBitsPerSample() : wav.bitsPerSample();
+    config.num_channels     = wav.numChannels();
+    config.channel_mask     = wav.channelMask() ? wav.channelMask() : WavHeader::defaultChannelMask(wav.numChannels());
+    config.sample_rate      = wav.sampleRate();
+    config.float_norm_exp   = isFloat ? 127 : 0;
+
+    switch (mCompression) {
+        case 0:
+            config.flags |= CONFIG_FAST_FLAG;
+            break;
+        case 1:
+            config.flags |= CONFIG_HIGH_FLAG;
+            break;
+        case 2:
+            config.flags |= CONFIG_VERY_HIGH_FLAG;
+            break;
+    }
+
+#ifdef WAVPACK_WORKER_THREADS
+    config.worker_threads = qBound(0, QThread::idealThreadCount() - 1, MAX_WORKER_THREADS);
+#endif
+
+    const int64_t samples = wav.dataSize() / qMax<quint16>(wav.blockAlign(), 1);
+    if (!WavpackSetConfiguration64(mContext, &config, samples, nullptr) || !WavpackPackInit(mContext)) {
+        throw FlaconError(QString("Can't initialize the WavPack encoder: %1").arg(WavpackGetErrorMessage(mContext)));
+    }
+
+    qCDebug(LOG) << "Start encoder:" << filePath() << "rate:" << wav.sampleRate() << "channels:" << wav.numChannels();
+}
+
+/************************************************
+ * WavPack takes the 32-bit samples right justified
+ * to the source bit depth, the float samples are
+ * passed as is.
+ ************************************************/
+void WavPackNativeEncoder::write(const char *data, qint64 size)
+{
+    toInt32(mWav, data, size, &mBuffer);
+
+    const int frames = mBuffer.size() / mWav.numChannels();
+    if (!WavpackPackSamples(mContext, mBuffer.data(), frames)) {
+        throw FlaconError(QString("WavPack encoder error: %1").arg(WavpackGetErrorMessage(mContext)));
+    }
+}
+
+/************************************************
+ * The APEv2 tag follows the last block, as the
+ * wavpack program writes it.
+ ************************************************/
+void WavPackNativeEncoder::save()
+{
+    if (!WavpackFlushSamples(mContext)) {
+        throw FlaconError(QString("WavPack encoder error: %1").arg(WavpackGetErrorMessage(mContext)));
+    }
+
+    if (!mTags.isEmpty()) {
+        const TagLib::ByteVector tag = mTags.render();
+        if (mFile.write(tag.data(), tag.size()) != qint64(tag.size())) {
+            throw FlaconError(mFile.errorString());
+        }
+    }
+
+    destroy();
+}
+
+/************************************************
+ *
+ ************************************************/
+void WavPackNativeEncoder::setTags(const Track &track)
+{
+    setApeTags(&mTags, track);
+}
+
+/************************************************
+ *
+ ************************************************/
+void WavPackNativeEncoder::setEmbeddedCue(const QString &)
+{
+}
+
+/************************************************
+ *
+ ************************************************/
+void WavPackNativeEncoder::setCoverImage(const CoverImage &image)
+{
+    setApeCoverImage(&mTags, image);
+}
+
+/************************************************
+ *
+ ************************************************/
+void WavPackNativeEncoder::setTrackReplayGain(float gain, float peak)
+{
+    setApeTrackReplayGain(&mTags, gain, peak);
+}
+
+/************************************************
+ *
+ ************************************************/
+void WavPackNativeEncoder::setAlbumReplayGain(float gain, float peak)
+{
+    setApeAlbumReplayGain(&mTags, gain, peak);
+}
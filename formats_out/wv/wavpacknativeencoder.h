@@ -0,0 +1,65 @@
+/* BEGIN_COMMON_COPYRIGHT_HEADER
+ * (c)LGPL2+
+ *
+ * Flacon - audio File Encoder
+ * https://github.com/flacon/flacon
+ *
+ * Copyright: 2024
+ *   Alexander Sokoloff <sokoloff.a@gmail.com>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * END_COMMON_COPYRIGHT_HEADER */
+
+#ifndef WAVPACKNATIVEENCODER_H
+#define WAVPACKNATIVEENCODER_H
+
+#include "../nativeencoder.h"
+#include <QFile>
+#include <taglib/apetag.h>
+#include <wavpack/wavpack.h>
+
+class WavPackNativeEncoder : public NativeEncoder
+{
+public:
+    WavPackNativeEncoder(const QString &filePath, int compression);
+    ~WavPackNativeEncoder() override;
+
+    bool isSupported(const Conv::WavHeader &wav) const override;
+
+    void open(const Conv::WavHeader &wav) override;
+    void write(const char *data, qint64 size) override;
+    void save() override;
+
+    void setTags(const Track &track) override;
+    void setEmbeddedCue(const QString &cue) override;
+    void setCoverImage(const CoverImage &image) override;
+
+    void setTrackReplayGain(float gain, float peak) override;
+    void setAlbumReplayGain(float gain, float peak) override;
+
+private:
+    int              mCompression;
+    TagLib::APE::Tag mTags;
+    QFile            mFile;
+    Conv::WavHeader  mWav;
+    QVector<qint32>  mBuffer;
+    WavpackContext  *mContext = nullptr;
+
+    static int writeBlock(void *id, void *data, int32_t size);
+    void       destroy();
+};
+
+#endif // WAVPACKNATIVEENCODER_H
@@ -0,0 +1,180 @@
+/* BEGIN_COMMON_COPYRIGHT_HEADER
+ * (c)LGPL2+
+ *
+ * Flacon - audio File Encoder
+ * https://github.com/flacon/flacon
+ *
+ * Copyright: 2024
+ *   Alexander Sokoloff <sokoloff.a@gmail.com>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * END_COMMON_COPYRIGHT_HEADER */
+
+#include "coverthumbnails.h"
+#include <QFileInfo>
+#include <QDir>
+#include <QDateTime>
+#include <QImageReader>
+#include <QSaveFile>
+#include <QStandardPaths>
+#include <QCryptographicHash>
+#include <QFutureWatcher>
+#include <QtConcurrent/QtConcurrent>
+#include <QLoggingCategory>
+
+namespace {
+Q_LOGGING_CATEGORY(LOG, "CoverThumbnails")
+}
+
+static constexpr int THUMBNAIL_SIZE    = 500;
+static constexpr int MEMORY_CACHE_KB   = 64 * 1024;
+static constexpr int THUMBNAIL_THREADS = 2;
+
+/************************************************
+ *
+ ************************************************/
+CoverThumbnails *CoverThumbnails::instance()
+{
+    static CoverThumbnails res;
+    return &res;
+}
+
+/************************************************
+ *
+ ************************************************/
+CoverThumbnails::CoverThumbnails(QObject *parent) :
+    QObject(parent),
+    mImages(MEMORY_CACHE_KB)
+{
+    mPool.setMaxThreadCount(THUMBNAIL_THREADS);
+}
+
+/************************************************
+ * The file name, size and modification time
+ * identify the cover file, so the image edited
+ * during the session gets a new thumbnail.
+ ************************************************/
+QString CoverThumbnails::cacheKey(const QString &fileName)
+{
+    QFileInfo fi(fileName);
+    return QString("%1:%2:%3").arg(fi.absoluteFilePath()).arg(fi.size()).arg(fi.lastModified().toMSecsSinceEpoch());
+}
+
+/************************************************
+ *
+ ************************************************/
+QImage CoverThumbnails::thumbnail(const QString &fileName)
+{
+    if (fileName.isEmpty()) {
+        return QImage();
+    }
+
+    const QString key = cacheKey(fileName);
+    if (QImage *img = mImages.object(key)) {
+        return *img;
+    }
+
+    if (mPending.contains(key)) {
+        return QImage();
+    }
+    mPending << key;
+
+    QFutureWatcher<QImage> *watcher = new QFutureWatcher<QImage>(this);
+    connect(watcher, &QFutureWatcher<QImage>::finished, this, [this, watcher, key, fileName]() {
+        imageReady(key, fileName, watcher->result());
+        watcher->deleteLater();
+    });
+    watcher->setFuture(QtConcurrent::run(&mPool, &CoverThumbnails::load, fileName));
+
+    return QImage();
+}
+
+/************************************************
+ *
+ ************************************************/
+bool CoverThumbnails::isReady(const QString &fileName) const
+{
+    return mImages.contains(cacheKey(fileName));
+}
+
+/************************************************
+ *
+ ************************************************/
+void CoverThumbnails::imageReady(const QString &key, const QString &fileName, const QImage &image)
+{
+    mPending.remove(key);
+
+    // The broken images are cached as well, so we don't load them again and again.
+    mImages.insert(key, new QImage(image), qMax(1, int(image.sizeInBytes() / 1024)));
+    emit ready(fileName);
+}
+
+/************************************************
+ * Uses the same key as the memory cache
+ ************************************************/
+QString CoverThumbnails::cacheFile(const QString &fileName)
+{
+    QString dir = QStandardPaths::writableLocation(QStandardPaths::CacheLocation);
+    if (dir.isEmpty()) {
+        return "";
+    }
+
+    QByteArray hash = QCryptographicHash::hash(cacheKey(fileName).toUtf8(), QCryptographicHash::Sha1);
+    return QString("%1/thumbnails/%2").arg(dir, QString::fromLatin1(hash.toHex()));
+}
+
+/************************************************
+ * Runs in the thread pool
+ ************************************************/
+QImage CoverThumbnails::load(const QString &fileName)
+{
+    const QString cached = cacheFile(fileName);
+
+    if (!cached.isEmpty() && QFileInfo::exists(cached)) {
+        QImage img(cached);
+        if (!img.isNull()) {
+            return img;
+        }
+    }
+
+    QImageReader reader(fileName);
+    reader.setAutoTransform(true);
+
+    QSize size = reader.size();
+    if (size.width() > THUMBNAIL_SIZE || size.height() > THUMBNAIL_SIZE) {
+        reader.setScaledSize(size.scaled(THUMBNAIL_SIZE, THUMBNAIL_SIZE, Qt::KeepAspectRatio));
+    }
+
+    QImage img = reader.read();
+    if (img.isNull()) {
+        qCWarning(LOG) << "Can't load cover image" << fileName << reader.errorString();
+        return img;
+    }
+
+    if (cached.isEmpty() || !QDir().mkpath(QFileInfo(cached).path())) {
+        return img;
+    }
+
+    QSaveFile file(cached);
+    if (file.open(QFile::WriteOnly) && img.save(&file, img.hasAlphaChannel() ? "PNG" : "JPG", 90)) {
+        file.commit();
+    }
+    else {
+        qCWarning(LOG) << "Can't write thumbnail" << cached << file.errorString();
+    }
+
+    return img;
+}
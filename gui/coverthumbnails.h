@@ -0,0 +1,70 @@
+/* BEGIN_COMMON_COPYRIGHT_HEADER
+ * (c)LGPL2+
+ *
+ * Flacon - audio File Encoder
+ * https://github.com/flacon/flacon
+ *
+ * Copyright: 2024
+ *   Alexander Sokoloff <sokoloff.a@gmail.com>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * END_COMMON_COPYRIGHT_HEADER */
+
+#ifndef COVERTHUMBNAILS_H
+#define COVERTHUMBNAILS_H
+
+#include <QObject>
+#include <QImage>
+#include <QCache>
+#include <QSet>
+#include <QThreadPool>
+
+/************************************************
+ * Cover thumbnails for the track view. They are
+ * created on the background pool and kept in
+ * memory and in the on-disk cache.
+ ************************************************/
+class CoverThumbnails : public QObject
+{
+    Q_OBJECT
+public:
+    static CoverThumbnails *instance();
+
+    /// Returns a null image if the thumbnail is not ready yet,
+    /// the ready signal is emitted when it's created.
+    QImage thumbnail(const QString &fileName);
+
+    /// The thumbnail was created, but it may be null if the file isn't an image.
+    bool isReady(const QString &fileName) const;
+
+signals:
+    void ready(const QString &fileName);
+
+private:
+    explicit CoverThumbnails(QObject *parent = nullptr);
+
+    QCache<QString, QImage> mImages;
+    QSet<QString>           mPending;
+    QThreadPool             mPool;
+
+    void imageReady(const QString &key, const QString &fileName, const QImage &image);
+
+    static QImage  load(const QString &fileName);
+    static QString cacheKey(const QString &fileName);
+    static QString cacheFile(const QString &fileName);
+};
+
+#endif // COVERTHUMBNAILS_H
@@ -54,6 +54,7 @@
 #include <QToolBar>
 #include <QToolButton>
 #include <QStandardPaths>
+#include <QTime>
 #include "qtbackports/movetotrash.h"
 #include "audiofilematcher.h"
 
@@ -178,6 +179,8 @@ MainWindow::MainWindow(QWidget *parent) :
 
     connect(trackView->model(), &TrackViewModel::layoutChanged, this, &MainWindow::refreshEdits);
     connect(trackView->model(), &TrackViewModel::layoutChanged, this, &MainWindow::setControlsEnable);
+    connect(trackView->model(), &TrackViewModel::rowsRemoved, this, &MainWindow::refreshEdits);
+    connect(trackView->model(), &TrackViewModel::rowsRemoved, this, &MainWindow::setControlsEnable);
 
     connect(trackView->selectionModel(), &QItemSelectionModel::selectionChanged,
             this, &MainWindow::refreshEdits);
@@ -188,6 +191,10 @@ MainWindow::MainWindow(QWidget *parent) :
     connect(Project::instance(), &Project::layoutChanged, this, &MainWindow::refreshEdits);
     connect(Project::instance(), &Project::layoutChanged, this, &MainWindow::setControlsEnable);
 
+    connect(Project::instance(), &Project::discLayoutChanged, trackView, &TrackView::discLayoutChanged);
+    connect(Project::instance(), &Project::discLayoutChanged, this, &MainWindow::refreshEdits);
+    connect(Project::instance(), &Project::discLayoutChanged, this, &MainWindow::setControlsEnable);
+
     connect(Project::instance(), &Project::discChanged, this, &MainWindow::refreshEdits);
     connect(Project::instance(), &Project::discChanged, this, &MainWindow::setControlsEnable);
 
@@ -716,7 +723,7 @@ void MainWindow::startConvert(const Conv::Converter::Jobs &jobs)
     connect(mConverter, &Conv::Converter::totalProgress,
             this, &MainWindow::updateTotalProgress);
 
-    updateTotalProgress(0);
+    updateTotalProgress(0, 0, -1);
 
     connect(mConverter, &Conv::Converter::error,
             this, &MainWindow::showErrorMessage);
@@ -1433,7 +1440,16 @@ void MainWindow::showErrors()
 /************************************************
  *
  ************************************************/
-void MainWindow::updateTotalProgress(double percent)
+void MainWindow::updateTotalProgress(double percent, double throughput, int eta)
 {
-    mTotalProgressLabel.setText(tr("%1% completed", "Status bar, progress text").arg(percent, 0, 'f', 0));
+    if (eta < 0) {
+        mTotalProgressLabel.setText(tr("%1% completed", "Status bar, progress text").arg(percent, 0, 'f', 0));
+        return;
+    }
+
+    QString left = QTime(0, 0).addSecs(eta).toString(eta < 3600 ? "m:ss" : "h:mm:ss");
+    mTotalProgressLabel.setText(tr("%1% completed, %2 left (%3x)", "Status bar, progress text. %2 is a time left, %3 is a conversion speed relative to the playback speed")
+                                        .arg(percent, 0, 'f', 0)
+                                        .arg(left)
+                                        .arg(throughput, 0, 'f', 1));
 }
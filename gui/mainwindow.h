@@ -131,7 +131,7 @@ private:
 
     void showWarnings();
     void showErrors();
-    void updateTotalProgress(double percent);
+    void updateTotalProgress(double percent, double throughput, int eta);
 
     bool showExitDialog();
     void setStartButtonAction(QAction *action);
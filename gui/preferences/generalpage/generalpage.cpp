@@ -38,6 +38,8 @@ GeneralPage::GeneralPage(QWidget *parent) :
     ui->tmpDirButton->setBuddy(ui->tmpDirEdit);
     connect(ui->tmpDirButton, &QToolButton::clicked, this, &GeneralPage::showTmpDirDialog);
 
+    connect(ui->threadsCountSpin, qOverload<int>(&QSpinBox::valueChanged), ui->minThreadsCountSpin, &QSpinBox::setMaximum);
+
 #ifdef DISABLE_TMP_DIR
     ui->tmpDirLabel->hide();
     ui->tmpDirEdit->hide();
@@ -96,6 +98,16 @@ void GeneralPage::setEncoderThreadsCount(uint value)
     ui->threadsCountSpin->setValue(value);
 }
 
+uint GeneralPage::encoderMinThreadsCount() const
+{
+    return uint(ui->minThreadsCountSpin->value());
+}
+
+void GeneralPage::setEncoderMinThreadsCount(uint value)
+{
+    ui->minThreadsCountSpin->setValue(value);
+}
+
 bool GeneralPage::isSplitTrackTitle() const
 {
     return ui->splitTrackTitleCbx->isChecked();
@@ -49,6 +49,9 @@ public:
     uint encoderThreadsCount() const;
     void setEncoderThreadsCount(uint value);
 
+    uint encoderMinThreadsCount() const;
+    void setEncoderMinThreadsCount(uint value);
+
     bool isSplitTrackTitle() const;
     void setSplitTrackTitle(bool value);
 
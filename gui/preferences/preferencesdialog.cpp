@@ -179,6 +179,7 @@ void PreferencesDialog::setProfiles(const Profiles &profiles)
     // General  page .......................
     Profile p = !profiles.isEmpty() ? profiles.first() : Profile();
     ui->generalPage->setEncoderThreadsCount(p.encoderThreadsCount());
+    ui->generalPage->setEncoderMinThreadsCount(p.encoderMinThreadsCount());
     ui->generalPage->setTmpDir(p.tmpDir());
     ui->generalPage->setSplitTrackTitle(p.isSplitTrackTitle());
 
@@ -279,6 +280,7 @@ bool PreferencesDialog::save()
     // General  page .......................
     Profile &p = ui->profilesPage->profiles().first();
     p.setEncoderThreadsCount(ui->generalPage->encoderThreadsCount());
+    p.setEncoderMinThreadsCount(ui->generalPage->encoderMinThreadsCount());
     p.setTmpDir(ui->generalPage->tmpDir());
     p.setSplitTrackTitle(ui->generalPage->isSplitTrackTitle());
 
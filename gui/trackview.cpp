@@ -141,6 +141,19 @@ void TrackView::layoutChanged()
     expandAll();
 }
 
+/************************************************
+ * Only the rows of the changed disc are touched
+ ************************************************/
+void TrackView::discLayoutChanged(const Disc *disc)
+{
+    QModelIndex idx = mModel->index(*disc);
+    if (!idx.isValid())
+        return;
+
+    setFirstColumnSpanned(idx.row(), QModelIndex(), true);
+    expand(idx);
+}
+
 /************************************************
  *
  ************************************************/
@@ -63,6 +63,7 @@ public:
 
 public slots:
     void layoutChanged();
+    void discLayoutChanged(const Disc *disc);
     void selectDisc(const Disc *disc);
     void downloadStarted(const Disc &disc);
     void downloadFinished(const Disc &disc);
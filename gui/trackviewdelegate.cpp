@@ -29,6 +29,7 @@
 #include "project.h"
 #include "types.h"
 #include "icon.h"
+#include "coverthumbnails.h"
 
 #include <QImage>
 #include <QPixmap>
@@ -438,6 +439,15 @@ QRect TrackViewDelegate::drawCoverImage(QPainter *painter, const QRect &windowRe
 {
     QImage img = index.data(TrackViewModel::RoleCoverImg).value<QImage>();
     if (img.isNull()) {
+        QString file = index.data(TrackViewModel::RoleCoverFile).toString();
+
+        // The thumbnail is being created, keep the place for it
+        if (!file.isEmpty() && !CoverThumbnails::instance()->isReady(file)) {
+            QRect imgRect(windowRect.topLeft(), QSize(windowRect.height(), windowRect.height()));
+            painter->fillRect(imgRect, mTrackView->palette().base().color());
+            return imgRect;
+        }
+
         img = mNoCoverImg;
     }
 
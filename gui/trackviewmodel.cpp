@@ -27,32 +27,42 @@
 #include "trackview.h"
 #include "project.h"
 #include "disc.h"
+#include "coverthumbnails.h"
 
 #include <QDebug>
 #include <QSet>
+#include <QVector>
 
 struct CacheTrackData
 {
     CacheTrackData() :
         state(TrackState::NotRunning),
-        percent(0),
-        discNum(-1),
-        trackNum(-1)
+        percent(0)
     {
     }
 
     TrackState state;
     Percent    percent;
-    DiscNum    discNum;
-    TrackNum   trackNum;
 };
 
 class TrackViewModel::Cache
 {
 public:
     Cache() = default;
-    QSet<DiscNum>                downloadedDiscs;
-    QHash<Track, CacheTrackData> tracks;
+    QSet<const Disc *>                           downloadedDiscs;
+    QHash<const Disc *, QVector<CacheTrackData>> tracks;
+
+    // The first and last track index changed since the last repaint
+    QHash<const Disc *, QPair<int, int>> changedTracks;
+
+    CacheTrackData &track(const Track &track)
+    {
+        QVector<CacheTrackData> &data = tracks[track.disc()];
+        if (data.size() <= track.index())
+            data.resize(track.index() + 1);
+
+        return data[track.index()];
+    }
 };
 
 class IndexData
@@ -110,14 +120,6 @@ private:
     quint16 mTrackId;
 };
 
-/************************************************
- *
- ************************************************/
-inline uint qHash(const Track &track, uint seed)
-{
-    return qHash(QPair<int, intptr_t>(track.trackNum(), intptr_t(track.disc())), seed);
-}
-
 /************************************************
 
  ************************************************/
@@ -132,11 +134,22 @@ TrackViewModel::TrackViewModel(TrackView *parent) :
     connect(Project::instance(), &Project::layoutChanged,
             [this]() { this->layoutChanged(); });
 
-    connect(Project::instance(), &Project::afterRemoveDisc,
-            [this]() { this->layoutChanged(); });
+    connect(Project::instance(), &Project::discLayoutChanged,
+            this, &TrackViewModel::discLayoutChanged);
 
     connect(Project::instance(), &Project::beforeRemoveDisc,
-            this, &TrackViewModel::invalidateCache);
+            this, &TrackViewModel::beforeRemoveDisc);
+
+    connect(Project::instance(), &Project::afterRemoveDisc,
+            this, &TrackViewModel::afterRemoveDisc);
+
+    connect(CoverThumbnails::instance(), &CoverThumbnails::ready,
+            this, &TrackViewModel::coverThumbnailReady);
+
+    mUpdateTimer.setSingleShot(true);
+    mUpdateTimer.setInterval(UPDATE_INTERVAL_MS);
+    connect(&mUpdateTimer, &QTimer::timeout,
+            this, &TrackViewModel::flushTrackChanges);
 }
 
 /************************************************
@@ -208,27 +221,15 @@ QModelIndex TrackViewModel::index(const Disc &disc, int col) const
  ************************************************/
 QModelIndex TrackViewModel::index(const Track &track, int col) const
 {
-    CacheTrackData &cache = mCache->tracks[track];
-
-    const IndexData indexData(cache.discNum, cache.trackNum);
-    if (indexData.track() && *indexData.track() == track) {
-        return index(cache.trackNum, col, index(cache.discNum, 0));
-    }
+    const Disc *disc = track.disc();
+    if (!disc || track.index() < 0 || track.index() >= disc->count())
+        return QModelIndex();
 
-    // Update cache
-    for (int d = 0; d < rowCount(); ++d) {
-        QModelIndex discIndex = index(d, 0);
-        for (int t = 0; t < rowCount(discIndex); ++t) {
-            IndexData indexData(d, t);
-            if (indexData.track() && *indexData.track() == track) {
-                cache.discNum  = d;
-                cache.trackNum = t;
-                return index(cache.trackNum, col, discIndex);
-            }
-        }
-    }
+    QModelIndex discIndex = index(*disc, 0);
+    if (!discIndex.isValid())
+        return QModelIndex();
 
-    return QModelIndex();
+    return index(track.index(), col, discIndex);
 }
 
 /************************************************
@@ -361,9 +362,9 @@ QVariant TrackViewModel::trackData(const Track *track, const QModelIndex &index,
         case RoleItemType:
             return TrackItem;
         case RolePercent:
-            return mCache->tracks[*track].percent;
+            return mCache->track(*track).percent;
         case RoleStatus:
-            return int(mCache->tracks[*track].state);
+            return int(mCache->track(*track).state);
         case RoleTracknum:
             return track->trackNum();
         case RoleDuration:
@@ -431,9 +432,9 @@ QVariant TrackViewModel::discData(const Disc *disc, const QModelIndex &index, in
         case RoleAudioFileName: return disc->audioFileNames();
         case RoleHasWarnings:   return Project::instance()->validator().diskHasWarnings(disc);
         case RoleHasErrors:     return Project::instance()->validator().diskHasErrors(disc);
-        case RoleIsDownloads:   return mCache->downloadedDiscs.contains(index.row());
+        case RoleIsDownloads:   return mCache->downloadedDiscs.contains(disc);
         case RoleCoverFile:     return disc->coverImageFile();
-        case RoleCoverImg:      return disc->coverImagePreview();
+        case RoleCoverImg:      return CoverThumbnails::instance()->thumbnail(disc->coverImageFile());
         case RoleCueFilePath:   return disc->cueFilePath();
         case RoleAudioFilePath: return disc->audioFilePaths();
         case RoleDiscWarnings:  return Project::instance()->validator().diskWarnings(disc);
@@ -538,7 +539,7 @@ Track *TrackViewModel::trackByIndex(const QModelIndex &index)
  ************************************************/
 void TrackViewModel::downloadStarted(const Disc &disc)
 {
-    mCache->downloadedDiscs << index(disc).row();
+    mCache->downloadedDiscs << &disc;
     discDataChanged(&disc);
 }
 
@@ -547,21 +548,58 @@ void TrackViewModel::downloadStarted(const Disc &disc)
  ************************************************/
 void TrackViewModel::downloadFinished(const Disc &disc)
 {
-    mCache->downloadedDiscs.remove(index(disc).row());
+    mCache->downloadedDiscs.remove(&disc);
     discDataChanged(&disc);
 }
 
 /************************************************
- *
+ * The progress is only stored here, the view is
+ * repainted by flushTrackChanges once per frame
  ************************************************/
 void TrackViewModel::trackProgressChanged(const Track &track, TrackState state, Percent percent)
 {
-    CacheTrackData &cache = mCache->tracks[track];
+    const Disc *disc = track.disc();
+    if (!disc || track.index() < 0 || track.index() >= disc->count())
+        return;
+
+    // The pregap track has the same index as the first track, but it isn't shown
+    if (disc->track(track.index())->trackNum() != track.trackNum())
+        return;
+
+    CacheTrackData &cache = mCache->track(track);
     cache.state           = state;
     cache.percent         = percent;
 
-    QModelIndex idx = index(track, TrackView::ColumnPercent);
-    emit        dataChanged(idx, idx);
+    auto it = mCache->changedTracks.find(disc);
+    if (it == mCache->changedTracks.end()) {
+        mCache->changedTracks.insert(disc, qMakePair(track.index(), track.index()));
+    }
+    else {
+        it->first  = qMin(it->first, track.index());
+        it->second = qMax(it->second, track.index());
+    }
+
+    if (!mUpdateTimer.isActive())
+        mUpdateTimer.start();
+}
+
+/************************************************
+ * Emits one dataChanged per disc for the range
+ * of the changed tracks
+ ************************************************/
+void TrackViewModel::flushTrackChanges()
+{
+    for (auto it = mCache->changedTracks.cbegin(); it != mCache->changedTracks.cend(); ++it) {
+        QModelIndex discIndex = index(*it.key(), 0);
+        if (!discIndex.isValid())
+            continue;
+
+        QModelIndex index1 = index(it->first, TrackView::ColumnPercent, discIndex);
+        QModelIndex index2 = index(it->second, TrackView::ColumnPercent, discIndex);
+        emit        dataChanged(index1, index2, QVector<int>() << RolePercent << RoleStatus);
+    }
+
+    mCache->changedTracks.clear();
 }
 
 /************************************************
@@ -570,17 +608,73 @@ void TrackViewModel::trackProgressChanged(const Track &track, TrackState state,
 void TrackViewModel::discDataChanged(const Disc *disc)
 {
     QModelIndex index1 = index(*disc, 0);
-    QModelIndex index2 = index(*disc, TrackView::ColumnCount);
+    QModelIndex index2 = index(*disc, TrackView::ColumnCount - 1);
     emit        dataChanged(index1, index2);
 }
 
 /************************************************
+ * The tracks of the disc were changed, the other
+ * discs stay as is
+ ************************************************/
+void TrackViewModel::discLayoutChanged(const Disc *disc)
+{
+    QModelIndex idx = index(*disc, 0);
+    if (!idx.isValid())
+        return;
+
+    QVector<CacheTrackData> &data = mCache->tracks[disc];
+    if (data.size() > disc->count())
+        data.resize(disc->count());
+
+    emit layoutChanged(QList<QPersistentModelIndex>() << idx);
+}
 
+/************************************************
+ * Repaint the discs that were drawn with the
+ * placeholder
  ************************************************/
-void TrackViewModel::invalidateCache(const Disc *disc)
+void TrackViewModel::coverThumbnailReady(const QString &fileName)
+{
+    for (const Disc *disc : Project::instance()->disks()) {
+        if (disc->coverImageFile() == fileName) {
+            QModelIndex idx = index(*disc, 0);
+            emit        dataChanged(idx, idx, QVector<int>() << RoleCoverImg);
+        }
+    }
+}
+
+/************************************************
+
+ ************************************************/
+void TrackViewModel::beforeRemoveDisc(const Disc *disc)
 {
-    mCache->downloadedDiscs.remove(index(*disc).row());
+    invalidateCache(disc);
+
+    const int row = Project::instance()->indexOf(disc);
+    if (row < 0)
+        return;
+
+    beginRemoveRows(QModelIndex(), row, row);
+    mRemovingRows = true;
+}
 
-    for (int i = 0; i < disc->count(); ++i)
-        mCache->tracks.remove(*(disc->track(i)));
+/************************************************
+
+ ************************************************/
+void TrackViewModel::afterRemoveDisc()
+{
+    if (mRemovingRows) {
+        mRemovingRows = false;
+        endRemoveRows();
+    }
+}
+
+/************************************************
+
+ ************************************************/
+void TrackViewModel::invalidateCache(const Disc *disc)
+{
+    mCache->downloadedDiscs.remove(disc);
+    mCache->tracks.remove(disc);
+    mCache->changedTracks.remove(disc);
 }
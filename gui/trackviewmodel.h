@@ -28,6 +28,7 @@
 
 #include <QAbstractItemModel>
 #include <QSet>
+#include <QTimer>
 
 #include "types.h"
 class Project;
@@ -106,15 +107,24 @@ public slots:
 
 private slots:
     void discDataChanged(const Disc *disc);
-    void invalidateCache(const Disc *disc);
+    void discLayoutChanged(const Disc *disc);
+    void beforeRemoveDisc(const Disc *disc);
+    void afterRemoveDisc();
+    void coverThumbnailReady(const QString &fileName);
+    void flushTrackChanges();
 
 private:
+    static constexpr int UPDATE_INTERVAL_MS = 16;
+
     QVariant trackData(const Track *track, const QModelIndex &index, int role) const;
     QVariant discData(const Disc *disc, const QModelIndex &index, int role) const;
     QString  trackDurationToString(uint milliseconds) const;
+    void     invalidateCache(const Disc *disc);
     class Cache;
     mutable Cache *mCache;
     TrackView     *mView;
+    QTimer         mUpdateTimer;
+    bool           mRemovingRows = false;
 };
 
 #endif // TRACKVIEWMODEL_H
@@ -59,8 +59,13 @@ namespace Qt {
 #endif
 // clang-format on
 
-static bool quiet;
-static bool progress;
+static bool        quiet;
+static bool        progress;
+static QStringList profileIds;
+static bool        incremental;
+static bool        retag;
+static bool        verify;
+static bool        accurateRip;
 
 /************************************************
  *
@@ -77,6 +82,17 @@ Generic options:
   -c --config <file>        Specify an alternative configuration file.
   -q --quiet                Quiet mode (no output).
   -p --progress             Show progress during conversion.
+  -P --profile <id>         Convert with the profile <id> instead of the current one.
+                            The option can be given several times, the audio is
+                            decoded once and encoded with each of the profiles.
+  -i --incremental          Skip tracks whose result files are up to date, only
+                            update the tags if they have changed.
+  -r --retag                Update the tags and the cover of the existing result
+                            files without converting the audio.
+  -V --verify               Decode the lossless result files and compare their
+                            audio with the source.
+  -A --accuraterip          Write the AccurateRip and CTDB CRCs of CD quality
+                            audio to a .crc file next to the CUE file.
   -h, --help                Show help about options
   --version                 Show version information
   --debug                   Enable debug output
@@ -204,8 +220,27 @@ int runConsole(int argc, char *argv[], const QStringList &files)
     if (Project::instance()->count() == 0)
         return 10;
 
-    ConsoleOut      out(*(Project::instance()->profile()));
+    const Profiles allProfiles = Project::instance()->profiles();
+
+    Profiles profiles;
+    for (const QString &id : profileIds) {
+        const Profile *p = allProfiles.find(id);
+        if (!p) {
+            qWarning() << "Error: Unknown profile" << id;
+            return 12;
+        }
+        profiles << *p;
+    }
+
+    if (profiles.isEmpty()) {
+        profiles << *(Project::instance()->profile());
+    }
+
+    ConsoleOut      out(profiles.first());
     Conv::Converter converter;
+    converter.setIncremental(incremental);
+    converter.setVerify(verify);
+    converter.setAccurateRip(accurateRip);
     if (!quiet) {
         QObject::connect(&converter, &Conv::Converter::started,
                          &out, &ConsoleOut::converterStarted);
@@ -219,20 +254,34 @@ int runConsole(int argc, char *argv[], const QStringList &files)
         if (progress) {
             QObject::connect(&converter, &Conv::Converter::trackProgress,
                              &out, &ConsoleOut::trackProgress);
+
+            QObject::connect(&converter, &Conv::Converter::totalProgress,
+                             &out, &ConsoleOut::totalProgress);
         }
     }
 
     app.connect(&converter, &Conv::Converter::finished,
                 &app, &QCoreApplication::quit);
 
+    bool started = false;
+    app.connect(&converter, &Conv::Converter::started,
+                [&started]() { started = true; });
+
     app.connect(&converter, &Conv::Converter::error,
                 [](const QString &message) {
                     consoleErroHandler(QtCriticalMsg, QMessageLogContext(), message);
                 });
 
-    converter.start(*(Project::instance()->profile()));
+    if (retag) {
+        converter.retag(profiles);
+    }
+    else {
+        converter.start(profiles);
+    }
+
+    // The converter finishes synchronously when there is nothing to do
     if (!converter.isRunning())
-        return 11;
+        return started ? 0 : 11;
 
     return app.exec();
 }
@@ -296,6 +345,21 @@ int main(int argc, char *argv[])
     parser.addOption(QCommandLineOption(QStringList() << "p"
                                                       << "progress",
                                         ""));
+    parser.addOption(QCommandLineOption(QStringList() << "P"
+                                                      << "profile",
+                                        "", "profile id"));
+    parser.addOption(QCommandLineOption(QStringList() << "i"
+                                                      << "incremental",
+                                        ""));
+    parser.addOption(QCommandLineOption(QStringList() << "r"
+                                                      << "retag",
+                                        ""));
+    parser.addOption(QCommandLineOption(QStringList() << "V"
+                                                      << "verify",
+                                        ""));
+    parser.addOption(QCommandLineOption(QStringList() << "A"
+                                                      << "accuraterip",
+                                        ""));
     parser.addOption(QCommandLineOption("debug", ""));
 
     QStringList args;
@@ -325,8 +389,13 @@ int main(int argc, char *argv[])
 
     initDebug((parser.isSet("debug") || getenv("FLACON_DEBUG")));
 
-    quiet    = parser.isSet("quiet");
-    progress = parser.isSet("progress");
+    quiet       = parser.isSet("quiet");
+    progress    = parser.isSet("progress");
+    profileIds  = parser.values("profile");
+    incremental = parser.isSet("incremental");
+    retag       = parser.isSet("retag");
+    verify      = parser.isSet("verify");
+    accurateRip = parser.isSet("accuraterip");
 
 #ifndef GIT_BRANCH
     qInfo() << "Start flacon " << FLACON_VERSION;
@@ -226,6 +226,14 @@ void Profile::setEncoderThreadsCount(uint value)
     globalParams().mEncoderThreadsCount = defaultEncoderThreadCount();
 }
 
+/************************************************
+ *
+ ************************************************/
+void Profile::setEncoderMinThreadsCount(uint value)
+{
+    globalParams().mEncoderMinThreadsCount = std::max(1u, value);
+}
+
 /************************************************
  *
  ************************************************/
@@ -107,6 +107,10 @@ public:
     uint encoderThreadsCount() const { return globalParams().mEncoderThreadsCount; }
     void setEncoderThreadsCount(uint value);
 
+    /// The converter doesn't reduce the number of threads below this value.
+    uint encoderMinThreadsCount() const { return globalParams().mEncoderMinThreadsCount; }
+    void setEncoderMinThreadsCount(uint value);
+
     static bool isSplitTrackTitle() { return globalParams().splitTrackTitle; }
     static void setSplitTrackTitle(bool value);
 
@@ -139,8 +143,9 @@ private:
     struct GlobalParams
     {
         QString mTmpDir;
-        uint    mEncoderThreadsCount = defaultEncoderThreadCount();
-        bool    splitTrackTitle      = true;
+        uint    mEncoderThreadsCount    = defaultEncoderThreadCount();
+        uint    mEncoderMinThreadsCount = 1;
+        bool    splitTrackTitle         = true;
     };
 
     static GlobalParams &globalParams();
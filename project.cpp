@@ -263,9 +263,13 @@ void Project::emitDiscChanged(Disc *disc)
 /************************************************
 
  ************************************************/
-void Project::emitLayoutChanged()
+void Project::emitLayoutChanged(Disc *disc)
 {
-    emit layoutChanged();
+    if (disc && mDiscs.contains(disc))
+        emit discLayoutChanged(disc);
+    else
+        emit layoutChanged();
+
     if (mValidator.isValid()) {
         mValidator.revalidate();
     }
@@ -54,7 +54,7 @@ public:
     void removeDisc(const QList<Disc *> &discs);
 
     void emitDiscChanged(Disc *disc);
-    void emitLayoutChanged();
+    void emitLayoutChanged(Disc *disc = nullptr);
 
     bool discExists(const QString &cueUri);
 
@@ -76,6 +76,7 @@ public:
 signals:
     void discChanged(Disc *disc) const;
     void layoutChanged() const;
+    void discLayoutChanged(Disc *disc) const;
     void beforeRemoveDisc(Disc *disc);
     void afterRemoveDisc();
 
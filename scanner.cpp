@@ -28,6 +28,7 @@
 #include "inputaudiofile.h"
 
 #include "project.h"
+#include "uchardetect.h"
 
 #include <QStringList>
 #include <QSet>
@@ -35,6 +36,20 @@
 #include <QDir>
 #include <QApplication>
 
+/************************************************
+ * Starts the codepage detection for the CUE files
+ * of the directory before we get to its audio files.
+ ************************************************/
+static void prefetchCueCodepages(const QString &dir)
+{
+    QStringList cueFiles;
+    for (const QFileInfo &fi : QDir(dir).entryInfoList(QStringList("*.cue"), QDir::Files | QDir::Readable)) {
+        cueFiles << fi.absoluteFilePath();
+    }
+
+    UcharDet::prefetch(cueFiles);
+}
+
 /************************************************
 
  ************************************************/
@@ -60,6 +75,7 @@ void Scanner::start(const QString &startDir)
 
     QQueue<QString> query;
     query << startDir;
+    prefetchCueCodepages(startDir);
 
     QSet<QString> processed;
     while (!query.isEmpty()) {
@@ -77,6 +93,7 @@ void Scanner::start(const QString &startDir)
             if (!processed.contains(d.absoluteFilePath())) {
                 processed << d.absoluteFilePath();
                 query << d.absoluteFilePath();
+                prefetchCueCodepages(d.absoluteFilePath());
             }
         }
 
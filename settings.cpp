@@ -49,8 +49,9 @@ static constexpr auto PROFILE_COVER_EMBED_SIZE_KEY = "CoverEmbed/Size";
 
 static constexpr auto DEFAULTCODEPAGE_KEY     = "Tags/DefaultCodepage";
 static constexpr auto SPLIT_TRACK_TITLE_KEY   = "Tags/SplitTrackTitle";
-static constexpr auto ENCODER_THREADCOUNT_KEY = "Encoder/ThreadCount";
-static constexpr auto ENCODER_TMPDIR_KEY      = "Encoder/TmpDir";
+static constexpr auto ENCODER_THREADCOUNT_KEY     = "Encoder/ThreadCount";
+static constexpr auto ENCODER_MIN_THREADCOUNT_KEY = "Encoder/MinThreadCount";
+static constexpr auto ENCODER_TMPDIR_KEY          = "Encoder/TmpDir";
 
 QString   Settings::mFileName;
 Settings *Settings::mInstance = nullptr;
@@ -155,6 +156,7 @@ Profile Settings::readProfile(const QString &profileId)
 
     profile.setTmpDir(value(ENCODER_TMPDIR_KEY, profile.tmpDir()).toString());
     profile.setEncoderThreadsCount(readThreadsCount(ENCODER_THREADCOUNT_KEY, profile.encoderThreadsCount()));
+    profile.setEncoderMinThreadsCount(value(ENCODER_MIN_THREADCOUNT_KEY, profile.encoderMinThreadsCount()).toUInt());
     profile.setSplitTrackTitle(value(SPLIT_TRACK_TITLE_KEY, profile.isSplitTrackTitle()).toBool());
 
     return profile;
@@ -204,6 +206,7 @@ void Settings::writeProfile(const Profile &profile)
 
     setValue(ENCODER_TMPDIR_KEY, profile.tmpDir());
     setValue(ENCODER_THREADCOUNT_KEY, profile.encoderThreadsCount());
+    setValue(ENCODER_MIN_THREADCOUNT_KEY, profile.encoderMinThreadsCount());
     setValue(SPLIT_TRACK_TITLE_KEY, profile.isSplitTrackTitle());
 }
 
@@ -91,12 +91,47 @@ bool TagValue::operator==(const TagValue &other) const
     return this->mEncoded == other.mEncoded && this->mValue == other.mValue;
 }
 
+/************************************************
+ *
+ ************************************************/
+TrackTags::TrackTags() :
+    mData(new Data())
+{
+    static_assert(TAGS_COUNT <= 32, "The tag masks are too small");
+}
+
+/************************************************
+ *
+ ************************************************/
+TrackTags::TrackTags(const TrackTags &other) = default;
+
+/************************************************
+ *
+ ************************************************/
+TrackTags &TrackTags::operator=(const TrackTags &other) = default;
+
+/************************************************
+ *
+ ************************************************/
+TrackTags::~TrackTags() = default;
+
 /************************************************
  *
  ************************************************/
 bool TrackTags::operator==(const TrackTags &other) const
 {
-    return mTags == other.mTags;
+    if (mData == other.mData)
+        return true;
+
+    if (mData->mExistsMask != other.mData->mExistsMask || mData->mEncodedMask != other.mData->mEncodedMask)
+        return false;
+
+    for (int i = 0; i < TAGS_COUNT; ++i) {
+        if (mData->mValues[i] != other.mData->mValues[i])
+            return false;
+    }
+
+    return true;
 }
 
 /************************************************
@@ -104,7 +139,7 @@ bool TrackTags::operator==(const TrackTags &other) const
  ************************************************/
 QString TrackTags::tag(const TagId &tagId) const
 {
-    return mTags.value(static_cast<int>(tagId)).asString(mTextCodec);
+    return tagValue(tagId).asString(mData->mTextCodec);
 }
 
 /************************************************
@@ -112,7 +147,7 @@ QString TrackTags::tag(const TagId &tagId) const
  ************************************************/
 QByteArray TrackTags::tagData(const TagId &tagId) const
 {
-    return mTags.value(static_cast<int>(tagId)).value();
+    return mData->mValues[static_cast<int>(tagId)];
 }
 
 /************************************************
@@ -120,7 +155,8 @@ QByteArray TrackTags::tagData(const TagId &tagId) const
  ************************************************/
 TagValue TrackTags::tagValue(TagId tagId) const
 {
-    return mTags.value(static_cast<int>(tagId));
+    int n = static_cast<int>(tagId);
+    return TagValue(mData->mValues[n], mData->mEncodedMask & (1u << n));
 }
 
 /************************************************
@@ -128,7 +164,7 @@ TagValue TrackTags::tagValue(TagId tagId) const
  ************************************************/
 void TrackTags::setTag(const TagId &tagId, const QString &value)
 {
-    mTags.insert(static_cast<int>(tagId), TagValue(value));
+    setTag(tagId, TagValue(value));
 }
 
 /************************************************
@@ -136,7 +172,7 @@ void TrackTags::setTag(const TagId &tagId, const QString &value)
  ************************************************/
 void TrackTags::setTag(const TagId &tagId, const QByteArray &value)
 {
-    mTags.insert(static_cast<int>(tagId), TagValue(value, false));
+    setTag(tagId, TagValue(value, false));
 }
 
 /************************************************
@@ -144,7 +180,16 @@ void TrackTags::setTag(const TagId &tagId, const QByteArray &value)
  ************************************************/
 void TrackTags::setTag(TagId tagId, const TagValue &value)
 {
-    mTags.insert(static_cast<int>(tagId), value);
+    int     n   = static_cast<int>(tagId);
+    quint32 bit = 1u << n;
+
+    mData->mValues[n] = value.value();
+    mData->mExistsMask |= bit;
+
+    if (value.encoded())
+        mData->mEncodedMask |= bit;
+    else
+        mData->mEncodedMask &= ~bit;
 }
 
 /************************************************
@@ -152,7 +197,7 @@ void TrackTags::setTag(TagId tagId, const TagValue &value)
  ************************************************/
 void TrackTags::setCodec(const TextCodec &value)
 {
-    mTextCodec = value;
+    mData->mTextCodec = value;
 }
 
 /************************************************
@@ -160,8 +205,8 @@ void TrackTags::setCodec(const TextCodec &value)
  ************************************************/
 CueIndex TrackTags::cueIndex(int indexNum) const
 {
-    if (indexNum < mCueIndexes.length())
-        return mCueIndexes.at(indexNum);
+    if (indexNum < mData->mCueIndexes.length())
+        return mData->mCueIndexes.at(indexNum);
 
     return CueIndex();
 }
@@ -171,10 +216,10 @@ CueIndex TrackTags::cueIndex(int indexNum) const
  ************************************************/
 void TrackTags::setCueIndex(int indexNum, const CueIndex &value)
 {
-    if (indexNum >= mCueIndexes.length())
-        mCueIndexes.resize(indexNum + 1);
+    if (indexNum >= mData->mCueIndexes.length())
+        mData->mCueIndexes.resize(indexNum + 1);
 
-    mCueIndexes[indexNum] = value;
+    mData->mCueIndexes[indexNum] = value;
 }
 
 /************************************************
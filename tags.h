@@ -31,6 +31,7 @@
 #include <QString>
 #include <QHash>
 #include <QVector>
+#include <QSharedDataPointer>
 #include "textcodec.h"
 
 class TagValue
@@ -68,9 +69,10 @@ private:
 class TrackTags
 {
 public:
-    TrackTags()                       = default;
-    TrackTags(const TrackTags &other) = default;
-    TrackTags &operator=(const TrackTags &other) = default;
+    TrackTags();
+    TrackTags(const TrackTags &other);
+    TrackTags &operator=(const TrackTags &other);
+    ~TrackTags();
 
     bool operator==(const TrackTags &other) const;
 
@@ -81,7 +83,7 @@ public:
     void       setTag(const TagId &tagId, const QByteArray &value);
     void       setTag(TagId tagId, const TagValue &value);
 
-    TextCodec codec() const { return mTextCodec; }
+    TextCodec codec() const { return mData->mTextCodec; }
     void      setCodec(const TextCodec &value);
 
     QString artist() const { return tag(TagId::Artist); }
@@ -120,9 +122,22 @@ public:
     void     setCueIndex(int indexNum, const CueIndex &value);
 
 private:
-    QHash<int, TagValue> mTags;
-    TextCodec            mTextCodec = TextCodecUtf8();
-    QVector<CueIndex>    mCueIndexes;
+    // Must be updated when new items are added to the TagId enum.
+    static constexpr int TAGS_COUNT = int(TagId::TrackCount) + 1;
+
+    // The values are stored in the fixed array indexed by TagId. Copies of
+    // the TrackTags share the data until one of them is changed.
+    class Data : public QSharedData
+    {
+    public:
+        QByteArray        mValues[TAGS_COUNT];
+        quint32           mExistsMask  = 0;
+        quint32           mEncodedMask = 0;
+        TextCodec         mTextCodec   = TextCodecUtf8();
+        QVector<CueIndex> mCueIndexes;
+    };
+
+    QSharedDataPointer<Data> mData;
 
     int  intTag(const TagId &tagId, int defaultValue = 1) const;
     void setIntTag(const TagId &tagId, int value);
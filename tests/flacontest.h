@@ -70,6 +70,10 @@ private slots:
     void testToLegacyWav();
     void testToLegacyWav_data();
 
+    void testCreateWavHeader();
+    void testRf64WavHeader();
+    void testResampleWave64();
+
     void testFormatWavLast();
 
     void testFormat();
@@ -127,6 +131,13 @@ private slots:
 
     void testReplayGain();
     void testReplayGain_data();
+    void testReplayGainMultichannel();
+
+    void testRetagCoverImage();
+    void testMetadataWriterEmptyTags();
+    void testVerifyCorruptedFile();
+    void testJournal();
+    void testFingerprints();
 
     void testValidator();
     void testValidator_data();
@@ -136,6 +147,12 @@ private slots:
     void testTextCodecs();
     void testTextCodecs_data();
 
+    void testTextCodecSingleByte();
+
+    void testConcurrencyController();
+    void testTotalProgressCounter();
+    void testAccurateRip();
+
 private:
     void writeTextFile(const QString &fileName, const QString &content);
     void writeTextFile(const QString &fileName, const QStringList &content);
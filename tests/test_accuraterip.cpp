@@ -0,0 +1,72 @@
+/* BEGIN_COMMON_COPYRIGHT_HEADER
+ * (c)LGPL2+
+ *
+ * Flacon - audio File Encoder
+ * https://github.com/flacon/flacon
+ *
+ * Copyright: 2024
+ *   Alexander Sokoloff <sokoloff.a@gmail.com>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * END_COMMON_COPYRIGHT_HEADER */
+
+#include <QTest>
+#include "flacontest.h"
+#include "converter/accuraterip.h"
+#include <QRandomGenerator>
+#include <QtEndian>
+
+/************************************************
+ *
+ ************************************************/
+void TestFlacon::testAccurateRip()
+{
+    const int  SAMPLES = 10 * 588;
+    QByteArray pregap(1000, '\x7f');
+    QByteArray data(SAMPLES * 4, '\0');
+    QRandomGenerator(42).fillRange(reinterpret_cast<quint32 *>(data.data()), SAMPLES);
+
+    // Reference implementation, the first and the last 5 sectors are skipped
+    quint32 v1 = 0;
+    quint32 v2 = 0;
+    for (quint32 i = 0; i < SAMPLES; ++i) {
+        const quint32 pos = i + 1;
+        if (pos < 5 * 588 - 1 || pos > SAMPLES - 5 * 588) {
+            continue;
+        }
+
+        const quint32 sample = qFromLittleEndian<quint32>(data.constData() + i * 4);
+        const quint64 v      = quint64(sample) * pos;
+        v1 += quint32(v);
+        v2 += quint32(v) + quint32(v >> 32);
+    }
+
+    AccurateRip::TrackCrc whole(pregap.size(), data.size(), true, true);
+    whole.add(pregap.constData(), pregap.size());
+    whole.add(data.constData(), data.size());
+    QCOMPARE(whole.v1(), v1);
+    QCOMPARE(whole.v2(), v2);
+
+    // The data is not split on the sample boundary
+    AccurateRip::TrackCrc parts(pregap.size(), data.size(), true, true);
+    QByteArray            all = pregap + data;
+    for (int i = 0; i < all.size(); i += 4093) {
+        parts.add(all.constData() + i, qMin(4093, int(all.size() - i)));
+    }
+    QCOMPARE(parts.v1(), v1);
+    QCOMPARE(parts.v2(), v2);
+    QCOMPARE(parts.crc32(), whole.crc32());
+}
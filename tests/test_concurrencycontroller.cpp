@@ -0,0 +1,70 @@
+/* BEGIN_COMMON_COPYRIGHT_HEADER
+ * (c)LGPL2+
+ *
+ * Flacon - audio File Encoder
+ * https://github.com/flacon/flacon
+ *
+ * Copyright: 2024
+ *   Alexander Sokoloff <sokoloff.a@gmail.com>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * END_COMMON_COPYRIGHT_HEADER */
+
+#include <QTest>
+#include "flacontest.h"
+#include "converter/concurrencycontroller.h"
+
+using namespace Conv;
+
+/************************************************
+ *
+ ************************************************/
+void TestFlacon::testConcurrencyController()
+{
+    ConcurrencyController ctrl;
+    ctrl.start(2, 4);
+    ctrl.stop();
+
+    // Idle cores, the limit grows up to the max bound
+    for (int i = 0; i < 5; ++i) {
+        ctrl.adjust(0.1, 0.0, 100);
+    }
+    QCOMPARE(ctrl.threadsLimit(), 4);
+    QCOMPARE(ctrl.splittersLimit(), 2);
+
+    // The disk is saturated, remove splitters first
+    ctrl.adjust(0.5, 0.5, 100);
+    QCOMPARE(ctrl.threadsLimit(), 4);
+    QCOMPARE(ctrl.splittersLimit(), 1);
+
+    // ... then threads, but not below the min bound
+    ctrl.adjust(0.5, 0.5, 100);
+    QCOMPARE(ctrl.threadsLimit(), 3);
+    ctrl.adjust(0.5, 0.5, 100);
+    ctrl.adjust(0.5, 0.5, 100);
+    QCOMPARE(ctrl.threadsLimit(), 2);
+
+    // The extra thread made the throughput worse, step back
+    ctrl.adjust(0.2, 0.0, 100);
+    QCOMPARE(ctrl.threadsLimit(), 3);
+    ctrl.adjust(0.2, 0.0, 50);
+    QCOMPARE(ctrl.threadsLimit(), 2);
+    QCOMPARE(ctrl.splittersLimit(), 1);
+
+    // CPU is busy, keep the limit
+    ctrl.adjust(0.95, 0.0, 50);
+    QCOMPARE(ctrl.threadsLimit(), 2);
+}
@@ -0,0 +1,86 @@
+/* BEGIN_COMMON_COPYRIGHT_HEADER
+ * (c)LGPL2+
+ *
+ * Flacon - audio File Encoder
+ * https://github.com/flacon/flacon
+ *
+ * Copyright: 2024
+ *   Alexander Sokoloff <sokoloff.a@gmail.com>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * END_COMMON_COPYRIGHT_HEADER */
+
+#include <QTest>
+#include <QBuffer>
+#include "flacontest.h"
+#include "tools.h"
+#include "converter/encoder.h"
+#include "converter/wavheader.h"
+
+/************************************************
+ * sox writes 32-bit WAV sizes. The resampled track
+ * that grows over 4 GiB goes through a Wave64 file,
+ * the program gets it with the RF64 or unsized
+ * WAV header.
+ ************************************************/
+void TestFlacon::testResampleWave64()
+{
+    try {
+        const quint64 GiB = 1024ull * 1024 * 1024;
+
+        // Resampling --------------------------
+        QCOMPARE(Conv::Encoder::isWave64Required(3 * GiB, 44100, 16, 44100, 16), false);
+        QCOMPARE(Conv::Encoder::isWave64Required(3 * GiB, 44100, 16, 96000, 16), true);
+        QCOMPARE(Conv::Encoder::isWave64Required(3 * GiB, 44100, 16, 44100, 24), true);
+        QCOMPARE(Conv::Encoder::isWave64Required(6 * GiB, 96000, 24, 44100, 16), false);
+        QCOMPARE(Conv::Encoder::isWave64Required(5 * GiB, 44100, 16, 44100, 16), true);
+
+        // The sox output ----------------------
+        Conv::WavHeader src(Conv::WavHeader::Format_PCM, 2, 96000, 24, 1024);
+        src.resizeData(6 * GiB);
+
+        QBuffer data;
+        data.setData(src.toByteArray());
+        data.open(QBuffer::ReadOnly);
+        Conv::WavHeader w64(&data);
+        QCOMPARE(w64.is64Bit(), true);
+
+        // The program reads RF64
+        QBuffer rf64;
+        rf64.setData(Conv::Encoder::programInputHeader(w64, true));
+        rf64.open(QBuffer::ReadOnly);
+        QCOMPARE(rf64.data().left(4), QByteArray("RF64"));
+
+        Conv::WavHeader header(&rf64);
+        QCOMPARE(header.dataSize(), 6 * GiB);
+        QCOMPARE(header.sampleRate(), quint32(96000));
+        QCOMPARE(header.bitsPerSample(), quint16(24));
+
+        // The program reads the legacy WAV only
+        QByteArray unsized = Conv::Encoder::programInputHeader(w64, false);
+        QCOMPARE(unsized.left(4), QByteArray("RIFF"));
+        QCOMPARE(unsized.right(4).toHex(), QByteArray("ffffffff"));
+
+        // The small WAV is passed as is
+        QBuffer legacy;
+        legacy.setData(Conv::WavHeader(Conv::WavHeader::Format_PCM, 2, 44100, 16, 1024).toWav());
+        legacy.open(QBuffer::ReadOnly);
+        QCOMPARE(Conv::Encoder::programInputHeader(Conv::WavHeader(&legacy), false), QByteArray());
+    }
+    catch (FlaconError &err) {
+        FAIL(err.what());
+    }
+}
@@ -0,0 +1,93 @@
+/* BEGIN_COMMON_COPYRIGHT_HEADER
+ * (c)LGPL2+
+ *
+ * Flacon - audio File Encoder
+ * https://github.com/flacon/flacon
+ *
+ * Copyright: 2024
+ *   Alexander Sokoloff <sokoloff.a@gmail.com>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * END_COMMON_COPYRIGHT_HEADER */
+
+#include <QTest>
+#include <QFile>
+#include <QStandardPaths>
+#include "flacontest.h"
+#include "converter/fingerprints.h"
+#include "disc.h"
+#include "track.h"
+
+using Match = Conv::Fingerprints::Match;
+
+/************************************************
+ * The incremental run re-encodes the track whose
+ * audio or encoder settings have changed, and only
+ * retags the track whose tags have changed.
+ ************************************************/
+void TestFlacon::testFingerprints()
+{
+    QStandardPaths::setTestModeEnabled(true);
+    Conv::Fingerprints *fingerprints = Conv::Fingerprints::instance();
+
+    Profile profile("FLAC");
+    profile.setOutFileDir(dir());
+    profile.setOutFilePattern("%n");
+
+    Track track = *standardDisc()->track(2);
+
+    const QString resultFile = profile.resultFilePath(&track);
+    QFile::remove(resultFile);
+
+    // Never converted
+    QCOMPARE(fingerprints->match(profile, track), Match::Changed);
+
+    {
+        QFile file(resultFile);
+        QVERIFY(file.open(QFile::WriteOnly | QFile::Truncate));
+        file.write("result");
+    }
+    fingerprints->store(profile, track);
+
+    // Unchanged track
+    QCOMPARE(fingerprints->match(profile, track), Match::Same);
+
+    // Changed tags, retag only
+    track.setTitle("New title");
+    QCOMPARE(fingerprints->match(profile, track), Match::TagsChanged);
+
+    fingerprints->store(profile, track);
+    QCOMPARE(fingerprints->match(profile, track), Match::Same);
+
+    // Changed encoder settings, re-encode
+    Profile gain = profile;
+    gain.setGainType(GainType::Track);
+    QCOMPARE(fingerprints->match(gain, track), Match::Changed);
+
+    // Changed audio and tags, re-encode
+    Profile bits = profile;
+    bits.setBitsPerSample(BitsPerSample::Bit_24);
+    track.setTitle("Other title");
+    QCOMPARE(fingerprints->match(bits, track), Match::Changed);
+
+    // The result file was removed
+    track.setTitle("New title");
+    QCOMPARE(fingerprints->match(profile, track), Match::Same);
+    QFile::remove(resultFile);
+    QCOMPARE(fingerprints->match(profile, track), Match::Changed);
+
+    QStandardPaths::setTestModeEnabled(false);
+}
@@ -0,0 +1,145 @@
+/* BEGIN_COMMON_COPYRIGHT_HEADER
+ * (c)LGPL2+
+ *
+ * Flacon - audio File Encoder
+ * https://github.com/flacon/flacon
+ *
+ * Copyright: 2024
+ *   Alexander Sokoloff <sokoloff.a@gmail.com>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * END_COMMON_COPYRIGHT_HEADER */
+
+#include <QTest>
+#include <QFile>
+#include <QFileInfo>
+#include <QStandardPaths>
+#include "flacontest.h"
+#include "converter/journal.h"
+#include "disc.h"
+#include "track.h"
+
+/************************************************
+ *
+ ************************************************/
+static void writeResultFile(const QString &fileName, char fill)
+{
+    QFile file(fileName);
+    if (!file.open(QFile::WriteOnly | QFile::Truncate)) {
+        QFAIL(QString("Can't write %1: %2").arg(fileName, file.errorString()).toLocal8Bit());
+    }
+    file.write(QByteArray(1024 * 1024, fill));
+}
+
+/************************************************
+ *
+ ************************************************/
+static void patchFile(const QString &fileName, qint64 pos, const QByteArray &data)
+{
+    QFile file(fileName);
+    if (!file.open(QFile::ReadWrite)) {
+        QFAIL(QString("Can't write %1: %2").arg(fileName, file.errorString()).toLocal8Bit());
+    }
+    file.seek(pos);
+    file.write(data);
+}
+
+/************************************************
+ * The tracks are taken as done on resume only if
+ * the result file is the same as it was written.
+ ************************************************/
+void TestFlacon::testJournal()
+{
+    QStandardPaths::setTestModeEnabled(true);
+
+    Profile profile("FLAC");
+    profile.setOutFileDir(dir());
+    profile.setOutFilePattern("%n");
+
+    Disc                  *disc = standardDisc();
+    const Track           *t0   = disc->track(0);
+    const Track           *t1   = disc->track(1);
+    QVector<const Track *> tracks { t0, t1 };
+
+    const QString file0 = profile.resultFilePath(t0);
+    const QString file1 = profile.resultFilePath(t1);
+    writeResultFile(file0, 'A');
+    writeResultFile(file1, 'B');
+
+    // Interrupted run -----------------------
+    {
+        Conv::Journal journal;
+        journal.open(tracks, { profile });
+        QVERIFY(journal.isOpen());
+
+        journal.write(profile, *t0, Conv::Journal::State::Split);
+        journal.write(profile, *t0, Conv::Journal::State::Done);
+        journal.write(profile, *t1, Conv::Journal::State::Encoded);
+        journal.close();
+    }
+
+    // Resume --------------------------------
+    {
+        Conv::Journal journal;
+        journal.open(tracks, { profile });
+        QCOMPARE(journal.isDone(profile, *t0), true);
+        QCOMPARE(journal.isDone(profile, *t1), false);
+
+        // Corrupted in the middle, the same size
+        patchFile(file0, QFileInfo(file0).size() / 2, "corrupted");
+        QCOMPARE(journal.isDone(profile, *t0), false);
+
+        writeResultFile(file0, 'A');
+        QCOMPARE(journal.isDone(profile, *t0), true);
+
+        // Truncated
+        QVERIFY(QFile(file0).resize(QFileInfo(file0).size() - 1));
+        QCOMPARE(journal.isDone(profile, *t0), false);
+
+        writeResultFile(file0, 'A');
+        journal.close();
+    }
+
+    // The changed batch doesn't reuse the results
+    {
+        Profile other = profile;
+        other.setGainType(GainType::Track);
+
+        Conv::Journal journal;
+        journal.open(tracks, { other });
+        QCOMPARE(journal.isDone(other, *t0), false);
+        journal.close();
+    }
+
+    // The complete batch removes the journal
+    {
+        Conv::Journal journal;
+        journal.open(tracks, { profile });
+        QCOMPARE(journal.isDone(profile, *t0), true);
+        journal.write(profile, *t1, Conv::Journal::State::Done);
+        journal.close();
+    }
+
+    {
+        Conv::Journal journal;
+        journal.open(tracks, { profile });
+        QCOMPARE(journal.isDone(profile, *t0), false);
+        QCOMPARE(journal.isDone(profile, *t1), false);
+        journal.close();
+    }
+
+    QStandardPaths::setTestModeEnabled(false);
+}
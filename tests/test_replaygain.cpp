@@ -27,6 +27,10 @@
 #include "flacontest.h"
 #include "convertertest.h"
 #include "types.h"
+#include "../converter/replaygain.h"
+#include "../converter/wavheader.h"
+#include <QtEndian>
+#include <cmath>
 
 /************************************************
  *
@@ -59,3 +63,55 @@ void TestFlacon::testReplayGain_data()
     }
     QDir::setCurrent(curDir);
 }
+
+/************************************************
+ * 2 seconds of the 1 kHz sine on the channels of
+ * the mask, the others are silent.
+ ************************************************/
+static float sineGain(int numChannels, quint32 channelMask, quint32 sineChannels)
+{
+    const int sampleRate = 44100;
+    const int frames     = sampleRate * 2;
+
+    QByteArray data(frames * numChannels * 2, '\0');
+    qint16    *p = reinterpret_cast<qint16 *>(data.data());
+    for (int i = 0; i < frames; ++i) {
+        const qint16 v = qint16(16384 * std::sin(2 * M_PI * 1000 * i / sampleRate));
+        for (int c = 0; c < numChannels; ++c) {
+            *p++ = qToLittleEndian((sineChannels & (1u << c)) ? v : qint16(0));
+        }
+    }
+
+    Conv::WavHeader header(Conv::WavHeader::Format_PCM, numChannels, sampleRate, 16, data.size(), channelMask);
+    data.prepend(header.toWav());
+
+    ReplayGain::TrackGain gain;
+    gain.add(data.constData(), data.size());
+    return gain.result().gain();
+}
+
+/************************************************
+ *
+ ************************************************/
+void TestFlacon::testReplayGainMultichannel()
+{
+    try {
+        const float stereo = sineGain(2, 0, 0b11);
+
+        // 5.1, the front channels are the same as stereo
+        QCOMPARE(sineGain(6, 0x003F, 0b000011), stereo);
+
+        // LFE is ignored
+        QCOMPARE(sineGain(6, 0x003F, 0b001011), stereo);
+
+        // The surround channels are +1.5 dB, the side ones as well as the back ones
+        QVERIFY(qAbs(stereo - sineGain(6, 0x003F, 0b110000) - 1.49) < 0.05);
+        QVERIFY(qAbs(stereo - sineGain(6, 0x060F, 0b110000) - 1.49) < 0.05);
+
+        // No mask is the default layout
+        QCOMPARE(sineGain(6, 0, 0b001011), stereo);
+    }
+    catch (const FlaconError &err) {
+        QFAIL(err.what());
+    }
+}
@@ -0,0 +1,138 @@
+/* BEGIN_COMMON_COPYRIGHT_HEADER
+ * (c)LGPL2+
+ *
+ * Flacon - audio File Encoder
+ * https://github.com/flacon/flacon
+ *
+ * Copyright: 2024
+ *   Alexander Sokoloff <sokoloff.a@gmail.com>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * END_COMMON_COPYRIGHT_HEADER */
+
+#include <QTest>
+#include <QFile>
+#include <QImage>
+#include "flacontest.h"
+#include "converter/retagger.h"
+#include "disc.h"
+#include "track.h"
+#include "formats_out/outformat.h"
+#include "formats_out/metadatawriter.h"
+#include <memory>
+#include <taglib/flacfile.h>
+#include <taglib/xiphcomment.h>
+
+/************************************************
+ * Every retag replaces the cover, so the file
+ * retagged twice has exactly one picture.
+ ************************************************/
+void TestFlacon::testRetagCoverImage()
+{
+    try {
+        Profile profile("FLAC");
+        profile.setOutFileDir(dir());
+        profile.setOutFilePattern("%n");
+        profile.setEmbedCoverOptions(CoverOptions { CoverMode::OrigSize, 0 });
+
+        QString coverFile = dir() + "/cover.png";
+        QImage  img(QSize(8, 8), QImage::Format_RGB32);
+        img.fill(Qt::red);
+        img.save(coverFile);
+
+        Disc *disc = standardDisc();
+        disc->setCoverImageFile(coverFile);
+        const Track *track = disc->track(0);
+
+        const QString fileName = profile.resultFilePath(track);
+        QFile::remove(fileName);
+        QVERIFY(QFile::copy(mAudio_cd_flac, fileName));
+
+        Conv::Retagger retagger(profile);
+        retagger.prepare(disc);
+        retagger.retag(*track);
+        retagger.retag(*track);
+
+        TagLib::FLAC::File file(fileName.toLocal8Bit(), false);
+        QVERIFY(file.isValid());
+        disc->setCoverImageFile("");
+
+        QCOMPARE(int(file.pictureList().size()), 1);
+        QCOMPARE(int(file.xiphComment()->fieldListMap()["TITLE"].size()), 1);
+    }
+    catch (const FlaconError &err) {
+        QFAIL(err.what());
+    }
+}
+
+/************************************************
+ * The fresh encode skips the empty values, only
+ * the retag removes the fields the file already has.
+ ************************************************/
+void TestFlacon::testMetadataWriterEmptyTags()
+{
+    try {
+        Profile profile("FLAC");
+        profile.setOutFileDir(dir());
+        profile.setOutFilePattern("%n");
+
+        Disc *disc  = standardDisc();
+        Track track = *disc->track(0);
+        track.setTitle("");
+
+        const QString fileName = profile.resultFilePath(&track);
+        QFile::remove(fileName);
+        QVERIFY(QFile::copy(mAudio_cd_flac, fileName));
+
+        {
+            TagLib::FLAC::File file(fileName.toLocal8Bit(), false);
+            QVERIFY(file.isValid());
+            file.xiphComment(true)->addField("TITLE", "Encoder title", true);
+            QVERIFY(file.save());
+        }
+
+        auto titles = [&fileName]() {
+            TagLib::FLAC::File file(fileName.toLocal8Bit(), false);
+            if (!file.isValid() || !file.hasXiphComment()) {
+                return -1;
+            }
+            return int(file.xiphComment()->fieldListMap()["TITLE"].size());
+        };
+
+        // Fresh encode
+        {
+            std::unique_ptr<MetadataWriter> writer(profile.outFormat()->createMetadataWriter(fileName));
+            QVERIFY(writer);
+            writer->setTags(track);
+            writer->setCoverImage(CoverImage());
+            writer->save();
+        }
+        QCOMPARE(titles(), 1);
+
+        // Retag
+        {
+            std::unique_ptr<MetadataWriter> writer(profile.outFormat()->createMetadataWriter(fileName));
+            QVERIFY(writer);
+            writer->setRemoveEmptyTags(true);
+            writer->setTags(track);
+            writer->save();
+        }
+        QCOMPARE(titles(), 0);
+    }
+    catch (const FlaconError &err) {
+        QFAIL(err.what());
+    }
+}
@@ -29,6 +29,7 @@
 #include <QTest>
 #include <QVector>
 #include <QDebug>
+#include <iconv.h>
 #include "types.h"
 #include "textcodec.h"
 
@@ -95,3 +96,57 @@ void TestFlacon::testTextCodecs_data()
         QTest::newRow(src.toUtf8()) << dataDir + "/" + src;
     }
 }
+
+static QString iconvDecode(const QString &codecName, const QByteArray &data)
+{
+    iconv_t cd = iconv_open("UTF-16LE", codecName.toLatin1().constData());
+    if (cd == (iconv_t)-1) {
+        return QString();
+    }
+
+    QByteArray out(data.length() * 4, '\0');
+
+    char  *outBuffer    = out.data();
+    size_t outBytesLeft = out.length();
+    char  *in           = (char *)data.data();
+    size_t inBytesLeft  = data.length();
+
+    size_t ok = iconv(cd, &in, &inBytesLeft, &outBuffer, &outBytesLeft);
+    iconv_close(cd);
+
+    if (ok == (size_t)-1) {
+        return QString();
+    }
+
+    return QString::fromUtf16((const char16_t *)out.constData(), (out.length() - outBytesLeft) / 2);
+}
+
+void TestFlacon::testTextCodecSingleByte()
+{
+    for (int mib : TextCodec::availableMibs()) {
+        TextCodec codec = TextCodec::codecForMib(mib);
+
+        // Mix long ASCII runs and 8-bit chars, so both decoder paths are used
+        QByteArray src;
+        for (int c = 1; c < 256; ++c) {
+            QByteArray chunk = QByteArray("Track title ") + char(c);
+
+            if (iconvDecode(codec.name(), chunk).isEmpty()) {
+                continue;
+            }
+            src += chunk;
+        }
+
+        QString expected = iconvDecode(codec.name(), src);
+        if (expected.isEmpty()) {
+            continue;
+        }
+
+        try {
+            QCOMPARE(codec.decode(src), expected);
+        }
+        catch (const FlaconError &err) {
+            QFAIL(err.what());
+        }
+    }
+}
@@ -0,0 +1,76 @@
+/* BEGIN_COMMON_COPYRIGHT_HEADER
+ * (c)LGPL2+
+ *
+ * Flacon - audio File Encoder
+ * https://github.com/flacon/flacon
+ *
+ * Copyright: 2024
+ *   Alexander Sokoloff <sokoloff.a@gmail.com>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * END_COMMON_COPYRIGHT_HEADER */
+
+#include <QTest>
+#include "flacontest.h"
+#include "converter/totalprogresscounter.h"
+#include "disc.h"
+
+/************************************************
+ * The tracks done by a previous run and the failed
+ * tracks are taken out of the total, so the result
+ * reaches 100% when the rest is converted.
+ ************************************************/
+void TestFlacon::testTotalProgressCounter()
+{
+    Disc        *disc = standardDisc();
+    const Track &t0   = *disc->track(0);
+    const Track &t1   = *disc->track(1);
+    const Track &t2   = *disc->track(2);
+
+    const double d0 = t0.duration();
+    const double d1 = t1.duration();
+    QVERIFY(d0 > 0);
+    QVERIFY(d1 > 0);
+
+    TotalProgressCounter counter;
+    counter.init(QList<Track>() << t0 << t1 << t2);
+    QCOMPARE(counter.result(), 0.0);
+
+    // Done by the previous run
+    counter.setTrackProgress(t2, TrackState::OK, 0);
+    QCOMPARE(counter.result(), 0.0);
+
+    counter.setTrackProgress(t0, TrackState::Splitting, 0);
+    counter.setTrackProgress(t0, TrackState::Encoding, 50);
+    QCOMPARE(counter.result(), d0 * 50 / (d0 + d1));
+
+    counter.setTrackProgress(t1, TrackState::Encoding, 20);
+    QCOMPARE(counter.result(), (d0 * 50 + d1 * 20) / (d0 + d1));
+
+    // The percent goes back after the restart of the track
+    counter.setTrackProgress(t1, TrackState::Encoding, 10);
+    QCOMPARE(counter.result(), (d0 * 50 + d1 * 10) / (d0 + d1));
+
+    counter.setTrackProgress(t1, TrackState::Error, 0);
+    QCOMPARE(counter.result(), 50.0);
+
+    // The repeated state of the removed track is ignored
+    counter.setTrackProgress(t1, TrackState::Aborted, 0);
+    QCOMPARE(counter.result(), 50.0);
+
+    counter.setTrackProgress(t0, TrackState::OK, 0);
+    QCOMPARE(counter.result(), 100.0);
+}
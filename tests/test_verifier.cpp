@@ -0,0 +1,118 @@
+/* BEGIN_COMMON_COPYRIGHT_HEADER
+ * (c)LGPL2+
+ *
+ * Flacon - audio File Encoder
+ * https://github.com/flacon/flacon
+ *
+ * Copyright: 2024
+ *   Alexander Sokoloff <sokoloff.a@gmail.com>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * END_COMMON_COPYRIGHT_HEADER */
+
+#include <QTest>
+#include <QFile>
+#include <QBuffer>
+#include <QCryptographicHash>
+#include "flacontest.h"
+#include "tools.h"
+#include "converter/verifier.h"
+#include "converter/decoder.h"
+#include "disc.h"
+
+/************************************************
+ * The corrupted result fails only its own track,
+ * the verifier doesn't report the disc error.
+ ************************************************/
+void TestFlacon::testVerifyCorruptedFile()
+{
+    try {
+        QByteArray pcm;
+        {
+            QBuffer buf(&pcm);
+            buf.open(QBuffer::WriteOnly);
+
+            Conv::Decoder decoder;
+            decoder.open(mAudio_cd_wav);
+            decoder.extract(CueTime(), CueTime(), &buf, false);
+            decoder.close();
+        }
+        const QByteArray expected = QCryptographicHash::hash(pcm, Conv::Verifier::ALGORITHM);
+
+        const QString goodFile      = dir() + "/good.wav";
+        const QString corruptedFile = dir() + "/corrupted.wav";
+        QFile::remove(goodFile);
+        QFile::remove(corruptedFile);
+        QVERIFY(QFile::copy(mAudio_cd_wav, goodFile));
+        QVERIFY(QFile::copy(mAudio_cd_wav, corruptedFile));
+
+        {
+            QFile file(corruptedFile);
+            QVERIFY(file.open(QFile::ReadWrite));
+            QVERIFY(file.seek(file.size() / 2));
+            QByteArray data = file.peek(16);
+            for (char &c : data) {
+                c = char(~c);
+            }
+            file.write(data);
+        }
+
+        const Conv::ConvTrack track(*standardDisc()->track(1));
+
+        struct Result
+        {
+            bool verified = false;
+            bool failed   = false;
+            bool error    = false;
+            int  track    = -1;
+        };
+
+        auto verify = [&](const QString &fileName) {
+            Result         res;
+            Conv::Verifier verifier(track, fileName, expected);
+
+            QObject::connect(&verifier, &Conv::Verifier::trackVerified, [&res](const Conv::ConvTrack &t) {
+                res.verified = true;
+                res.track    = t.index();
+            });
+            QObject::connect(&verifier, &Conv::Verifier::verifyFailed, [&res](const Conv::ConvTrack &t) {
+                res.failed = true;
+                res.track  = t.index();
+            });
+            QObject::connect(&verifier, &Conv::Verifier::error, [&res]() {
+                res.error = true;
+            });
+
+            verifier.run();
+            return res;
+        };
+
+        Result good = verify(goodFile);
+        QCOMPARE(good.verified, true);
+        QCOMPARE(good.failed, false);
+        QCOMPARE(good.error, false);
+        QCOMPARE(good.track, track.index());
+
+        Result bad = verify(corruptedFile);
+        QCOMPARE(bad.verified, false);
+        QCOMPARE(bad.failed, true);
+        QCOMPARE(bad.error, false);
+        QCOMPARE(bad.track, track.index());
+    }
+    catch (const FlaconError &err) {
+        QFAIL(err.what());
+    }
+}
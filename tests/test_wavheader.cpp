@@ -412,6 +412,71 @@ void TestFlacon::testResizeWavHeader_data()
             << "00 B9 4D 02"; // expected data size
 }
 
+/************************************************
+ *
+ ************************************************/
+void TestFlacon::testCreateWavHeader()
+{
+    try {
+        Conv::WavHeader src(Conv::WavHeader::Format_PCM, 6, 96000, 24, 1728000, 0x060F);
+
+        QBuffer data;
+        data.setData(src.toByteArray());
+        data.open(QBuffer::ReadOnly);
+        Conv::WavHeader header(&data);
+
+        QCOMPARE(header.is64Bit(), true);
+        QCOMPARE(header.format(), Conv::WavHeader::Format_Extensible);
+        QCOMPARE(header.sampleFormat(), Conv::WavHeader::Format_PCM);
+        QCOMPARE(header.numChannels(), quint16(6));
+        QCOMPARE(header.sampleRate(), quint32(96000));
+        QCOMPARE(header.bitsPerSample(), quint16(24));
+        QCOMPARE(header.blockAlign(), quint16(18));
+        QCOMPARE(header.byteRate(), quint32(1728000));
+        QCOMPARE(header.channelMask(), quint32(0x060F));
+        QCOMPARE(header.dataSize(), quint64(1728000));
+        QCOMPARE(header.dataStartPos(), quint64(data.size()));
+        QCOMPARE(header.duration(), quint64(1000));
+    }
+    catch (FlaconError &err) {
+        FAIL(err.what());
+    }
+}
+
+/************************************************
+ *
+ ************************************************/
+void TestFlacon::testRf64WavHeader()
+{
+    try {
+        const quint64 dataSize = 6ull * 1024 * 1024 * 1024;
+
+        Conv::WavHeader src(Conv::WavHeader::Format_PCM, 2, 44100, 16, 1024);
+        src.resizeData(dataSize);
+
+        QBuffer data;
+        data.setData(src.toWav());
+        data.open(QBuffer::ReadOnly);
+        QCOMPARE(data.data().left(4), QByteArray("RF64"));
+
+        Conv::WavHeader header(&data);
+        QCOMPARE(header.isRf64(), true);
+        QCOMPARE(header.dataSize(), dataSize);
+        QCOMPARE(header.dataStartPos(), quint64(data.size()));
+        QCOMPARE(header.toByteArray().toHex(), data.data().toHex());
+
+        QByteArray unsized = header.toUnsizedWav();
+        QCOMPARE(unsized.left(4), QByteArray("RIFF"));
+        QCOMPARE(unsized.right(4).toHex(), QByteArray("ffffffff"));
+
+        Conv::WavHeader small(Conv::WavHeader::Format_PCM, 2, 44100, 16, 1024);
+        QCOMPARE(small.toWav().left(4), QByteArray("RIFF"));
+    }
+    catch (FlaconError &err) {
+        FAIL(err.what());
+    }
+}
+
 /************************************************
  *
  ************************************************/
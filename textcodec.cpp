@@ -25,9 +25,149 @@
 
 #include "textcodec.h"
 #include <iconv.h>
+#include <cstring>
 #include <QDebug>
+#include <QHash>
 #include "types.h"
 
+namespace {
+
+/************************************************
+ * Lookup table for the single-byte codepages.
+ * The tables are built once from iconv, so they
+ * always agree with the generic decoder below.
+ ************************************************/
+struct SingleByteTable
+{
+    static constexpr char16_t UNMAPPED = 0xFFFF;
+    char16_t                  chars[256];
+};
+
+using SingleByteTables = QHash<int, SingleByteTable>;
+
+QList<int> singleByteMibs()
+{
+    // windows-1258 is not here, iconv composes its combining marks.
+    return {
+        TextCodecIso8859_1::MIB,
+        TextCodecIso8859_2::MIB,
+        TextCodecIso8859_3::MIB,
+        TextCodecIso8859_4::MIB,
+        TextCodecIso8859_5::MIB,
+        TextCodecIso8859_6::MIB,
+        TextCodecIso8859_7::MIB,
+        TextCodecIso8859_8::MIB,
+        TextCodecIso8859_9::MIB,
+        TextCodecIso8859_10::MIB,
+        TextCodecIso8859_13::MIB,
+        TextCodecIso8859_14::MIB,
+        TextCodecIso8859_15::MIB,
+        TextCodecIso8859_16::MIB,
+        TextCodecIbm866::MIB,
+        TextCodecWindows1250::MIB,
+        TextCodecWindows1251::MIB,
+        TextCodecWindows1252::MIB,
+        TextCodecWindows1253::MIB,
+        TextCodecWindows1254::MIB,
+        TextCodecWindows1255::MIB,
+        TextCodecWindows1256::MIB,
+        TextCodecWindows1257::MIB,
+    };
+}
+
+bool buildSingleByteTable(const QString &codecName, SingleByteTable *table)
+{
+    iconv_t cd = iconv_open("UTF-16LE", codecName.toLatin1().constData());
+    if (cd == (iconv_t)-1) {
+        return false;
+    }
+
+    for (int i = 0; i < 256; ++i) {
+        char  in[1] = { char(i) };
+        uchar out[4];
+
+        char  *inBuf        = in;
+        size_t inBytesLeft  = 1;
+        char  *outBuf       = reinterpret_cast<char *>(out);
+        size_t outBytesLeft = sizeof(out);
+
+        size_t res = iconv(cd, &inBuf, &inBytesLeft, &outBuf, &outBytesLeft);
+        if (res == (size_t)-1 || outBytesLeft != 2) {
+            table->chars[i] = SingleByteTable::UNMAPPED;
+        }
+        else {
+            table->chars[i] = char16_t(out[0] | (out[1] << 8));
+        }
+
+        // Reset the conversion state after an error
+        iconv(cd, nullptr, nullptr, nullptr, nullptr);
+    }
+
+    iconv_close(cd);
+    return true;
+}
+
+const SingleByteTables &singleByteTables()
+{
+    static const SingleByteTables tables = []() {
+        SingleByteTables res;
+        for (int mib : singleByteMibs()) {
+            SingleByteTable table;
+            if (buildSingleByteTable(TextCodec::codecForMib(mib).name(), &table)) {
+                res.insert(mib, table);
+            }
+        }
+        return res;
+    }();
+
+    return tables;
+}
+
+/************************************************
+ * Returns false if the data contains a byte that
+ * has no mapping in the codepage, the caller
+ * should use iconv in this case.
+ ************************************************/
+bool decodeSingleByte(const SingleByteTable &table, const QByteArray &data, QString *out)
+{
+    // The iconv decoder stops at the first zero char, keep the same behavior
+    const int    len = qstrnlen(data.constData(), data.size());
+    const uchar *src = reinterpret_cast<const uchar *>(data.constData());
+
+    out->resize(len);
+    char16_t *dest = reinterpret_cast<char16_t *>(out->data());
+
+    int i = 0;
+    while (i < len) {
+        // ASCII fast path, check 8 bytes at once
+        while (i + 8 <= len) {
+            quint64 chunk;
+            memcpy(&chunk, src + i, sizeof(chunk));
+            if (chunk & Q_UINT64_C(0x8080808080808080)) {
+                break;
+            }
+
+            for (int n = 0; n < 8; ++n) {
+                dest[i + n] = src[i + n];
+            }
+            i += 8;
+        }
+
+        int end = qMin(i + 8, len);
+        for (; i < end; ++i) {
+            char16_t c = table.chars[src[i]];
+            if (c == SingleByteTable::UNMAPPED) {
+                return false;
+            }
+            dest[i] = c;
+        }
+    }
+
+    return true;
+}
+
+} // namespace
+
 QList<int> TextCodec::availableMibs()
 {
     return {
@@ -167,6 +307,15 @@ QString TextCodec::decode(const QByteArray &data) const noexcept(false)
         return QString::fromUtf8(data);
     }
 
+    const SingleByteTables &tables = singleByteTables();
+    auto                    it     = tables.constFind(mMib);
+    if (it != tables.constEnd()) {
+        QString res;
+        if (decodeSingleByte(it.value(), data, &res)) {
+            return res;
+        }
+    }
+
     iconv_t cd = iconv_open("UTF-16", mName.toLatin1().constData());
     if (cd == (iconv_t)-1) {
         throw FlaconError(QString("Unable to open iconv_open for %1: %2").arg(mName, strerror(errno)));
@@ -220,6 +220,7 @@ enum class FormatOption {
     SupportGain          = 0x2,
     SupportEmbeddedCue   = 0x4,
     SupportEmbeddedImage = 0x8,
+    SupportRf64          = 0x10, // The encoder reads RF64 streams longer than 4 GiB
 };
 
 Q_DECLARE_FLAGS(FormatOptions, FormatOption)
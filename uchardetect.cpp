@@ -27,13 +27,159 @@
 #include "settings.h"
 #include <uchardet.h>
 #include "track.h"
+#include "cuedata.h"
+#include <QCryptographicHash>
+#include <QStandardPaths>
+#include <QDir>
+#include <QFile>
+#include <QHash>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QCache>
+#include <QDateTime>
+#include <QFileInfo>
+#include <QThreadPool>
+#include <QtConcurrent/QtConcurrent>
+#include <QDebug>
+
+/************************************************
+ * Detected charsets keyed by the SHA1 of the
+ * detector input. The cache is kept on disk, so
+ * the same CUE isn't analyzed again after restart.
+ ************************************************/
+class CharsetCache
+{
+public:
+    static CharsetCache *instance();
+
+    bool    contains(const QByteArray &key);
+    QString value(const QByteArray &key);
+    void    insert(const QByteArray &key, const QString &charset);
+
+private:
+    static constexpr int MAX_ENTRIES = 50000;
+
+    QMutex                      mMutex;
+    bool                        mLoaded = false;
+    QHash<QByteArray, QString>  mItems;
+
+    QString fileName() const;
+    void    load();
+};
+
+/************************************************
+ *
+ ************************************************/
+CharsetCache *CharsetCache::instance()
+{
+    static CharsetCache res;
+    return &res;
+}
+
+/************************************************
+ *
+ ************************************************/
+QString CharsetCache::fileName() const
+{
+    QString dir = QStandardPaths::writableLocation(QStandardPaths::CacheLocation);
+    if (dir.isEmpty()) {
+        return "";
+    }
+
+    return dir + "/charsets";
+}
+
+/************************************************
+ *
+ ************************************************/
+void CharsetCache::load()
+{
+    mLoaded = true;
+
+    QFile file(fileName());
+    if (file.fileName().isEmpty() || !file.open(QFile::ReadOnly)) {
+        return;
+    }
+
+    while (!file.atEnd()) {
+        QByteArray line = file.readLine().trimmed();
+        int        n    = line.indexOf(' ');
+        if (n < 1) {
+            continue;
+        }
+
+        mItems.insert(QByteArray::fromHex(line.left(n)), QString::fromLatin1(line.mid(n + 1)));
+    }
+    file.close();
+
+    // The file only grows, start it from scratch when it gets too big.
+    if (mItems.count() > MAX_ENTRIES) {
+        mItems.clear();
+        file.remove();
+    }
+}
+
+/************************************************
+ *
+ ************************************************/
+bool CharsetCache::contains(const QByteArray &key)
+{
+    QMutexLocker locker(&mMutex);
+    if (!mLoaded) {
+        load();
+    }
+
+    return mItems.contains(key);
+}
+
+/************************************************
+ *
+ ************************************************/
+QString CharsetCache::value(const QByteArray &key)
+{
+    QMutexLocker locker(&mMutex);
+    if (!mLoaded) {
+        load();
+    }
+
+    return mItems.value(key);
+}
+
+/************************************************
+ *
+ ************************************************/
+void CharsetCache::insert(const QByteArray &key, const QString &charset)
+{
+    QMutexLocker locker(&mMutex);
+    if (!mLoaded) {
+        load();
+    }
+
+    if (mItems.contains(key)) {
+        return;
+    }
+    mItems.insert(key, charset);
+
+    QFile file(fileName());
+    if (file.fileName().isEmpty()) {
+        return;
+    }
+
+    QDir().mkpath(QFileInfo(file).path());
+    if (!file.open(QFile::WriteOnly | QFile::Append)) {
+        qWarning() << "Can't write charset cache" << file.fileName() << file.errorString();
+        return;
+    }
+
+    file.write(key.toHex() + " " + charset.toLatin1() + "\n");
+}
 
 /************************************************
  *
  ************************************************/
 struct UcharDet::Data
 {
-    uchardet_t mUchcharDet;
+    QByteArray mSample;
 };
 
 /************************************************
@@ -42,7 +188,6 @@ struct UcharDet::Data
 UcharDet::UcharDet() :
     mData(new Data())
 {
-    mData->mUchcharDet = uchardet_new();
 }
 
 /************************************************
@@ -50,7 +195,6 @@ UcharDet::UcharDet() :
  ************************************************/
 UcharDet::~UcharDet()
 {
-    uchardet_delete(mData->mUchcharDet);
     delete mData;
 }
 
@@ -64,7 +208,7 @@ UcharDet &UcharDet::operator<<(const Track &track)
     for (uint i = 0; i < sizeof(tags) / sizeof(TagId); ++i) {
         TagValue tv = track.tagValue(tags[i]);
         if (!tv.encoded())
-            uchardet_handle_data(mData->mUchcharDet, tv.value().data(), tv.value().length());
+            mData->mSample += tv.value();
     }
 
     return *this;
@@ -79,19 +223,56 @@ UcharDet &UcharDet::operator<<(const TrackTags &track)
     for (uint i = 0; i < sizeof(tags) / sizeof(TagId); ++i) {
         TagValue tv = track.tagValue(tags[i]);
         if (!tv.encoded())
-            uchardet_handle_data(mData->mUchcharDet, tv.value().data(), tv.value().length());
+            mData->mSample += tv.value();
+    }
+
+    return *this;
+}
+
+/************************************************
+ * Feeds the same tags as the TrackTags operator,
+ * the track performer falls back to the global one.
+ ************************************************/
+UcharDet &UcharDet::operator<<(const CueData &cue)
+{
+    const QByteArray performer = cue.globalTags().value(CueData::PERFORMER_TAG);
+
+    for (const CueData::Tags &t : cue.tracks()) {
+        mData->mSample += t.value(CueData::PERFORMER_TAG, performer);
+        mData->mSample += t.value(CueData::TITLE_TAG);
     }
 
     return *this;
 }
 
+/************************************************
+ *
+ ************************************************/
+QString UcharDet::charsetName() const
+{
+    QByteArray key = QCryptographicHash::hash(mData->mSample, QCryptographicHash::Sha1);
+
+    CharsetCache *cache = CharsetCache::instance();
+    if (cache->contains(key)) {
+        return cache->value(key);
+    }
+
+    uchardet_t det = uchardet_new();
+    uchardet_handle_data(det, mData->mSample.constData(), mData->mSample.length());
+    uchardet_data_end(det);
+    QString res = uchardet_get_charset(det);
+    uchardet_delete(det);
+
+    cache->insert(key, res);
+    return res;
+}
+
 /************************************************
  *
  ************************************************/
 QString UcharDet::textCodecName() const
 {
-    uchardet_data_end(mData->mUchcharDet);
-    QString res = uchardet_get_charset(mData->mUchcharDet);
+    QString res = charsetName();
 
     if (!TextCodec::codecForName(res).isValid()) {
         res = Settings::i()->defaultCodepage();
@@ -103,3 +284,141 @@ QString UcharDet::textCodecName() const
 
     return res;
 }
+
+/************************************************
+ * Parses the CUE files on its own small pool and
+ * keeps the parsed data, so the disc loading takes
+ * it instead of reading the file again.
+ ************************************************/
+class CuePrefetcher
+{
+public:
+    static CuePrefetcher *instance();
+    ~CuePrefetcher();
+
+    void     add(const QString &fileName);
+    CueData *take(const QString &fileName);
+
+private:
+    static constexpr int MAX_THREADS = 2;
+    static constexpr int MAX_QUEUED  = 256;
+    static constexpr int MAX_PARSED  = 256;
+
+    CuePrefetcher();
+
+    QThreadPool              mPool;
+    QAtomicInt               mQueued;
+    QMutex                   mMutex;
+    QCache<QString, CueData> mParsed;
+
+    static QString key(const QString &fileName);
+    void           run(const QString &fileName);
+};
+
+/************************************************
+ *
+ ************************************************/
+CuePrefetcher *CuePrefetcher::instance()
+{
+    static CuePrefetcher res;
+    return &res;
+}
+
+/************************************************
+ * The tasks use the charset cache, so it has to
+ * be created first to be destroyed after us.
+ ************************************************/
+CuePrefetcher::CuePrefetcher() :
+    mParsed(MAX_PARSED)
+{
+    CharsetCache::instance();
+    mPool.setMaxThreadCount(MAX_THREADS);
+}
+
+/************************************************
+ *
+ ************************************************/
+CuePrefetcher::~CuePrefetcher()
+{
+    mPool.clear();
+    mPool.waitForDone();
+}
+
+/************************************************
+ * The edited file gets another key, so the stale
+ * data is never returned.
+ ************************************************/
+QString CuePrefetcher::key(const QString &fileName)
+{
+    QFileInfo fi(fileName);
+    return QString("%1:%2:%3").arg(fi.canonicalFilePath()).arg(fi.size()).arg(fi.lastModified().toMSecsSinceEpoch());
+}
+
+/************************************************
+ * When the queue is full the file is just
+ * parsed and detected on load as usual.
+ ************************************************/
+void CuePrefetcher::add(const QString &fileName)
+{
+    if (mQueued.fetchAndAddOrdered(1) >= MAX_QUEUED) {
+        mQueued.fetchAndAddOrdered(-1);
+        return;
+    }
+
+    QtConcurrent::run(&mPool, [this, fileName]() {
+        run(fileName);
+        mQueued.fetchAndAddOrdered(-1);
+    });
+}
+
+/************************************************
+ *
+ ************************************************/
+void CuePrefetcher::run(const QString &fileName)
+{
+    try {
+        const QString k    = key(fileName);
+        CueData      *data = new CueData(fileName);
+
+        if (data->bomCodec() == TextCodec::BomCodec::Unknown) {
+            UcharDet charDet;
+            charDet << *data;
+            charDet.charsetName();
+        }
+
+        QMutexLocker locker(&mMutex);
+        mParsed.insert(k, data);
+    }
+    catch (const FlaconError &) {
+        // Broken CUE files are reported when they are really loaded.
+    }
+}
+
+/************************************************
+ *
+ ************************************************/
+CueData *CuePrefetcher::take(const QString &fileName)
+{
+    const QString k = key(fileName);
+
+    QMutexLocker locker(&mMutex);
+    return mParsed.take(k);
+}
+
+/************************************************
+ *
+ ************************************************/
+void UcharDet::prefetch(const QStringList &cueFiles)
+{
+    for (const QString &fileName : cueFiles) {
+        CuePrefetcher::instance()->add(fileName);
+    }
+}
+
+/************************************************
+ *
+ ************************************************/
+CueData *UcharDet::takePrefetched(const QString &cueFile)
+{
+    return CuePrefetcher::instance()->take(cueFile);
+}
@@ -27,9 +27,11 @@
 #define UCHARDETECT_H
 
 #include <QString>
+#include <QStringList>
 
 class Track;
 class TrackTags;
+class CueData;
 
 class UcharDet
 {
@@ -43,9 +45,22 @@ public:
     void      add(const Track &track);
     UcharDet &operator<<(const Track &track);
     UcharDet &operator<<(const TrackTags &track);
+    UcharDet &operator<<(const CueData &cue);
 
     QString textCodecName() const;
 
+    /// Returns the charset name as reported by uchardet, without fallback to
+    /// the default codepage. The results are cached between the program runs.
+    QString charsetName() const;
+
+    /// Parses the CUE files and detects their codepages on a small dedicated
+    /// thread pool, the results are stored in the cache. The call doesn't block.
+    static void prefetch(const QStringList &cueFiles);
+
+    /// Returns the CUE data parsed by prefetch() and passes the ownership to the
+    /// caller. Returns nullptr if the file wasn't prefetched yet or was changed since.
+    static CueData *takePrefetched(const QString &cueFile);
+
 private:
     struct Data;
     Data *mData;
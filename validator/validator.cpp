@@ -28,6 +28,7 @@
 #include <QDateTime>
 #include "extprogram.h"
 #include "validatorcheckresultorder.h"
+#include "converter/replaygain.h"
 #include <QDir>
 
 static constexpr int VALIDATE_DELAY_MS = 50;
@@ -487,8 +488,9 @@ bool Validator::validateDiskWarnings(const Disk *disk, QStringList &warnings)
             res = false;
         }
 
-        if (mProfile->gainType() != GainType::Disable && audioFile.channelsCount() > 2) {
-            warnings << tr("ReplayGain calculation is not supported for multi-channel audio.\nThe ReplayGain will be disabled for this disk.", "Warning message");
+        if (mProfile->gainType() != GainType::Disable && audioFile.channelsCount() > uint(ReplayGain::MAX_CHANNELS)) {
+            warnings << tr("ReplayGain calculation is supported for up to %1 channels.\nThe ReplayGain will be disabled for this disk.", "Warning message")
+                                .arg(ReplayGain::MAX_CHANNELS);
             res = false;
         }
     }